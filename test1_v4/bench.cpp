@@ -0,0 +1,495 @@
+// bench.cpp
+// 回环性能测试：为每种端点组合创建 ProtocolChannel，由本进程充当数据源和接收端
+// 输出 JSON（stdout），进度信息输出到 stderr
+//
+// 拓扑：源 -> [通道输入端点 -> 通道输出端点] -> 接收端
+//   tcp    输入 tcp_server，源为TCP客户端；输出 tcp_server，接收端为TCP客户端
+//   udp    输入 udp_server，源为UDP socket；输出 udp_client，接收端为绑定端口的UDP socket
+//   serial 伪终端对：通道打开从设备，源/接收端读写主设备
+//          serial-serial 即串口收发往返（两个伪终端），可用 --serial-line / --low-latency 指定线路参数
+//
+// 消息负载包含行规程会改写的字节（CR/LF、XON/XOFF、DEL、0xFF 等），串口未处于原始模式时计入 corrupt_bytes
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "protocol_channel.h"
+#include "thread_pool.h"
+#include "logrecord.h"
+
+// 消息头：magic + 通道号 + 序号 + 发送时间，其余字节填充到指定大小
+struct MessageHeader {
+    uint32_t magic;
+    uint32_t channel;
+    uint64_t seq;
+    int64_t send_ns;
+};
+static constexpr uint32_t kMagic = 0x42454E43; // "BENC"
+static constexpr uint8_t kPayloadBytes[] = {0x0D, 0x0A, 0x11, 0x13, 0x7F, 0xFF, 0x00, 0x03, 0x1A, 0x5A};
+
+struct BenchOptions {
+    std::vector<std::string> pairs{"tcp-tcp", "tcp-udp", "udp-tcp", "udp-udp", "serial-tcp", "tcp-serial"};
+    size_t msg_size = 64;
+    uint64_t rate = 10000;        // 每通道每秒消息数，0 表示不限速
+    uint64_t count = 20000;       // 每通道消息数
+    size_t channels = 1;          // 每种组合并发通道数
+    uint16_t base_port = 20000;
+    std::string coalesce = "latency";
+    int drain_ms = 1000;          // 发送结束后无新数据的等待时间
+    std::string serial_line = "8N1";  // 串口端点的数据位 / 校验 / 停止位
+    bool low_latency = false;     // 串口端点启用 serial_low_latency
+};
+
+static int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static double cpuSeconds() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+static sockaddr_in loopbackAddr(uint16_t port) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return addr;
+}
+
+static int connectTcp(uint16_t port) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_in addr = loopbackAddr(port);
+    if (fd < 0 || connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        throw std::runtime_error("Connect to port " + std::to_string(port) + " failed: " + strerror(errno));
+    }
+    return fd;
+}
+
+// 伪终端对：主设备由测试程序读写，从设备交给 SerialEndpoint
+struct Pty {
+    int master = -1;
+    int slave = -1;   // 保持打开，避免通道关闭从设备后主设备读到 EIO
+    std::string name;
+
+    Pty() {
+        master = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+        if (master < 0 || grantpt(master) < 0 || unlockpt(master) < 0) {
+            throw std::runtime_error("Pty creation failed: " + std::string(strerror(errno)));
+        }
+        name = ptsname(master);
+        slave = ::open(name.c_str(), O_RDWR | O_NOCTTY | O_CLOEXEC);
+        if (slave < 0) {
+            throw std::runtime_error("Open " + name + " failed: " + strerror(errno));
+        }
+        // 原始模式，避免行规程改写二进制数据（如 CR->NL）
+        termios tty{};
+        tcgetattr(slave, &tty);
+        cfmakeraw(&tty);
+        tcsetattr(slave, TCSANOW, &tty);
+    }
+
+    ~Pty() {
+        if (slave >= 0) ::close(slave);
+        if (master >= 0) ::close(master);
+    }
+};
+
+// 单个被测通道及其源/接收端
+struct BenchChannel {
+    uint32_t id = 0;
+    std::string input_kind;
+    std::string output_kind;
+    ChannelConfig config;
+    std::unique_ptr<Pty> input_pty;
+    std::unique_ptr<Pty> output_pty;
+    std::unique_ptr<ProtocolChannel> channel;
+    int source_fd = -1;
+    int sink_fd = -1;
+
+    std::atomic<uint64_t> sent{0};
+    std::atomic<bool> sender_done{false};
+    uint64_t received = 0;
+    uint64_t corrupt_bytes = 0;
+    int64_t first_send_ns = 0;
+    int64_t last_recv_ns = 0;
+    std::vector<int64_t> latencies_ns;
+
+    ~BenchChannel() {
+        if (channel) channel->stop();
+        if (source_fd >= 0 && !input_pty) ::close(source_fd);
+        if (sink_fd >= 0 && !output_pty) ::close(sink_fd);
+    }
+};
+
+static void setupInput(BenchChannel& bc, uint16_t port) {
+    EndpointConfig& ep = bc.config.input;
+    if (bc.input_kind == "tcp") {
+        ep.type = "tcp_server";
+        ep.port = port;
+    } else if (bc.input_kind == "udp") {
+        ep.type = "udp_server";
+        ep.port = port;
+    } else if (bc.input_kind == "serial") {
+        bc.input_pty = std::make_unique<Pty>();
+        ep.type = "serial";
+        ep.serial_port = bc.input_pty->name;
+        ep.baud_rate = 115200;
+        bc.source_fd = bc.input_pty->master;
+    } else {
+        throw std::runtime_error("Unknown endpoint kind: " + bc.input_kind);
+    }
+}
+
+static void setupOutput(BenchChannel& bc, uint16_t port) {
+    EndpointConfig& ep = bc.config.output;
+    if (bc.output_kind == "tcp") {
+        ep.type = "tcp_server";
+        ep.port = port;
+    } else if (bc.output_kind == "udp") {
+        // 接收端先绑定端口，通道以 udp_client 发往该端口
+        bc.sink_fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        int rcvbuf = 8 * 1024 * 1024;
+        setsockopt(bc.sink_fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+        sockaddr_in addr = loopbackAddr(port);
+        if (bind(bc.sink_fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+            throw std::runtime_error("Bind port " + std::to_string(port) + " failed: " + strerror(errno));
+        }
+        ep.type = "udp_client";
+        ep.ip = "127.0.0.1";
+        ep.port = port;
+    } else if (bc.output_kind == "serial") {
+        bc.output_pty = std::make_unique<Pty>();
+        ep.type = "serial";
+        ep.serial_port = bc.output_pty->name;
+        ep.baud_rate = 115200;
+        bc.sink_fd = bc.output_pty->master;
+    } else {
+        throw std::runtime_error("Unknown endpoint kind: " + bc.output_kind);
+    }
+}
+
+// 串口端点的线路参数，如 "8E1"
+static void applySerialLine(EndpointConfig& ep, const BenchOptions& opt) {
+    if (ep.type != "serial") return;
+    const std::string& line = opt.serial_line;
+    if (line.size() != 3 || line[0] < '5' || line[0] > '8' || (line[2] != '1' && line[2] != '2')) {
+        throw std::runtime_error("Invalid serial line: " + line + " (expected e.g. 8N1)");
+    }
+    static const char* kParity[] = {"none", "even", "odd"};
+    const char* parity = strchr("NEO", line[1]);
+    if (parity == nullptr || line[1] == '\0') {
+        throw std::runtime_error("Invalid serial parity: " + line);
+    }
+    ep.serial_data_bits = line[0] - '0';
+    ep.serial_parity = kParity[parity - "NEO"];
+    ep.serial_stop_bits = line[2] - '0';
+    ep.serial_low_latency = opt.low_latency;
+}
+
+// 通道启动后连接 TCP/UDP 对端
+static void connectPeers(BenchChannel& bc) {
+    if (bc.input_kind == "tcp") {
+        bc.source_fd = connectTcp(bc.config.input.port);
+    } else if (bc.input_kind == "udp") {
+        bc.source_fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        sockaddr_in addr = loopbackAddr(bc.config.input.port);
+        connect(bc.source_fd, (sockaddr*)&addr, sizeof(addr));
+    }
+    if (bc.output_kind == "tcp") {
+        bc.sink_fd = connectTcp(bc.config.output.port);
+    }
+}
+
+static bool writeAll(int fd, const uint8_t* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+// 消息头之后的负载：循环填充 kPayloadBytes
+static std::vector<uint8_t> makeMessage(size_t size) {
+    std::vector<uint8_t> msg(size);
+    for (size_t i = sizeof(MessageHeader); i < size; ++i) {
+        msg[i] = kPayloadBytes[(i - sizeof(MessageHeader)) % sizeof(kPayloadBytes)];
+    }
+    return msg;
+}
+
+static void runSender(BenchChannel& bc, const BenchOptions& opt) {
+    std::vector<uint8_t> msg = makeMessage(opt.msg_size);
+    MessageHeader header{kMagic, bc.id, 0, 0};
+    const bool datagram = bc.input_kind == "udp";
+
+    const int64_t start = nowNs();
+    bc.first_send_ns = start;
+    for (uint64_t i = 0; i < opt.count; ++i) {
+        if (opt.rate > 0) {
+            const int64_t due = start + static_cast<int64_t>(i * 1000000000ull / opt.rate);
+            const int64_t wait = due - nowNs();
+            if (wait > 0) {
+                std::this_thread::sleep_for(std::chrono::nanoseconds(wait));
+            }
+        }
+
+        header.seq = i;
+        header.send_ns = nowNs();
+        std::memcpy(msg.data(), &header, sizeof(header));
+
+        const bool ok = datagram ? send(bc.source_fd, msg.data(), msg.size(), 0) >= 0
+                                 : writeAll(bc.source_fd, msg.data(), msg.size());
+        if (!ok) break;
+        bc.sent.fetch_add(1, std::memory_order_relaxed);
+    }
+    bc.sender_done.store(true, std::memory_order_release);
+}
+
+// 解析一条完整消息，返回是否有效（负载被改写的消息视为无效）
+static bool acceptMessage(BenchChannel& bc, const uint8_t* data, const std::vector<uint8_t>& expected,
+                          int64_t recv_ns) {
+    MessageHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != kMagic || header.channel != bc.id) return false;
+    if (std::memcmp(data + sizeof(header), expected.data() + sizeof(header), expected.size() - sizeof(header)) != 0) {
+        return false;
+    }
+
+    bc.latencies_ns.push_back(recv_ns - header.send_ns);
+    ++bc.received;
+    bc.last_recv_ns = recv_ns;
+    return true;
+}
+
+static void runReceiver(BenchChannel& bc, const BenchOptions& opt) {
+    std::vector<uint8_t> buffer(256 * 1024);
+    std::vector<uint8_t> pending;   // 未解析数据
+    const std::vector<uint8_t> expected = makeMessage(opt.msg_size);
+    int64_t idle_since = nowNs();
+
+    while (true) {
+        const bool done = bc.sender_done.load(std::memory_order_acquire);
+        if (done && bc.received >= bc.sent.load(std::memory_order_relaxed)) break;
+        if (done && nowNs() - idle_since > opt.drain_ms * 1000000ll) break;
+
+        pollfd pfd{bc.sink_fd, POLLIN, 0};
+        if (poll(&pfd, 1, 50) <= 0) continue;
+
+        ssize_t n = ::read(bc.sink_fd, buffer.data(), buffer.size());
+        if (n <= 0) {
+            if (n < 0 && (errno == EINTR || errno == EAGAIN)) continue;
+            break;
+        }
+        const int64_t recv_ns = nowNs();
+        idle_since = recv_ns;
+
+        // 按固定长度切分（TCP源的数据报可能包含多条或半条消息），magic 不匹配时逐字节重新同步
+        pending.insert(pending.end(), buffer.begin(), buffer.begin() + n);
+        size_t pos = 0;
+        while (pending.size() - pos >= opt.msg_size) {
+            if (acceptMessage(bc, pending.data() + pos, expected, recv_ns)) {
+                pos += opt.msg_size;
+            } else {
+                ++pos;
+                ++bc.corrupt_bytes;
+            }
+        }
+        pending.erase(pending.begin(), pending.begin() + pos);
+    }
+}
+
+static int64_t percentile(const std::vector<int64_t>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+static std::string runPair(const std::string& pair, size_t pairIndex, const BenchOptions& opt,
+                           ThreadPool& pool) {
+    const size_t dash = pair.find('-');
+    if (dash == std::string::npos) {
+        throw std::runtime_error("Invalid pair: " + pair + " (expected <input>-<output>)");
+    }
+
+    std::vector<std::unique_ptr<BenchChannel>> channels;
+    for (size_t c = 0; c < opt.channels; ++c) {
+        auto bc = std::make_unique<BenchChannel>();
+        bc->id = static_cast<uint32_t>(c);
+        bc->input_kind = pair.substr(0, dash);
+        bc->output_kind = pair.substr(dash + 1);
+        bc->config.name = "bench " + pair + " #" + std::to_string(c);
+        bc->config.coalesce_mode = opt.coalesce;
+
+        const uint16_t port = static_cast<uint16_t>(opt.base_port + (pairIndex * opt.channels + c) * 2);
+        setupInput(*bc, port);
+        setupOutput(*bc, port + 1);
+        applySerialLine(bc->config.input, opt);
+        applySerialLine(bc->config.output, opt);
+        bc->latencies_ns.reserve(opt.count);
+
+        bc->channel = std::make_unique<ProtocolChannel>(bc->config, pool);
+        bc->channel->start();
+        channels.push_back(std::move(bc));
+    }
+
+    // 等待监听socket就绪后连接对端，再等待服务端接受连接
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    for (auto& bc : channels) {
+        connectPeers(*bc);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    std::cerr << "Running " << pair << " x" << opt.channels << "..." << std::endl;
+    const double cpu_start = cpuSeconds();
+    std::vector<std::thread> threads;
+    for (auto& bc : channels) {
+        BenchChannel* p = bc.get();
+        threads.emplace_back([p, &opt] { runReceiver(*p, opt); });
+        threads.emplace_back([p, &opt] { runSender(*p, opt); });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    const double cpu_used = cpuSeconds() - cpu_start;
+
+    // 汇总
+    uint64_t sent = 0, received = 0, corrupt = 0;
+    int64_t first = INT64_MAX, last = 0;
+    std::vector<int64_t> latencies;
+    for (auto& bc : channels) {
+        sent += bc->sent.load();
+        received += bc->received;
+        corrupt += bc->corrupt_bytes;
+        first = std::min(first, bc->first_send_ns);
+        last = std::max(last, bc->last_recv_ns);
+        latencies.insert(latencies.end(), bc->latencies_ns.begin(), bc->latencies_ns.end());
+    }
+    std::sort(latencies.begin(), latencies.end());
+    channels.clear();
+
+    const double duration = last > first ? (last - first) / 1e9 : 0.0;
+    const double bytes = static_cast<double>(received) * opt.msg_size;
+    char json[1024];
+    snprintf(json, sizeof(json),
+             "{\"pair\":\"%s\",\"channels\":%zu,\"msg_size\":%zu,\"sent\":%llu,\"received\":%llu,"
+             "\"drops\":%llu,\"corrupt_bytes\":%llu,\"duration_s\":%.6f,\"msgs_per_sec\":%.1f,"
+             "\"mb_per_sec\":%.3f,\"latency_us\":{\"p50\":%.1f,\"p99\":%.1f,\"p999\":%.1f,\"max\":%.1f},"
+             "\"cpu_seconds\":%.3f,\"cpu_seconds_per_gb\":%.3f}",
+             pair.c_str(), opt.channels, opt.msg_size,
+             (unsigned long long)sent, (unsigned long long)received,
+             (unsigned long long)(sent > received ? sent - received : 0), (unsigned long long)corrupt,
+             duration, duration > 0 ? received / duration : 0.0,
+             duration > 0 ? bytes / duration / 1e6 : 0.0,
+             percentile(latencies, 0.50) / 1e3, percentile(latencies, 0.99) / 1e3,
+             percentile(latencies, 0.999) / 1e3, latencies.empty() ? 0.0 : latencies.back() / 1e3,
+             cpu_used, bytes > 0 ? cpu_used / (bytes / 1e9) : 0.0);
+    return json;
+}
+
+static std::vector<std::string> splitList(const std::string& s) {
+    std::vector<std::string> items;
+    size_t start = 0;
+    while (start <= s.size()) {
+        size_t end = s.find(',', start);
+        if (end == std::string::npos) end = s.size();
+        if (end > start) items.push_back(s.substr(start, end - start));
+        start = end + 1;
+    }
+    return items;
+}
+
+static void usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [options]\n"
+              << "Options:\n"
+              << "  --pairs <list>     Endpoint pairs, comma separated (default: tcp-tcp,tcp-udp,udp-tcp,udp-udp,serial-tcp,tcp-serial)\n"
+              << "                     serial-serial measures the serial turnaround over two ptys\n"
+              << "  --size <bytes>     Message size, at least " << sizeof(MessageHeader) << " (default: 64)\n"
+              << "  --rate <msgs/s>    Send rate per channel, 0 = unlimited (default: 10000)\n"
+              << "  --count <n>        Messages per channel (default: 20000)\n"
+              << "  --channels <n>     Concurrent channels per pair (default: 1)\n"
+              << "  --base-port <port> First loopback port to use (default: 20000)\n"
+              << "  --coalesce <mode>  Channel coalesce mode: latency|throughput (default: latency)\n"
+              << "  --drain-ms <ms>    Idle time before giving up on missing messages (default: 1000)\n"
+              << "  --serial-line <l>  Serial data bits, parity and stop bits, e.g. 8E1 (default: 8N1)\n"
+              << "  --low-latency <0|1> Enable serial_low_latency on serial endpoints (default: 0)\n";
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions opt;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            usage(argv[0]);
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        const std::string value = argv[++i];
+        if (arg == "--pairs") opt.pairs = splitList(value);
+        else if (arg == "--size") opt.msg_size = std::stoul(value);
+        else if (arg == "--rate") opt.rate = std::stoull(value);
+        else if (arg == "--count") opt.count = std::stoull(value);
+        else if (arg == "--channels") opt.channels = std::stoul(value);
+        else if (arg == "--base-port") opt.base_port = static_cast<uint16_t>(std::stoi(value));
+        else if (arg == "--coalesce") opt.coalesce = value;
+        else if (arg == "--drain-ms") opt.drain_ms = std::stoi(value);
+        else if (arg == "--serial-line") opt.serial_line = value;
+        else if (arg == "--low-latency") opt.low_latency = value == "1";
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (opt.msg_size < sizeof(MessageHeader) || opt.channels == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // 关闭日志输出，避免影响测量
+    LogRecord::init(false, false);
+    ThreadPool pool(std::max(2u, std::thread::hardware_concurrency()));
+
+    std::cout << "{\"config\":{\"msg_size\":" << opt.msg_size << ",\"rate\":" << opt.rate
+              << ",\"count\":" << opt.count << ",\"channels\":" << opt.channels
+              << ",\"coalesce\":\"" << opt.coalesce << "\",\"serial_line\":\"" << opt.serial_line
+              << "\",\"low_latency\":" << (opt.low_latency ? "true" : "false") << "},\"results\":[";
+    try {
+        for (size_t i = 0; i < opt.pairs.size(); ++i) {
+            if (i > 0) std::cout << ",";
+            std::cout << "\n" << runPair(opt.pairs[i], i, opt, pool);
+            std::cout.flush();
+        }
+    } catch (const std::exception& e) {
+        std::cout << "\n]}" << std::endl;
+        std::cerr << "Benchmark failed: " << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "\n]}" << std::endl;
+    return 0;
+}
@@ -0,0 +1,160 @@
+// capture_decode.cpp
+// 抓包文件解码工具：把通道抓包（pcapng）还原为原来的二进制日志格式
+//   收到的数据：   <时间> [NODE1 RECV]<长度> bytes: 十六进制
+//   转发的数据：   <时间> [INFO ] [<通道>] [NODE1->NODE2] <长度> bytes: 文本
+// 用法：capture_decode [--hex | --text] <file.pcapng>...
+//   --hex / --text 把所有数据统一按十六进制 / 文本输出
+#include "packet_capture.h"
+#include "log_format.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+enum class Format { Auto, Hex, Text };
+
+struct InterfaceInfo {
+    uint16_t link_type = 0;
+    std::string channel;
+    std::string label;
+    uint64_t ticks_per_second = 1000000;    // 默认精度为微秒
+};
+
+static uint32_t readU32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint16_t readU16(const uint8_t* p) {
+    uint16_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static InterfaceInfo parseInterface(const uint8_t* body, size_t len) {
+    InterfaceInfo info;
+    if (len < 8) return info;
+    info.link_type = readU16(body);
+
+    size_t pos = 8;
+    while (pos + 4 <= len) {
+        const uint16_t code = readU16(body + pos);
+        const uint16_t optLen = readU16(body + pos + 2);
+        const uint8_t* value = body + pos + 4;
+        if (code == kPcapngOptEnd || pos + 4 + optLen > len) break;
+
+        if (code == kPcapngOptIfName) {
+            info.channel.assign(reinterpret_cast<const char*>(value), optLen);
+        } else if (code == kPcapngOptIfDescription) {
+            info.label.assign(reinterpret_cast<const char*>(value), optLen);
+        } else if (code == kPcapngOptIfTsresol && optLen >= 1) {
+            // 最高位为0表示10的负n次方秒，为1表示2的负n次方秒
+            const uint8_t resol = value[0];
+            info.ticks_per_second = 1;
+            for (int i = 0; i < (resol & 0x7F); ++i) {
+                info.ticks_per_second *= (resol & 0x80) ? 2 : 10;
+            }
+        }
+        pos += 4 + ((optLen + 3) & ~3u);
+    }
+    return info;
+}
+
+static void printPacket(const InterfaceInfo& iface, Format format, uint64_t ns,
+                        const uint8_t* data, uint32_t caplen, uint32_t len) {
+    const bool hex = format == Format::Hex ||
+                     (format == Format::Auto && iface.link_type != kLinkTypeForwarded);
+    std::string line = formatLogTime(ns);
+    if (hex) {
+        static const char kHex[] = "0123456789abcdef";
+        line += ' ';
+        line += iface.label;
+        line += std::to_string(len) + " bytes: ";
+        for (uint32_t i = 0; i < caplen; ++i) {
+            line += kHex[data[i] >> 4];
+            line += kHex[data[i] & 0x0F];
+            if (i + 1 < caplen) line += ' ';
+        }
+    } else {
+        line += " [INFO ] [" + iface.channel + "] " + iface.label + " " + std::to_string(len) + " bytes: ";
+        line.append(reinterpret_cast<const char*>(data), caplen);
+    }
+    line += '\n';
+    std::cout.write(line.data(), static_cast<std::streamsize>(line.size()));
+}
+
+static bool decodeFile(const std::string& path, Format format) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Cannot open " << path << std::endl;
+        return false;
+    }
+    const std::vector<uint8_t> buf((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    std::vector<InterfaceInfo> interfaces;
+    size_t pos = 0;
+    while (pos + 12 <= buf.size()) {
+        const uint32_t type = readU32(&buf[pos]);
+        const uint32_t total = readU32(&buf[pos + 4]);
+        // 零块：进程异常退出时预分配空间中未写入的部分
+        if (type == 0 && total == 0) break;
+        if (total < 12 || total % 4 != 0 || pos + total > buf.size()) {
+            std::cerr << path << ": malformed block at offset " << pos << std::endl;
+            return false;
+        }
+
+        const uint8_t* body = &buf[pos + 8];
+        const size_t bodyLen = total - 12;
+        if (type == kPcapngSectionHeader) {
+            if (bodyLen < 16 || readU32(body) != kPcapngByteOrderMagic) {
+                std::cerr << path << ": unsupported byte order or not a pcapng file" << std::endl;
+                return false;
+            }
+            interfaces.clear();
+        } else if (type == kPcapngInterfaceDescription) {
+            interfaces.push_back(parseInterface(body, bodyLen));
+        } else if (type == kPcapngEnhancedPacket && bodyLen >= 20) {
+            const uint32_t id = readU32(body);
+            const uint64_t ticks = (static_cast<uint64_t>(readU32(body + 4)) << 32) | readU32(body + 8);
+            const uint32_t caplen = readU32(body + 12);
+            const uint32_t len = readU32(body + 16);
+            if (id < interfaces.size() && 20 + static_cast<size_t>(caplen) <= bodyLen) {
+                const InterfaceInfo& iface = interfaces[id];
+                const uint64_t ns = iface.ticks_per_second == 1000000000
+                                        ? ticks
+                                        : static_cast<uint64_t>(ticks * (1e9 / iface.ticks_per_second));
+                printPacket(iface, format, ns, body + 20, caplen, len);
+            }
+        }
+        pos += total;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    Format format = Format::Auto;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--hex") == 0) {
+            format = Format::Hex;
+        } else if (strcmp(argv[i], "--text") == 0) {
+            format = Format::Text;
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+    if (files.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--hex | --text] <file.pcapng>...\n";
+        return 1;
+    }
+
+    bool ok = true;
+    for (const auto& path : files) {
+        ok &= decodeFile(path, format);
+    }
+    return ok ? 0 : 1;
+}
@@ -32,6 +32,26 @@ std::unique_ptr<IConfigParser> ConfigParserFactory::createParser(const std::stri
     }
 }
 
+// 解析套接字调优参数
+SocketOptions ConfigParserFactory::parseSocketOptions(const nlohmann::json& j) {
+    SocketOptions options;
+    if (j.contains("rcvbuf")) options.rcvbuf = j["rcvbuf"].get<uint32_t>();
+    if (j.contains("sndbuf")) options.sndbuf = j["sndbuf"].get<uint32_t>();
+    if (j.contains("tcp_nodelay")) options.tcp_nodelay = j["tcp_nodelay"].get<bool>();
+    if (j.contains("tcp_quickack")) options.tcp_quickack = j["tcp_quickack"].get<bool>();
+    if (j.contains("busy_poll_usec")) options.busy_poll_usec = j["busy_poll_usec"].get<uint32_t>();
+    if (j.contains("priority")) options.priority = j["priority"].get<uint32_t>();
+    if (j.contains("tcp_user_timeout_ms")) options.tcp_user_timeout_ms = j["tcp_user_timeout_ms"].get<uint32_t>();
+    if (j.contains("ip_tos")) options.ip_tos = j["ip_tos"].get<uint32_t>();
+    if (j.contains("keepalive")) options.keepalive = j["keepalive"].get<bool>();
+    if (j.contains("keepalive_idle_sec")) options.keepalive_idle_sec = j["keepalive_idle_sec"].get<uint32_t>();
+    if (j.contains("keepalive_interval_sec")) {
+        options.keepalive_interval_sec = j["keepalive_interval_sec"].get<uint32_t>();
+    }
+    if (j.contains("keepalive_count")) options.keepalive_count = j["keepalive_count"].get<uint32_t>();
+    return options;
+}
+
 // 解析端点配置
 EndpointConfig ConfigParserFactory::parseEndpoint(const nlohmann::json& j) {
     EndpointConfig config;
@@ -49,6 +69,81 @@ EndpointConfig ConfigParserFactory::parseEndpoint(const nlohmann::json& j) {
     if (j.contains("baud_rate")) {
         config.baud_rate = j["baud_rate"].get<uint32_t>();
     }
+    if (j.contains("serial_data_bits")) {
+        config.serial_data_bits = j["serial_data_bits"].get<uint32_t>();
+    }
+    if (j.contains("serial_parity")) {
+        config.serial_parity = j["serial_parity"].get<std::string>();
+    }
+    if (j.contains("serial_stop_bits")) {
+        config.serial_stop_bits = j["serial_stop_bits"].get<uint32_t>();
+    }
+    if (j.contains("serial_rtscts")) {
+        config.serial_rtscts = j["serial_rtscts"].get<bool>();
+    }
+    if (j.contains("serial_low_latency")) {
+        config.serial_low_latency = j["serial_low_latency"].get<bool>();
+    }
+    if (j.contains("frame_gap_chars")) {
+        config.frame_gap_chars = j["frame_gap_chars"].get<double>();
+    }
+    if (j.contains("frame_max_bytes")) {
+        config.frame_max_bytes = j["frame_max_bytes"].get<uint32_t>();
+    }
+    if (j.contains("frame_delimiter")) {
+        config.frame_delimiter = j["frame_delimiter"].get<int32_t>();
+    }
+    if (j.contains("send_queue_bytes")) {
+        config.send_queue_bytes = j["send_queue_bytes"].get<uint32_t>();
+    }
+    if (j.contains("slow_client_policy")) {
+        config.slow_client_policy = j["slow_client_policy"].get<std::string>();
+    }
+    if (j.contains("recv_batch")) {
+        config.recv_batch = j["recv_batch"].get<uint32_t>();
+    }
+    if (j.contains("recv_slot_bytes")) {
+        config.recv_slot_bytes = j["recv_slot_bytes"].get<uint32_t>();
+    }
+    if (j.contains("peer_expiry_sec")) {
+        config.peer_expiry_sec = j["peer_expiry_sec"].get<uint32_t>();
+    }
+    if (j.contains("reconnect_min_ms")) {
+        config.reconnect_min_ms = j["reconnect_min_ms"].get<uint32_t>();
+    }
+    if (j.contains("reconnect_max_ms")) {
+        config.reconnect_max_ms = j["reconnect_max_ms"].get<uint32_t>();
+    }
+    if (j.contains("accept_shards")) {
+        config.accept_shards = j["accept_shards"].get<uint32_t>();
+    }
+    if (j.contains("listen_backlog")) {
+        config.listen_backlog = j["listen_backlog"].get<uint32_t>();
+    }
+    if (j.contains("shm_name")) {
+        config.shm_name = j["shm_name"].get<std::string>();
+    }
+    if (j.contains("shm_capacity")) {
+        config.shm_capacity = j["shm_capacity"].get<uint32_t>();
+    }
+    if (j.contains("unix_path")) {
+        config.unix_path = j["unix_path"].get<std::string>();
+    }
+    if (j.contains("unix_mode")) {
+        config.unix_mode = j["unix_mode"].get<std::string>();
+    }
+    if (j.contains("multicast_interface")) {
+        config.multicast_interface = j["multicast_interface"].get<std::string>();
+    }
+    if (j.contains("multicast_ttl")) {
+        config.multicast_ttl = j["multicast_ttl"].get<uint32_t>();
+    }
+    if (j.contains("multicast_loopback")) {
+        config.multicast_loopback = j["multicast_loopback"].get<bool>();
+    }
+    if (j.contains("socket")) {
+        config.socket = parseSocketOptions(j["socket"]);
+    }
     
     return config;
 }
@@ -66,6 +161,39 @@ std::vector<ChannelConfig> ConfigParserFactory::parseJson(const nlohmann::json&
         config.name = channel["name"].get<std::string>();
         config.input = parseEndpoint(channel["input"]);
         config.output = parseEndpoint(channel["output"]);
+        
+        // 流控配置（可选）
+        if (channel.contains("flow_control")) {
+            config.flow_control = channel["flow_control"].get<bool>();
+        }
+        if (channel.contains("high_watermark")) {
+            config.high_watermark = channel["high_watermark"].get<uint32_t>();
+        }
+        if (channel.contains("low_watermark")) {
+            config.low_watermark = channel["low_watermark"].get<uint32_t>();
+        }
+
+        // 输出合并配置（可选）
+        if (channel.contains("coalesce_mode")) {
+            config.coalesce_mode = channel["coalesce_mode"].get<std::string>();
+        }
+        if (channel.contains("coalesce_bytes")) {
+            config.coalesce_bytes = channel["coalesce_bytes"].get<uint32_t>();
+        }
+        if (channel.contains("coalesce_usec")) {
+            config.coalesce_usec = channel["coalesce_usec"].get<uint32_t>();
+        }
+
+        // 抓包配置（可选）
+        if (channel.contains("capture_dir")) {
+            config.capture_dir = channel["capture_dir"].get<std::string>();
+        }
+        if (channel.contains("capture_segment_bytes")) {
+            config.capture_segment_bytes = channel["capture_segment_bytes"].get<uint32_t>();
+        }
+        if (channel.contains("capture_segments")) {
+            config.capture_segments = channel["capture_segments"].get<uint32_t>();
+        }
         channels.push_back(config);
     }
     
@@ -84,6 +212,60 @@ std::vector<ChannelConfig> JsonConfigParser::parse(const std::string& filename)
     return ConfigParserFactory::parseJson(config);
 }
 
+// 解析YAML套接字调优参数
+static SocketOptions parseYamlSocketOptions(const YAML::Node& node) {
+    SocketOptions options;
+    if (node["rcvbuf"]) options.rcvbuf = node["rcvbuf"].as<uint32_t>();
+    if (node["sndbuf"]) options.sndbuf = node["sndbuf"].as<uint32_t>();
+    if (node["tcp_nodelay"]) options.tcp_nodelay = node["tcp_nodelay"].as<bool>();
+    if (node["tcp_quickack"]) options.tcp_quickack = node["tcp_quickack"].as<bool>();
+    if (node["busy_poll_usec"]) options.busy_poll_usec = node["busy_poll_usec"].as<uint32_t>();
+    if (node["priority"]) options.priority = node["priority"].as<uint32_t>();
+    if (node["tcp_user_timeout_ms"]) options.tcp_user_timeout_ms = node["tcp_user_timeout_ms"].as<uint32_t>();
+    if (node["ip_tos"]) options.ip_tos = node["ip_tos"].as<uint32_t>();
+    if (node["keepalive"]) options.keepalive = node["keepalive"].as<bool>();
+    if (node["keepalive_idle_sec"]) options.keepalive_idle_sec = node["keepalive_idle_sec"].as<uint32_t>();
+    if (node["keepalive_interval_sec"]) options.keepalive_interval_sec = node["keepalive_interval_sec"].as<uint32_t>();
+    if (node["keepalive_count"]) options.keepalive_count = node["keepalive_count"].as<uint32_t>();
+    return options;
+}
+
+// 解析YAML端点配置
+static EndpointConfig parseYamlEndpoint(const YAML::Node& node) {
+    EndpointConfig config;
+    config.type = node["type"].as<std::string>();
+    if (node["port"]) config.port = node["port"].as<uint16_t>();
+    if (node["ip"]) config.ip = node["ip"].as<std::string>();
+    if (node["serial_port"]) config.serial_port = node["serial_port"].as<std::string>();
+    if (node["baud_rate"]) config.baud_rate = node["baud_rate"].as<uint32_t>();
+    if (node["serial_data_bits"]) config.serial_data_bits = node["serial_data_bits"].as<uint32_t>();
+    if (node["serial_parity"]) config.serial_parity = node["serial_parity"].as<std::string>();
+    if (node["serial_stop_bits"]) config.serial_stop_bits = node["serial_stop_bits"].as<uint32_t>();
+    if (node["serial_rtscts"]) config.serial_rtscts = node["serial_rtscts"].as<bool>();
+    if (node["serial_low_latency"]) config.serial_low_latency = node["serial_low_latency"].as<bool>();
+    if (node["frame_gap_chars"]) config.frame_gap_chars = node["frame_gap_chars"].as<double>();
+    if (node["frame_max_bytes"]) config.frame_max_bytes = node["frame_max_bytes"].as<uint32_t>();
+    if (node["frame_delimiter"]) config.frame_delimiter = node["frame_delimiter"].as<int32_t>();
+    if (node["send_queue_bytes"]) config.send_queue_bytes = node["send_queue_bytes"].as<uint32_t>();
+    if (node["slow_client_policy"]) config.slow_client_policy = node["slow_client_policy"].as<std::string>();
+    if (node["recv_batch"]) config.recv_batch = node["recv_batch"].as<uint32_t>();
+    if (node["recv_slot_bytes"]) config.recv_slot_bytes = node["recv_slot_bytes"].as<uint32_t>();
+    if (node["peer_expiry_sec"]) config.peer_expiry_sec = node["peer_expiry_sec"].as<uint32_t>();
+    if (node["reconnect_min_ms"]) config.reconnect_min_ms = node["reconnect_min_ms"].as<uint32_t>();
+    if (node["reconnect_max_ms"]) config.reconnect_max_ms = node["reconnect_max_ms"].as<uint32_t>();
+    if (node["accept_shards"]) config.accept_shards = node["accept_shards"].as<uint32_t>();
+    if (node["listen_backlog"]) config.listen_backlog = node["listen_backlog"].as<uint32_t>();
+    if (node["shm_name"]) config.shm_name = node["shm_name"].as<std::string>();
+    if (node["shm_capacity"]) config.shm_capacity = node["shm_capacity"].as<uint32_t>();
+    if (node["unix_path"]) config.unix_path = node["unix_path"].as<std::string>();
+    if (node["unix_mode"]) config.unix_mode = node["unix_mode"].as<std::string>();
+    if (node["multicast_interface"]) config.multicast_interface = node["multicast_interface"].as<std::string>();
+    if (node["multicast_ttl"]) config.multicast_ttl = node["multicast_ttl"].as<uint32_t>();
+    if (node["multicast_loopback"]) config.multicast_loopback = node["multicast_loopback"].as<bool>();
+    if (node["socket"]) config.socket = parseYamlSocketOptions(node["socket"]);
+    return config;
+}
+
 // YAML 解析器实现
 std::vector<ChannelConfig> YamlConfigParser::parse(const std::string& filename) {
     YAML::Node config = YAML::LoadFile(filename);
@@ -97,21 +279,24 @@ std::vector<ChannelConfig> YamlConfigParser::parse(const std::string& filename)
         ChannelConfig chConfig;
         chConfig.name = channel["name"].as<std::string>();
         
-        // 解析输入端点
-        YAML::Node input = channel["input"];
-        chConfig.input.type = input["type"].as<std::string>();
-        if (input["port"]) chConfig.input.port = input["port"].as<uint16_t>();
-        if (input["ip"]) chConfig.input.ip = input["ip"].as<std::string>();
-        if (input["serial_port"]) chConfig.input.serial_port = input["serial_port"].as<std::string>();
-        if (input["baud_rate"]) chConfig.input.baud_rate = input["baud_rate"].as<uint32_t>();
+        // 解析输入/输出端点
+        chConfig.input = parseYamlEndpoint(channel["input"]);
+        chConfig.output = parseYamlEndpoint(channel["output"]);
         
-        // 解析输出端点
-        YAML::Node output = channel["output"];
-        chConfig.output.type = output["type"].as<std::string>();
-        if (output["port"]) chConfig.output.port = output["port"].as<uint16_t>();
-        if (output["ip"]) chConfig.output.ip = output["ip"].as<std::string>();
-        if (output["serial_port"]) chConfig.output.serial_port = output["serial_port"].as<std::string>();
-        if (output["baud_rate"]) chConfig.output.baud_rate = output["baud_rate"].as<uint32_t>();
+        // 流控配置（可选）
+        if (channel["flow_control"]) chConfig.flow_control = channel["flow_control"].as<bool>();
+        if (channel["high_watermark"]) chConfig.high_watermark = channel["high_watermark"].as<uint32_t>();
+        if (channel["low_watermark"]) chConfig.low_watermark = channel["low_watermark"].as<uint32_t>();
+
+        // 输出合并配置（可选）
+        if (channel["coalesce_mode"]) chConfig.coalesce_mode = channel["coalesce_mode"].as<std::string>();
+        if (channel["coalesce_bytes"]) chConfig.coalesce_bytes = channel["coalesce_bytes"].as<uint32_t>();
+        if (channel["coalesce_usec"]) chConfig.coalesce_usec = channel["coalesce_usec"].as<uint32_t>();
+
+        // 抓包配置（可选）
+        if (channel["capture_dir"]) chConfig.capture_dir = channel["capture_dir"].as<std::string>();
+        if (channel["capture_segment_bytes"]) chConfig.capture_segment_bytes = channel["capture_segment_bytes"].as<uint32_t>();
+        if (channel["capture_segments"]) chConfig.capture_segments = channel["capture_segments"].as<uint32_t>();
         
         channels.push_back(chConfig);
     }
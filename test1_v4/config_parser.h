@@ -37,5 +37,6 @@ public:
     
     // 辅助函数
     static EndpointConfig parseEndpoint(const nlohmann::json& j);
+    static SocketOptions parseSocketOptions(const nlohmann::json& j);
     static std::vector<ChannelConfig> parseJson(const nlohmann::json& j);
 };
\ No newline at end of file
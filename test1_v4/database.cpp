@@ -2,6 +2,60 @@
 #include <stdexcept>
 #include <iostream>
 #include <cstdint>
+#include <cstring>
+
+// endpoints 表中的配置列（顺序需与 readEndpoint / insertEndpoint 保持一致）
+static const char* const kEndpointColumns[] = {
+    "type", "port", "ip", "serial_port", "baud_rate", "send_queue_bytes", "slow_client_policy",
+    "recv_batch", "recv_slot_bytes", "peer_expiry_sec",
+    "reconnect_min_ms", "reconnect_max_ms", "accept_shards", "listen_backlog",
+    "shm_name", "shm_capacity", "unix_path", "unix_mode",
+    "multicast_interface", "multicast_ttl", "multicast_loopback",
+    "sock_rcvbuf", "sock_sndbuf", "sock_tcp_nodelay", "sock_tcp_quickack", "sock_busy_poll_usec",
+    "sock_priority", "sock_tcp_user_timeout_ms", "sock_ip_tos", "sock_keepalive",
+    "sock_keepalive_idle_sec", "sock_keepalive_interval_sec", "sock_keepalive_count",
+    "frame_gap_chars", "frame_max_bytes", "frame_delimiter",
+    "serial_data_bits", "serial_parity", "serial_stop_bits", "serial_rtscts", "serial_low_latency"
+};
+static constexpr int kEndpointColumnCount = sizeof(kEndpointColumns) / sizeof(kEndpointColumns[0]);
+
+static std::string endpointSelectList(const std::string& alias) {
+    std::string list;
+    for (const char* column : kEndpointColumns) {
+        if (!list.empty()) list += ", ";
+        list += alias + "." + column;
+    }
+    return list;
+}
+
+// INSERT INTO endpoints (channel_id, role, <配置列>) VALUES (?, ...)
+static std::string endpointInsertSql() {
+    std::string columns = "channel_id, role";
+    std::string values = "?, ?";
+    for (const char* column : kEndpointColumns) {
+        columns += std::string(", ") + column;
+        values += ", ?";
+    }
+    return "INSERT INTO endpoints (" + columns + ") VALUES (" + values + ");";
+}
+
+// 可选整数列：0 表示未设置，存为 NULL
+static void bindOptional(sqlite3_stmt* stmt, int index, int64_t value) {
+    if (value > 0) {
+        sqlite3_bind_int64(stmt, index, value);
+    } else {
+        sqlite3_bind_null(stmt, index);
+    }
+}
+
+static bool columnIsNull(sqlite3_stmt* stmt, int col) {
+    return sqlite3_column_type(stmt, col) == SQLITE_NULL;
+}
+
+static std::string columnText(sqlite3_stmt* stmt, int col) {
+    return reinterpret_cast<const char*>(sqlite3_column_text(stmt, col));
+}
+
 Database::Database(const std::string& db_path) {
     if (sqlite3_open(db_path.c_str(), &db_) != SQLITE_OK) {
         throw std::runtime_error("Cannot open database: " + std::string(sqlite3_errmsg(db_)));
@@ -20,7 +74,16 @@ void Database::initDatabase() {
         
         CREATE TABLE IF NOT EXISTS channels (
             id INTEGER PRIMARY KEY,
-            name TEXT NOT NULL UNIQUE
+            name TEXT NOT NULL UNIQUE,
+            flow_control INTEGER NOT NULL DEFAULT 0,
+            high_watermark INTEGER,
+            low_watermark INTEGER,
+            coalesce_mode TEXT NOT NULL DEFAULT 'latency',
+            coalesce_bytes INTEGER,
+            coalesce_usec INTEGER,
+            capture_dir TEXT,
+            capture_segment_bytes INTEGER,
+            capture_segments INTEGER
         );
         
         CREATE TABLE IF NOT EXISTS endpoints (
@@ -32,9 +95,106 @@ void Database::initDatabase() {
             ip TEXT,
             serial_port TEXT,
             baud_rate INTEGER,
+            send_queue_bytes INTEGER,
+            slow_client_policy TEXT,
+            recv_batch INTEGER,
+            recv_slot_bytes INTEGER,
+            peer_expiry_sec INTEGER,
+            reconnect_min_ms INTEGER,
+            reconnect_max_ms INTEGER,
+            accept_shards INTEGER,
+            listen_backlog INTEGER,
+            shm_name TEXT,
+            shm_capacity INTEGER,
+            unix_path TEXT,
+            unix_mode TEXT,
+            multicast_interface TEXT,
+            multicast_ttl INTEGER,
+            multicast_loopback INTEGER,
+            sock_rcvbuf INTEGER,
+            sock_sndbuf INTEGER,
+            sock_tcp_nodelay INTEGER,
+            sock_tcp_quickack INTEGER,
+            sock_busy_poll_usec INTEGER,
+            sock_priority INTEGER,
+            sock_tcp_user_timeout_ms INTEGER,
+            sock_ip_tos INTEGER,
+            sock_keepalive INTEGER,
+            sock_keepalive_idle_sec INTEGER,
+            sock_keepalive_interval_sec INTEGER,
+            sock_keepalive_count INTEGER,
+            frame_gap_chars REAL,
+            frame_max_bytes INTEGER,
+            frame_delimiter INTEGER,
+            serial_data_bits INTEGER,
+            serial_parity TEXT,
+            serial_stop_bits INTEGER,
+            serial_rtscts INTEGER,
+            serial_low_latency INTEGER,
             FOREIGN KEY(channel_id) REFERENCES channels(id) ON DELETE CASCADE
         );
     )");
+
+    // 兼容旧版本数据库：补齐新增列
+    ensureColumn("channels", "flow_control", "INTEGER NOT NULL DEFAULT 0");
+    ensureColumn("channels", "high_watermark", "INTEGER");
+    ensureColumn("channels", "low_watermark", "INTEGER");
+    ensureColumn("channels", "coalesce_mode", "TEXT NOT NULL DEFAULT 'latency'");
+    ensureColumn("channels", "coalesce_bytes", "INTEGER");
+    ensureColumn("channels", "coalesce_usec", "INTEGER");
+    ensureColumn("channels", "capture_dir", "TEXT");
+    ensureColumn("channels", "capture_segment_bytes", "INTEGER");
+    ensureColumn("channels", "capture_segments", "INTEGER");
+    ensureColumn("endpoints", "send_queue_bytes", "INTEGER");
+    ensureColumn("endpoints", "slow_client_policy", "TEXT");
+    ensureColumn("endpoints", "recv_batch", "INTEGER");
+    ensureColumn("endpoints", "recv_slot_bytes", "INTEGER");
+    ensureColumn("endpoints", "peer_expiry_sec", "INTEGER");
+    ensureColumn("endpoints", "reconnect_min_ms", "INTEGER");
+    ensureColumn("endpoints", "reconnect_max_ms", "INTEGER");
+    ensureColumn("endpoints", "accept_shards", "INTEGER");
+    ensureColumn("endpoints", "listen_backlog", "INTEGER");
+    ensureColumn("endpoints", "shm_name", "TEXT");
+    ensureColumn("endpoints", "shm_capacity", "INTEGER");
+    ensureColumn("endpoints", "unix_path", "TEXT");
+    ensureColumn("endpoints", "unix_mode", "TEXT");
+    ensureColumn("endpoints", "multicast_interface", "TEXT");
+    ensureColumn("endpoints", "multicast_ttl", "INTEGER");
+    ensureColumn("endpoints", "multicast_loopback", "INTEGER");
+    // 套接字调优列（sock_*）均为 INTEGER
+    for (const char* column : kEndpointColumns) {
+        if (std::strncmp(column, "sock_", 5) == 0) ensureColumn("endpoints", column, "INTEGER");
+    }
+    ensureColumn("endpoints", "frame_gap_chars", "REAL");
+    ensureColumn("endpoints", "frame_max_bytes", "INTEGER");
+    ensureColumn("endpoints", "frame_delimiter", "INTEGER");
+    ensureColumn("endpoints", "serial_data_bits", "INTEGER");
+    ensureColumn("endpoints", "serial_parity", "TEXT");
+    ensureColumn("endpoints", "serial_stop_bits", "INTEGER");
+    ensureColumn("endpoints", "serial_rtscts", "INTEGER");
+    ensureColumn("endpoints", "serial_low_latency", "INTEGER");
+}
+
+void Database::ensureColumn(const std::string& table, const std::string& column,
+                            const std::string& definition) {
+    sqlite3_stmt* stmt;
+    const std::string sql = "PRAGMA table_info(" + table + ");";
+    if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        throw std::runtime_error(sqlite3_errmsg(db_));
+    }
+
+    bool exists = false;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        if (column == reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1))) {
+            exists = true;
+            break;
+        }
+    }
+    sqlite3_finalize(stmt);
+
+    if (!exists) {
+        executeSQL("ALTER TABLE " + table + " ADD COLUMN " + column + " " + definition + ";");
+    }
 }
 
 void Database::executeSQL(const std::string& sql) {
@@ -47,50 +207,48 @@ void Database::executeSQL(const std::string& sql) {
 }
 
 std::vector<ChannelConfig> Database::loadChannels() {
-    const char* sql = R"(
-        SELECT c.name, 
-               i.type AS input_type, i.port AS input_port, i.ip AS input_ip,
-               i.serial_port AS input_serial_port, i.baud_rate AS input_baud,
-               
-               o.type AS output_type, o.port AS output_port, o.ip AS output_ip,
-               o.serial_port AS output_serial_port, o.baud_rate AS output_baud
-               
+    // 列顺序：通道列(10) + 输入端点列 + 输出端点列
+    const std::string sql =
+        "SELECT c.name, c.flow_control, c.high_watermark, c.low_watermark, "
+        "c.coalesce_mode, c.coalesce_bytes, c.coalesce_usec, "
+        "c.capture_dir, c.capture_segment_bytes, c.capture_segments, " +
+        endpointSelectList("i") + ", " + endpointSelectList("o") + R"(
         FROM channels c
         JOIN endpoints i ON c.id = i.channel_id AND i.role = 'input'
         JOIN endpoints o ON c.id = o.channel_id AND o.role = 'output'
     )";
+    constexpr int kChannelColumnCount = 10;
 
     sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
         throw std::runtime_error(sqlite3_errmsg(db_));
     }
     
     std::vector<ChannelConfig> channels;
     while (sqlite3_step(stmt) == SQLITE_ROW) {
         ChannelConfig config;
-        config.name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-        
-        // 输入端点配置
-        config.input.type = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-        if (sqlite3_column_type(stmt, 2) != SQLITE_NULL) 
-            config.input.port = sqlite3_column_int(stmt, 2);
-        if (sqlite3_column_type(stmt, 3) != SQLITE_NULL) 
-            config.input.ip = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
-        if (sqlite3_column_type(stmt, 4) != SQLITE_NULL) 
-            config.input.serial_port = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
-        if (sqlite3_column_type(stmt, 5) != SQLITE_NULL) 
-            config.input.baud_rate = sqlite3_column_int(stmt, 5);
+        config.name = columnText(stmt, 0);
+        config.flow_control = sqlite3_column_int(stmt, 1) != 0;
+        if (!columnIsNull(stmt, 2))
+            config.high_watermark = sqlite3_column_int64(stmt, 2);
+        if (!columnIsNull(stmt, 3))
+            config.low_watermark = sqlite3_column_int64(stmt, 3);
+        if (!columnIsNull(stmt, 4))
+            config.coalesce_mode = columnText(stmt, 4);
+        if (!columnIsNull(stmt, 5))
+            config.coalesce_bytes = sqlite3_column_int64(stmt, 5);
+        if (!columnIsNull(stmt, 6))
+            config.coalesce_usec = sqlite3_column_int64(stmt, 6);
+        if (!columnIsNull(stmt, 7))
+            config.capture_dir = columnText(stmt, 7);
+        if (!columnIsNull(stmt, 8))
+            config.capture_segment_bytes = sqlite3_column_int64(stmt, 8);
+        if (!columnIsNull(stmt, 9))
+            config.capture_segments = sqlite3_column_int64(stmt, 9);
         
-        // 输出端点配置
-        config.output.type = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 6));
-        if (sqlite3_column_type(stmt, 7) != SQLITE_NULL) 
-            config.output.port = sqlite3_column_int(stmt, 7);
-        if (sqlite3_column_type(stmt, 8) != SQLITE_NULL) 
-            config.output.ip = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 8));
-        if (sqlite3_column_type(stmt, 9) != SQLITE_NULL) 
-            config.output.serial_port = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 9));
-        if (sqlite3_column_type(stmt, 10) != SQLITE_NULL) 
-            config.output.baud_rate = sqlite3_column_int(stmt, 10);
+        // 输入/输出端点配置
+        readEndpoint(stmt, kChannelColumnCount, config.input);
+        readEndpoint(stmt, kChannelColumnCount + kEndpointColumnCount, config.output);
         
         channels.push_back(config);
     }
@@ -99,23 +257,112 @@ std::vector<ChannelConfig> Database::loadChannels() {
     return channels;
 }
 
+void Database::readEndpoint(sqlite3_stmt* stmt, int firstColumn, EndpointConfig& config) {
+    int col = firstColumn;
+    config.type = columnText(stmt, col++);
+    if (!columnIsNull(stmt, col)) config.port = sqlite3_column_int(stmt, col);
+    ++col;
+    if (!columnIsNull(stmt, col)) config.ip = columnText(stmt, col);
+    ++col;
+    if (!columnIsNull(stmt, col)) config.serial_port = columnText(stmt, col);
+    ++col;
+    if (!columnIsNull(stmt, col)) config.baud_rate = sqlite3_column_int(stmt, col);
+    ++col;
+    if (!columnIsNull(stmt, col)) config.send_queue_bytes = sqlite3_column_int64(stmt, col);
+    ++col;
+    if (!columnIsNull(stmt, col)) config.slow_client_policy = columnText(stmt, col);
+    ++col;
+    if (!columnIsNull(stmt, col)) config.recv_batch = sqlite3_column_int64(stmt, col);
+    ++col;
+    if (!columnIsNull(stmt, col)) config.recv_slot_bytes = sqlite3_column_int64(stmt, col);
+    ++col;
+    if (!columnIsNull(stmt, col)) config.peer_expiry_sec = sqlite3_column_int64(stmt, col);
+    ++col;
+    if (!columnIsNull(stmt, col)) config.reconnect_min_ms = sqlite3_column_int64(stmt, col);
+    ++col;
+    if (!columnIsNull(stmt, col)) config.reconnect_max_ms = sqlite3_column_int64(stmt, col);
+    ++col;
+    if (!columnIsNull(stmt, col)) config.accept_shards = sqlite3_column_int64(stmt, col);
+    ++col;
+    if (!columnIsNull(stmt, col)) config.listen_backlog = sqlite3_column_int64(stmt, col);
+    ++col;
+    if (!columnIsNull(stmt, col)) config.shm_name = columnText(stmt, col);
+    ++col;
+    if (!columnIsNull(stmt, col)) config.shm_capacity = sqlite3_column_int64(stmt, col);
+    ++col;
+    if (!columnIsNull(stmt, col)) config.unix_path = columnText(stmt, col);
+    ++col;
+    if (!columnIsNull(stmt, col)) config.unix_mode = columnText(stmt, col);
+    ++col;
+    if (!columnIsNull(stmt, col)) config.multicast_interface = columnText(stmt, col);
+    ++col;
+    if (!columnIsNull(stmt, col)) config.multicast_ttl = sqlite3_column_int64(stmt, col);
+    ++col;
+    if (!columnIsNull(stmt, col)) config.multicast_loopback = sqlite3_column_int(stmt, col) != 0;
+    ++col;
+
+    SocketOptions& socket = config.socket;
+    if (!columnIsNull(stmt, col)) socket.rcvbuf = sqlite3_column_int64(stmt, col);
+    ++col;
+    if (!columnIsNull(stmt, col)) socket.sndbuf = sqlite3_column_int64(stmt, col);
+    ++col;
+    if (!columnIsNull(stmt, col)) socket.tcp_nodelay = sqlite3_column_int(stmt, col) != 0;
+    ++col;
+    if (!columnIsNull(stmt, col)) socket.tcp_quickack = sqlite3_column_int(stmt, col) != 0;
+    ++col;
+    if (!columnIsNull(stmt, col)) socket.busy_poll_usec = sqlite3_column_int64(stmt, col);
+    ++col;
+    if (!columnIsNull(stmt, col)) socket.priority = sqlite3_column_int64(stmt, col);
+    ++col;
+    if (!columnIsNull(stmt, col)) socket.tcp_user_timeout_ms = sqlite3_column_int64(stmt, col);
+    ++col;
+    if (!columnIsNull(stmt, col)) socket.ip_tos = sqlite3_column_int64(stmt, col);
+    ++col;
+    if (!columnIsNull(stmt, col)) socket.keepalive = sqlite3_column_int(stmt, col) != 0;
+    ++col;
+    if (!columnIsNull(stmt, col)) socket.keepalive_idle_sec = sqlite3_column_int64(stmt, col);
+    ++col;
+    if (!columnIsNull(stmt, col)) socket.keepalive_interval_sec = sqlite3_column_int64(stmt, col);
+    ++col;
+    if (!columnIsNull(stmt, col)) socket.keepalive_count = sqlite3_column_int64(stmt, col);
+    ++col;
+
+    if (!columnIsNull(stmt, col)) config.frame_gap_chars = sqlite3_column_double(stmt, col);
+    ++col;
+    if (!columnIsNull(stmt, col)) config.frame_max_bytes = sqlite3_column_int64(stmt, col);
+    ++col;
+    if (!columnIsNull(stmt, col)) config.frame_delimiter = sqlite3_column_int(stmt, col);
+    ++col;
+
+    if (!columnIsNull(stmt, col)) config.serial_data_bits = sqlite3_column_int64(stmt, col);
+    ++col;
+    if (!columnIsNull(stmt, col)) config.serial_parity = columnText(stmt, col);
+    ++col;
+    if (!columnIsNull(stmt, col)) config.serial_stop_bits = sqlite3_column_int64(stmt, col);
+    ++col;
+    if (!columnIsNull(stmt, col)) config.serial_rtscts = sqlite3_column_int(stmt, col) != 0;
+    ++col;
+    if (!columnIsNull(stmt, col)) config.serial_low_latency = sqlite3_column_int(stmt, col) != 0;
+}
+
 void Database::saveChannels(const std::vector<ChannelConfig>& channels) {
     // 移除了事务开始和提交/回滚的代码
     // 准备插入通道的语句
     sqlite3_stmt* channelStmt;
-    const char* channelSql = "INSERT INTO channels (name) VALUES (?);";
+    const char* channelSql = R"(
+        INSERT INTO channels (name, flow_control, high_watermark, low_watermark,
+                              coalesce_mode, coalesce_bytes, coalesce_usec,
+                              capture_dir, capture_segment_bytes, capture_segments)
+        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?);
+    )";
     if (sqlite3_prepare_v2(db_, channelSql, -1, &channelStmt, nullptr) != SQLITE_OK) {
         throw std::runtime_error(sqlite3_errmsg(db_));
     }
     
     // 准备插入端点的语句
     sqlite3_stmt* endpointStmt;
-    const char* endpointSql = R"(
-        INSERT INTO endpoints 
-        (channel_id, role, type, port, ip, serial_port, baud_rate)
-        VALUES (?, ?, ?, ?, ?, ?, ?);
-    )";
-    if (sqlite3_prepare_v2(db_, endpointSql, -1, &endpointStmt, nullptr) != SQLITE_OK) {
+    const std::string endpointSql = endpointInsertSql();
+    if (sqlite3_prepare_v2(db_, endpointSql.c_str(), -1, &endpointStmt, nullptr) != SQLITE_OK) {
         sqlite3_finalize(channelStmt);
         throw std::runtime_error(sqlite3_errmsg(db_));
     }
@@ -123,6 +370,35 @@ void Database::saveChannels(const std::vector<ChannelConfig>& channels) {
     for (const auto& channel : channels) {
         // 插入通道
         sqlite3_bind_text(channelStmt, 1, channel.name.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(channelStmt, 2, channel.flow_control ? 1 : 0);
+        if (channel.high_watermark > 0) {
+            sqlite3_bind_int64(channelStmt, 3, channel.high_watermark);
+        } else {
+            sqlite3_bind_null(channelStmt, 3);
+        }
+        if (channel.low_watermark > 0) {
+            sqlite3_bind_int64(channelStmt, 4, channel.low_watermark);
+        } else {
+            sqlite3_bind_null(channelStmt, 4);
+        }
+        sqlite3_bind_text(channelStmt, 5, channel.coalesce_mode.c_str(), -1, SQLITE_TRANSIENT);
+        if (channel.coalesce_bytes > 0) {
+            sqlite3_bind_int64(channelStmt, 6, channel.coalesce_bytes);
+        } else {
+            sqlite3_bind_null(channelStmt, 6);
+        }
+        if (channel.coalesce_usec > 0) {
+            sqlite3_bind_int64(channelStmt, 7, channel.coalesce_usec);
+        } else {
+            sqlite3_bind_null(channelStmt, 7);
+        }
+        if (!channel.capture_dir.empty()) {
+            sqlite3_bind_text(channelStmt, 8, channel.capture_dir.c_str(), -1, SQLITE_TRANSIENT);
+        } else {
+            sqlite3_bind_null(channelStmt, 8);
+        }
+        bindOptional(channelStmt, 9, channel.capture_segment_bytes);
+        bindOptional(channelStmt, 10, channel.capture_segments);
         if (sqlite3_step(channelStmt) != SQLITE_DONE) {
             throw std::runtime_error("Failed to insert channel: " + channel.name);
         }
@@ -173,6 +449,141 @@ void Database::insertEndpoint(sqlite3_stmt* stmt, sqlite3_int64 channelId,
     } else {
         sqlite3_bind_null(stmt, 7);
     }
+
+    // 绑定TCP服务端发送队列配置
+    if (config.send_queue_bytes > 0) {
+        sqlite3_bind_int64(stmt, 8, config.send_queue_bytes);
+    } else {
+        sqlite3_bind_null(stmt, 8);
+    }
+    if (!config.slow_client_policy.empty()) {
+        sqlite3_bind_text(stmt, 9, config.slow_client_policy.c_str(), -1, SQLITE_TRANSIENT);
+    } else {
+        sqlite3_bind_null(stmt, 9);
+    }
+
+    // 绑定UDP批量接收配置
+    if (config.recv_batch > 0) {
+        sqlite3_bind_int64(stmt, 10, config.recv_batch);
+    } else {
+        sqlite3_bind_null(stmt, 10);
+    }
+    if (config.recv_slot_bytes > 0) {
+        sqlite3_bind_int64(stmt, 11, config.recv_slot_bytes);
+    } else {
+        sqlite3_bind_null(stmt, 11);
+    }
+
+    // 绑定UDP服务端客户端过期时间
+    if (config.peer_expiry_sec > 0) {
+        sqlite3_bind_int64(stmt, 12, config.peer_expiry_sec);
+    } else {
+        sqlite3_bind_null(stmt, 12);
+    }
+
+    // 绑定TCP客户端重连退避配置
+    if (config.reconnect_min_ms > 0) {
+        sqlite3_bind_int64(stmt, 13, config.reconnect_min_ms);
+    } else {
+        sqlite3_bind_null(stmt, 13);
+    }
+    if (config.reconnect_max_ms > 0) {
+        sqlite3_bind_int64(stmt, 14, config.reconnect_max_ms);
+    } else {
+        sqlite3_bind_null(stmt, 14);
+    }
+
+    // 绑定TCP服务端监听配置
+    if (config.accept_shards > 0) {
+        sqlite3_bind_int64(stmt, 15, config.accept_shards);
+    } else {
+        sqlite3_bind_null(stmt, 15);
+    }
+    if (config.listen_backlog > 0) {
+        sqlite3_bind_int64(stmt, 16, config.listen_backlog);
+    } else {
+        sqlite3_bind_null(stmt, 16);
+    }
+
+    // 绑定共享内存端点配置
+    if (!config.shm_name.empty()) {
+        sqlite3_bind_text(stmt, 17, config.shm_name.c_str(), -1, SQLITE_TRANSIENT);
+    } else {
+        sqlite3_bind_null(stmt, 17);
+    }
+    if (config.shm_capacity > 0) {
+        sqlite3_bind_int64(stmt, 18, config.shm_capacity);
+    } else {
+        sqlite3_bind_null(stmt, 18);
+    }
+
+    // 绑定Unix域socket端点配置
+    if (!config.unix_path.empty()) {
+        sqlite3_bind_text(stmt, 19, config.unix_path.c_str(), -1, SQLITE_TRANSIENT);
+    } else {
+        sqlite3_bind_null(stmt, 19);
+    }
+    if (!config.unix_mode.empty()) {
+        sqlite3_bind_text(stmt, 20, config.unix_mode.c_str(), -1, SQLITE_TRANSIENT);
+    } else {
+        sqlite3_bind_null(stmt, 20);
+    }
+
+    // 绑定UDP组播端点配置
+    if (!config.multicast_interface.empty()) {
+        sqlite3_bind_text(stmt, 21, config.multicast_interface.c_str(), -1, SQLITE_TRANSIENT);
+    } else {
+        sqlite3_bind_null(stmt, 21);
+    }
+    if (config.multicast_ttl > 0) {
+        sqlite3_bind_int64(stmt, 22, config.multicast_ttl);
+    } else {
+        sqlite3_bind_null(stmt, 22);
+    }
+    if (config.multicast_loopback) {
+        sqlite3_bind_int(stmt, 23, 1);
+    } else {
+        sqlite3_bind_null(stmt, 23);
+    }
+
+    // 绑定套接字调优参数
+    const SocketOptions& socket = config.socket;
+    bindOptional(stmt, 24, socket.rcvbuf);
+    bindOptional(stmt, 25, socket.sndbuf);
+    bindOptional(stmt, 26, socket.tcp_nodelay ? 1 : 0);
+    bindOptional(stmt, 27, socket.tcp_quickack ? 1 : 0);
+    bindOptional(stmt, 28, socket.busy_poll_usec);
+    bindOptional(stmt, 29, socket.priority);
+    bindOptional(stmt, 30, socket.tcp_user_timeout_ms);
+    bindOptional(stmt, 31, socket.ip_tos);
+    bindOptional(stmt, 32, socket.keepalive ? 1 : 0);
+    bindOptional(stmt, 33, socket.keepalive_idle_sec);
+    bindOptional(stmt, 34, socket.keepalive_interval_sec);
+    bindOptional(stmt, 35, socket.keepalive_count);
+
+    // 绑定串口分帧参数（分隔符 0 是有效值，-1 才表示未设置）
+    if (config.frame_gap_chars > 0) {
+        sqlite3_bind_double(stmt, 36, config.frame_gap_chars);
+    } else {
+        sqlite3_bind_null(stmt, 36);
+    }
+    bindOptional(stmt, 37, config.frame_max_bytes);
+    if (config.frame_delimiter >= 0) {
+        sqlite3_bind_int(stmt, 38, config.frame_delimiter);
+    } else {
+        sqlite3_bind_null(stmt, 38);
+    }
+
+    // 绑定串口线路参数
+    bindOptional(stmt, 39, config.serial_data_bits);
+    if (!config.serial_parity.empty()) {
+        sqlite3_bind_text(stmt, 40, config.serial_parity.c_str(), -1, SQLITE_TRANSIENT);
+    } else {
+        sqlite3_bind_null(stmt, 40);
+    }
+    bindOptional(stmt, 41, config.serial_stop_bits);
+    bindOptional(stmt, 42, config.serial_rtscts ? 1 : 0);
+    bindOptional(stmt, 43, config.serial_low_latency ? 1 : 0);
     
     if (sqlite3_step(stmt) != SQLITE_DONE) {
         throw std::runtime_error("Failed to insert endpoint: " + config.type);
@@ -23,6 +23,8 @@ private:
     
     void initDatabase();
     void executeSQL(const std::string& sql);
+    void ensureColumn(const std::string& table, const std::string& column, const std::string& definition);
+    static void readEndpoint(sqlite3_stmt* stmt, int firstColumn, EndpointConfig& config);
     void insertEndpoint(sqlite3_stmt* stmt, sqlite3_int64 channelId, 
                        const std::string& role, const EndpointConfig& config);
 };
\ No newline at end of file
@@ -1,10 +1,13 @@
 #include "endpoint.h"
 #include <iostream>
+#include <vector>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 
 Endpoint::Endpoint() = default;
 
 Endpoint::~Endpoint() {
-    stopThread();
+    detachLoop();
 }
 
 void Endpoint::setDataCallback(DataCallback cb) {
@@ -19,6 +22,144 @@ void Endpoint::setErrorCallback(ErrorCallback cb) {
     _errorCallback = std::move(cb);
 }
 
+void Endpoint::setSpliceCallback(SpliceCallback cb) {
+    _spliceCallback = std::move(cb);
+}
+
+void Endpoint::setBatchCallback(BatchCallback cb) {
+    _batchCallback = std::move(cb);
+}
+
+void Endpoint::setSocketOptions(const SocketOptions& options) {
+    _socketOptions = options;
+}
+
+void Endpoint::tuneSocket(int fd) {
+    const std::string errors = applySocketOptions(fd, _socketOptions);
+    if (!errors.empty()) {
+        logMessage("Socket tuning not fully applied: " + errors);
+    }
+}
+
+void Endpoint::rearmQuickAck(int fd) {
+    if (!_socketOptions.tcp_quickack) return;
+    int opt = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_QUICKACK, &opt, sizeof(opt));
+}
+
+ssize_t Endpoint::spliceFrom(int pipeFd, size_t len) {
+    (void)pipeFd;
+    (void)len;
+    errno = ENOTSUP;
+    return -1;
+}
+
+size_t Endpoint::writev(const iovec* iov, int iovcnt) {
+    if (iovcnt == 1) {
+        write(static_cast<const uint8_t*>(iov[0].iov_base), iov[0].iov_len);
+        return iov[0].iov_len;
+    }
+
+    std::vector<uint8_t> joined;
+    for (int i = 0; i < iovcnt; ++i) {
+        const auto* base = static_cast<const uint8_t*>(iov[i].iov_base);
+        joined.insert(joined.end(), base, base + iov[i].iov_len);
+    }
+    write(joined.data(), joined.size());
+    return joined.size();
+}
+
+size_t Endpoint::writeDatagrams(mmsghdr* msgs, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        const msghdr& hdr = msgs[i].msg_hdr;
+        const int iovcnt = static_cast<int>(hdr.msg_iovlen);
+        if (writev(hdr.msg_iov, iovcnt) < totalLength(hdr.msg_iov, iovcnt)) {
+            return i;
+        }
+    }
+    return count;
+}
+
+size_t Endpoint::totalLength(const iovec* iov, int iovcnt) {
+    size_t total = 0;
+    for (int i = 0; i < iovcnt; ++i) {
+        total += iov[i].iov_len;
+    }
+    return total;
+}
+
+void Endpoint::notifyWhenWritable(std::function<void()> cb) {
+    runInLoop([this, cb = std::move(cb)]() mutable {
+        const int fd = outputFd();
+        {
+            std::lock_guard<std::mutex> lock(_fdMutex);
+            auto it = _fds.find(fd);
+            if (fd >= 0 && it != _fds.end()) {
+                _writableFd = fd;
+                _writableCallback = std::move(cb);
+                _loop->modify(fd, effectiveEvents(it->second) | EPOLLOUT);
+                return;
+            }
+        }
+        // 无可等待的fd（如连接已断开），立即回调让调用方继续处理
+        cb();
+    });
+}
+
+void Endpoint::pauseReading() {
+    runInLoop([this] { applyReadPaused(true); });
+}
+
+void Endpoint::resumeReading() {
+    runInLoop([this] { applyReadPaused(false); });
+}
+
+void Endpoint::applyReadPaused(bool paused) {
+    std::lock_guard<std::mutex> lock(_fdMutex);
+    if (_readPaused == paused) return;
+
+    _readPaused = paused;
+    for (const auto& entry : _fds) {
+        if (entry.second.pausable) {
+            const uint32_t waitOut = (entry.first == _writableFd) ? static_cast<uint32_t>(EPOLLOUT) : 0u;
+            _loop->modify(entry.first, effectiveEvents(entry.second) | waitOut);
+        }
+    }
+}
+
+uint32_t Endpoint::effectiveEvents(const FdEntry& entry) const {
+    if (_readPaused && entry.pausable) {
+        return entry.events & ~static_cast<uint32_t>(EPOLLIN);
+    }
+    return entry.events;
+}
+
+void Endpoint::dispatchEvent(int fd, uint32_t events) {
+    std::function<void()> cb;
+    if ((events & EPOLLOUT) && fd == _writableFd) {
+        bool subscribed = false;
+        {
+            std::lock_guard<std::mutex> lock(_fdMutex);
+            auto it = _fds.find(fd);
+            if (it != _fds.end()) {
+                subscribed = (it->second.events & EPOLLOUT) != 0;
+                _loop->modify(fd, effectiveEvents(it->second));
+            }
+            _writableFd = -1;
+            cb = std::move(_writableCallback);
+            _writableCallback = nullptr;
+        }
+
+        // 子类未订阅EPOLLOUT时不再转发该事件
+        if (!subscribed) {
+            events &= ~static_cast<uint32_t>(EPOLLOUT);
+        }
+    }
+    // 先由子类处理（如续写发送队列），再通知等待可写的一方
+    if (events != 0) handleEvent(fd, events);
+    if (cb) cb();
+}
+
 bool Endpoint::isRunning() const {
     return _running;
 }
@@ -27,28 +168,98 @@ bool Endpoint::isConnected() const {
     return _state == State::CONNECTED;
 }
 
-void Endpoint::startThread() {
+void Endpoint::attachLoop() {
     if (_running) return;
-    
+
+    _loop = Reactor::getInstance().nextLoop();
+    _alive = std::make_shared<std::atomic<bool>>(true);
     _running = true;
-    _worker = std::thread([this] {
-        run();
-    });
 }
 
-void Endpoint::stopThread() {
+void Endpoint::detachLoop() {
     if (!_running) return;
-    
+
     _running = false;
-    notifyThread();
-    
-    if (_worker.joinable()) {
-        _worker.join();
+    _loop->runSync([this] {
+        std::lock_guard<std::mutex> lock(_fdMutex);
+        for (const auto& entry : _fds) {
+            _loop->remove(entry.first);
+        }
+        _fds.clear();
+        _readPaused = false;
+        _writableFd = -1;
+        _writableCallback = nullptr;
+        _alive->store(false);
+    });
+}
+
+bool Endpoint::addFd(int fd, uint32_t events, bool pausable) {
+    std::lock_guard<std::mutex> lock(_fdMutex);
+    FdEntry entry{events, pausable};
+    if (!_loop->add(fd, effectiveEvents(entry), [this, fd](uint32_t ev) { dispatchEvent(fd, ev); })) {
+        return false;
     }
+    _fds[fd] = entry;
+    return true;
+}
+
+bool Endpoint::modifyFd(int fd, uint32_t events) {
+    std::lock_guard<std::mutex> lock(_fdMutex);
+    auto it = _fds.find(fd);
+    if (it == _fds.end()) return false;
+
+    FdEntry entry{events, it->second.pausable};
+    const uint32_t waitOut = (fd == _writableFd) ? static_cast<uint32_t>(EPOLLOUT) : 0u;
+    if (!_loop->modify(fd, effectiveEvents(entry) | waitOut)) {
+        return false;
+    }
+    it->second = entry;
+    return true;
+}
+
+void Endpoint::removeFd(int fd) {
+    std::function<void()> cb;
+    {
+        std::lock_guard<std::mutex> lock(_fdMutex);
+        if (_fds.erase(fd) > 0) {
+            _loop->remove(fd);
+        }
+        if (fd == _writableFd) {
+            // 等待可写的fd被移除（连接断开），唤醒等待方
+            _writableFd = -1;
+            cb = std::move(_writableCallback);
+            _writableCallback = nullptr;
+        }
+    }
+    if (cb) cb();
+}
+
+void Endpoint::runInLoop(std::function<void()> task) {
+    if (!_running) return;
+
+    auto alive = _alive;
+    _loop->runInLoop([alive, task = std::move(task)] {
+        if (alive->load()) {
+            task();
+        }
+    });
+}
+
+EventLoop::TimerId Endpoint::runAfter(uint64_t delayMs, std::function<void()> task) {
+    if (!_running) return 0;
+
+    auto alive = _alive;
+    return _loop->runAfter(delayMs, [alive, task = std::move(task)] {
+        if (alive->load()) {
+            task();
+        }
+    });
 }
 
-void Endpoint::notifyThread() {
-    _cv.notify_one();
+void Endpoint::cancelTimer(EventLoop::TimerId id) {
+    if (_running && id != 0) {
+        _loop->cancelTimer(id);
+    }
 }
 
 void Endpoint::setState(State newState) {
@@ -76,8 +287,36 @@ void Endpoint::logError(const std::string& error) {
     setState(State::ERROR);
 }
 
+void Endpoint::logWriteError(const std::string& error) {
+    _writeErrors.add();
+    logError(error);
+}
+
+// 单条消息过大等可恢复的情况：端点仍可正常收发，不能像 logError 那样置为 ERROR
+void Endpoint::logReceiveDrop(const std::string& msg, uint64_t count) {
+    _receiveDrops.add(count);
+    logMessage(msg);
+}
+
 void Endpoint::processData(const uint8_t* data, size_t len) {
     if (_dataCallback) {
         _dataCallback(data, len);
     }
+}
+
+void Endpoint::processBatch(const iovec* msgs, size_t count) {
+    if (_batchCallback) {
+        _batchCallback(msgs, count);
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        processData(static_cast<const uint8_t*>(msgs[i].iov_base), msgs[i].iov_len);
+    }
+}
+
+Endpoint::SpliceResult Endpoint::trySplice(int fd) {
+    if (_spliceCallback) {
+        return _spliceCallback(fd);
+    }
+    return SpliceResult::NotHandled;
 }
\ No newline at end of file
@@ -2,11 +2,16 @@
 #include <cstdint>
 #include <string>
 #include <functional>
-#include <thread>
 #include <atomic>
 #include <mutex>
-#include <condition_variable>
+#include <memory>
+#include <unordered_map>
+#include <sys/uio.h>
+#include <sys/socket.h>
+#include "event_loop.h"
 #include "logrecord.h"
+#include "metrics.h"
+#include "socket_options.h"
 class Endpoint {
 public:
     // 回调函数类型定义
@@ -14,6 +19,12 @@ public:
     using LogCallback = std::function<void(const std::string& msg)>;
     using ErrorCallback = std::function<void(const std::string& error)>;
 
+    // 零拷贝转发（splice）：源端点的socket可读时先交给该回调处理
+    enum class SpliceResult { NotHandled, Handled, Closed };
+    using SpliceCallback = std::function<SpliceResult(int fd)>;
+    // 批量数据回调：一次交付多个数据报（UDP端点批量接收时使用）
+    using BatchCallback = std::function<void(const iovec* msgs, size_t count)>;
+
     Endpoint();
     virtual ~Endpoint();
     
@@ -21,23 +32,81 @@ public:
     virtual bool open() = 0;
     virtual void close() = 0;
     virtual void write(const uint8_t* data, size_t len) = 0;
+    // 聚集写：一次发送多段数据（默认实现拼接后调用 write）
+    // 返回已被接受（发送或丢弃）的字节数；小于总长度表示输出暂时阻塞，剩余数据应稍后重试
+    virtual size_t writev(const iovec* iov, int iovcnt);
+
+    // 数据报端点（UDP）：通道转发时保持消息边界
+    virtual bool isDatagram() const { return false; }
+    // 批量写数据报：每个 mmsghdr 发送为一个数据报（msg_name 由端点填写）
+    // 返回已被接受（发送或丢弃）的消息数；小于 count 表示输出暂时阻塞
+    virtual size_t writeDatagrams(mmsghdr* msgs, size_t count);
+
+    // 输出合并：corked 期间不发出未满的报文段，取消时立即发出积压数据（TCP端点使用TCP_CORK）
+    virtual void setCorked(bool corked) { (void)corked; }
+
+    // splice 支持（TCP端点）：作为源时通过 setSpliceCallback 接管读取，作为目标时由 spliceFrom 写出
+    virtual bool supportsSplice() const { return false; }
+    // 当前是否有唯一的输出连接可作为 splice 目标
+    virtual bool canSpliceTo() { return false; }
+    // 从管道向输出连接写入最多 len 字节，返回写入字节数
+    // 失败返回-1：errno=EAGAIN 表示输出暂时阻塞，其他表示当前不可写（数据应丢弃）
+    virtual ssize_t spliceFrom(int pipeFd, size_t len);
+
+    // 输出阻塞后等待可写：输出fd可写（或连接断开）时在事件循环线程中回调一次
+    virtual void notifyWhenWritable(std::function<void()> cb);
+
+    // 流控：暂停/恢复从数据fd读取（移除/恢复EPOLLIN，由内核缓冲区向发送方施加反压）
+    virtual void pauseReading();
+    virtual void resumeReading();
     
     // 回调设置
     void setDataCallback(DataCallback cb);
     void setLogCallback(LogCallback cb);
     void setErrorCallback(ErrorCallback cb);
+    void setSpliceCallback(SpliceCallback cb);
+    void setBatchCallback(BatchCallback cb);
+    // 套接字调优参数，需在 open() 之前设置（无socket的端点忽略）
+    void setSocketOptions(const SocketOptions& options);
 
     bool isRunning() const;
     bool isConnected() const;
 
+    // 运行指标
+    virtual uint64_t writeErrors() const { return _writeErrors.value(); }
+    uint64_t reconnects() const { return _reconnects.value(); }
+    uint64_t receiveDrops() const { return _receiveDrops.value(); }
+
 protected:
     enum class State { DISCONNECTED, CONNECTING, CONNECTED, ERROR };
 
-    // 线程控制
-    virtual void run() = 0;
-    void startThread();
-    void stopThread();
-    void notifyThread();
+    // 事件处理（由绑定的事件循环线程调用）
+    virtual void handleEvent(int fd, uint32_t events) = 0;
+
+    // 事件循环绑定：open() 时绑定到 Reactor 中的一个事件循环，close() 时解绑
+    void attachLoop();
+    void detachLoop();   // 在事件循环线程中注销全部fd，返回后不会再有回调执行
+
+    // fd 注册管理（pausable=false 的fd如监听socket、定时器不受流控影响）
+    bool addFd(int fd, uint32_t events, bool pausable = true);
+    bool modifyFd(int fd, uint32_t events);
+    void removeFd(int fd);
+
+    // 当前用于输出的fd（不可写时返回-1），供 notifyWhenWritable 使用
+    virtual int outputFd() const { return -1; }
+
+    static size_t totalLength(const iovec* iov, int iovcnt);
+
+    // 在新创建的socket上应用调优参数；未生效的选项只记录日志，不影响端点打开
+    void tuneSocket(int fd);
+    // TCP_QUICKACK 不是持久设置（内核会退回延迟确认），配置了该选项时每次读取后重新设置
+    void rearmQuickAck(int fd);
+
+    // 投递任务到事件循环线程（端点关闭后未执行的任务会被丢弃）
+    void runInLoop(std::function<void()> task);
+    // 定时任务（仅在事件循环线程调用，端点关闭后到期的任务会被丢弃），返回0表示端点未运行
+    EventLoop::TimerId runAfter(uint64_t delayMs, std::function<void()> task);
+    void cancelTimer(EventLoop::TimerId id);
 
     // 状态管理
     void setState(State newState);
@@ -46,17 +115,45 @@ protected:
     // 回调函数
     void logMessage(const std::string& msg);
     void logError(const std::string& error);
+    void logWriteError(const std::string& error);   // 记录错误并计入写失败次数
+    void logReceiveDrop(const std::string& msg, uint64_t count);   // 记录丢弃的接收消息并计数，不改变端点状态
     void processData(const uint8_t* data, size_t len);
+    void processBatch(const iovec* msgs, size_t count);   // 未设置批量回调时逐条交给数据回调
+    SpliceResult trySplice(int fd);
 
     // 同步工具
     std::atomic<State> _state{State::DISCONNECTED};
     std::atomic<bool> _running{false};
-    std::thread _worker;
     std::mutex _mutex;
-    std::condition_variable _cv;
+
+    // 事件循环
+    EventLoop* _loop = nullptr;
+    std::shared_ptr<std::atomic<bool>> _alive;   // 投递任务的存活标记
+    struct FdEntry {
+        uint32_t events;   // 期望的事件掩码
+        bool pausable;
+    };
+    uint32_t effectiveEvents(const FdEntry& entry) const;
+    void applyReadPaused(bool paused);
+    void dispatchEvent(int fd, uint32_t events);
+
+    std::mutex _fdMutex;
+    std::unordered_map<int, FdEntry> _fds;       // 已注册fd -> 事件掩码
+    bool _readPaused = false;
+    int _writableFd = -1;                        // 等待可写的fd
+    std::function<void()> _writableCallback;
+
+    // 运行指标
+    Counter _writeErrors;
+    Counter _reconnects;
+    Counter _receiveDrops;                       // 超过接收上限而丢弃的消息数
 
     // 回调函数对象
     DataCallback _dataCallback;
     LogCallback _logCallback;
     ErrorCallback _errorCallback;
+    SpliceCallback _spliceCallback;
+    BatchCallback _batchCallback;
+
+    SocketOptions _socketOptions;
 };
\ No newline at end of file
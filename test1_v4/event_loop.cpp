@@ -0,0 +1,289 @@
+// event_loop.cpp
+#include "event_loop.h"
+#include "logrecord.h"
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <cstring>
+#include <future>
+#include <algorithm>
+#include <stdexcept>
+
+// epoll_event.data.u64 = (代数 << 32) | fd，用于识别 fd 被关闭后复用产生的过期事件
+static uint64_t makeKey(int fd, uint32_t gen) {
+    return (static_cast<uint64_t>(gen) << 32) | static_cast<uint32_t>(fd);
+}
+
+// 定时器刻度：CLOCK_MONOTONIC 毫秒数
+static uint64_t monotonicMs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000 + static_cast<uint64_t>(ts.tv_nsec) / 1000000;
+}
+
+EventLoop::EventLoop() : _timers(monotonicMs()) {
+    _epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (_epollFd < 0) {
+        throw std::runtime_error("Epoll creation failed: " + std::string(strerror(errno)));
+    }
+
+    _wakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_wakeupFd < 0) {
+        ::close(_epollFd);
+        throw std::runtime_error("Eventfd creation failed: " + std::string(strerror(errno)));
+    }
+
+    _timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (_timerFd < 0) {
+        ::close(_wakeupFd);
+        ::close(_epollFd);
+        throw std::runtime_error("Timerfd creation failed: " + std::string(strerror(errno)));
+    }
+
+    // 内部fd使用代数0，与外部注册的fd区分
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = makeKey(_wakeupFd, 0);
+    epoll_ctl(_epollFd, EPOLL_CTL_ADD, _wakeupFd, &event);
+    event.data.u64 = makeKey(_timerFd, 0);
+    epoll_ctl(_epollFd, EPOLL_CTL_ADD, _timerFd, &event);
+}
+
+EventLoop::~EventLoop() {
+    stop();
+    ::close(_timerFd);
+    ::close(_wakeupFd);
+    ::close(_epollFd);
+}
+
+void EventLoop::start() {
+    if (_running) return;
+
+    _running = true;
+    _thread = std::thread([this] {
+        loop();
+    });
+}
+
+void EventLoop::stop() {
+    if (!_running) return;
+
+    _running = false;
+    wakeup();
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+bool EventLoop::add(int fd, uint32_t events, EventCallback cb) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto handler = std::make_shared<Handler>(Handler{_nextGen++, std::move(cb)});
+    if (_nextGen == 0) _nextGen = 1;
+
+    epoll_event event{};
+    event.events = events;
+    event.data.u64 = makeKey(fd, handler->gen);
+    if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+        return false;
+    }
+
+    _handlers[fd] = std::move(handler);
+    return true;
+}
+
+bool EventLoop::modify(int fd, uint32_t events) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _handlers.find(fd);
+    if (it == _handlers.end()) return false;
+
+    epoll_event event{};
+    event.events = events;
+    event.data.u64 = makeKey(fd, it->second->gen);
+    return epoll_ctl(_epollFd, EPOLL_CTL_MOD, fd, &event) == 0;
+}
+
+void EventLoop::remove(int fd) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _handlers.find(fd);
+    if (it == _handlers.end()) return;
+
+    epoll_ctl(_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    _handlers.erase(it);
+}
+
+void EventLoop::queueInLoop(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _pendingTasks.push_back(std::move(task));
+    }
+    wakeup();
+}
+
+void EventLoop::runInLoop(Task task) {
+    if (isInLoopThread()) {
+        task();
+    } else {
+        queueInLoop(std::move(task));
+    }
+}
+
+void EventLoop::runSync(const Task& task) {
+    if (isInLoopThread() || !_running) {
+        task();
+        return;
+    }
+
+    std::promise<void> done;
+    auto future = done.get_future();
+    queueInLoop([&task, &done] {
+        task();
+        done.set_value();
+    });
+    future.wait();
+}
+
+bool EventLoop::isInLoopThread() const {
+    return _threadId.load() == std::this_thread::get_id();
+}
+
+EventLoop::TimerId EventLoop::runAfter(uint64_t delayMs, Task task) {
+    const uint64_t now = monotonicMs();
+    if (_timers.size() == 0) {
+        _timers.advance(now);   // 空闲期间时间轮未推进，先对齐当前时间（没有待执行任务）
+    }
+    _timersChanged = true;
+    return _timers.add(now + delayMs, std::move(task));
+}
+
+void EventLoop::cancelTimer(TimerId id) {
+    if (_timers.cancel(id)) {
+        _timersChanged = true;
+    }
+}
+
+void EventLoop::handleTimers() {
+    uint64_t expirations;
+    ssize_t n = ::read(_timerFd, &expirations, sizeof(expirations));
+    (void)n;
+
+    _armedTick = 0;
+    _timersChanged = true;
+    _timers.advance(monotonicMs());
+}
+
+// 按时间轮的下一个刻度设置timerfd（绝对时间），刻度未变化时不发起系统调用
+void EventLoop::rearmTimer() {
+    if (!_timersChanged) return;
+    _timersChanged = false;
+
+    const uint64_t next = _timers.nextTick();
+    if (next == _armedTick) return;
+
+    itimerspec spec{};
+    if (next != 0) {
+        spec.it_value.tv_sec = static_cast<time_t>(next / 1000);
+        spec.it_value.tv_nsec = static_cast<long>((next % 1000) * 1000000);
+    }
+    if (timerfd_settime(_timerFd, TFD_TIMER_ABSTIME, &spec, nullptr) < 0) {
+        LOG_ERROR("Timerfd settime failed: %s", strerror(errno));
+        return;
+    }
+    _armedTick = next;
+}
+
+void EventLoop::wakeup() {
+    uint64_t one = 1;
+    ssize_t n = ::write(_wakeupFd, &one, sizeof(one));
+    (void)n;
+}
+
+void EventLoop::drainWakeup() {
+    uint64_t value;
+    ssize_t n = ::read(_wakeupFd, &value, sizeof(value));
+    (void)n;
+}
+
+void EventLoop::runPendingTasks() {
+    std::vector<Task> tasks;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        tasks.swap(_pendingTasks);
+    }
+    for (auto& task : tasks) {
+        task();
+    }
+}
+
+void EventLoop::loop() {
+    _threadId = std::this_thread::get_id();
+
+    constexpr int MAX_EVENTS = 64;
+    epoll_event events[MAX_EVENTS];
+
+    while (_running) {
+        int numEvents = epoll_wait(_epollFd, events, MAX_EVENTS, -1);
+        if (numEvents < 0) {
+            if (errno != EINTR) {
+                LOG_ERROR("Epoll_wait error: %s", strerror(errno));
+            }
+            continue;
+        }
+
+        for (int i = 0; i < numEvents; ++i) {
+            const int fd = static_cast<int>(events[i].data.u64 & 0xffffffffu);
+            const uint32_t gen = static_cast<uint32_t>(events[i].data.u64 >> 32);
+            if (fd == _wakeupFd && gen == 0) {
+                drainWakeup();
+                continue;
+            }
+            if (fd == _timerFd && gen == 0) {
+                handleTimers();
+                continue;
+            }
+
+            // 拷贝一份处理器，回调内部移除自身也是安全的
+            std::shared_ptr<Handler> handler;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                auto it = _handlers.find(fd);
+                if (it != _handlers.end() && it->second->gen == gen) {
+                    handler = it->second;
+                }
+            }
+            if (handler) {
+                handler->cb(events[i].events);
+            }
+        }
+
+        runPendingTasks();
+        rearmTimer();
+    }
+
+    runPendingTasks();
+    _threadId = std::thread::id();
+}
+
+Reactor::Reactor(size_t numLoops) {
+    if (numLoops == 0) {
+        numLoops = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i < numLoops; ++i) {
+        _loops.push_back(std::make_unique<EventLoop>());
+        _loops.back()->start();
+    }
+}
+
+Reactor::~Reactor() {
+    for (auto& loop : _loops) {
+        loop->stop();
+    }
+}
+
+EventLoop* Reactor::nextLoop() {
+    return _loops[_next.fetch_add(1, std::memory_order_relaxed) % _loops.size()].get();
+}
+
+EventLoop* Reactor::loopAt(size_t index) {
+    return _loops[index % _loops.size()].get();
+}
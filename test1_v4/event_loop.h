@@ -0,0 +1,105 @@
+// event_loop.h
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <unordered_map>
+#include <sys/epoll.h>
+#include "timer_wheel.h"
+
+// 单线程事件循环：一个epoll实例 + 一个eventfd用于跨线程唤醒 + 一个timerfd驱动定时器
+// 空闲时 epoll_wait 无限期阻塞，不再定时轮询
+class EventLoop {
+public:
+    using EventCallback = std::function<void(uint32_t events)>;
+    using Task = std::function<void()>;
+    using TimerId = TimerWheel::TimerId;
+
+    EventLoop();
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    void start();
+    void stop();
+
+    // fd 注册管理（任意线程可调用）
+    // 注意：从其他线程 remove 时回调可能仍在执行，需要同步时请配合 runSync 使用
+    bool add(int fd, uint32_t events, EventCallback cb);
+    bool modify(int fd, uint32_t events);
+    void remove(int fd);
+
+    // 任务投递
+    void queueInLoop(Task task);   // 投递到循环线程，稍后执行
+    void runInLoop(Task task);     // 已在循环线程则立即执行，否则投递
+    void runSync(const Task& task); // 在循环线程执行并等待完成
+
+    bool isInLoopThread() const;
+
+    // 定时器（毫秒精度，仅在循环线程调用）：循环内全部定时器共享一个时间轮和一个timerfd
+    TimerId runAfter(uint64_t delayMs, Task task);
+    void cancelTimer(TimerId id);
+
+private:
+    struct Handler {
+        uint32_t gen;
+        EventCallback cb;
+    };
+
+    void loop();
+    void wakeup();
+    void drainWakeup();
+    void runPendingTasks();
+    void handleTimers();
+    void rearmTimer();
+
+    int _epollFd = -1;
+    int _wakeupFd = -1;
+    int _timerFd = -1;
+    TimerWheel _timers;            // 仅在循环线程访问
+    uint64_t _armedTick = 0;       // timerfd 当前设定的到期刻度，0 表示未设定
+    bool _timersChanged = false;
+    std::thread _thread;
+    std::atomic<std::thread::id> _threadId{};
+    std::atomic<bool> _running{false};
+
+    // 保护 _handlers / _pendingTasks
+    std::mutex _mutex;
+    std::unordered_map<int, std::shared_ptr<Handler>> _handlers;
+    std::vector<Task> _pendingTasks;
+    uint32_t _nextGen = 1;
+};
+
+// 事件循环组：N 个事件循环线程（默认等于CPU核数），端点按轮询方式绑定到其中一个
+class Reactor {
+public:
+    static Reactor& getInstance() {
+        static Reactor instance(_configuredLoops);
+        return instance;
+    }
+
+    // 设置事件循环数量（需在首次使用前调用，0 表示CPU核数）
+    static void init(size_t numLoops) {
+        _configuredLoops = numLoops;
+    }
+
+    ~Reactor();
+
+    EventLoop* nextLoop();
+    EventLoop* loopAt(size_t index);
+    size_t size() const { return _loops.size(); }
+
+private:
+    explicit Reactor(size_t numLoops);
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+
+    static inline size_t _configuredLoops = 0;
+    std::vector<std::unique_ptr<EventLoop>> _loops;
+    std::atomic<size_t> _next{0};
+};
@@ -0,0 +1,108 @@
+// log_decode.cpp
+// 结构化日志解码工具：把 --structured-log 写入的结构化日志文件还原为文本日志
+//   <时间> [级别] [<通道>] 消息        （与 logs/<通道>.txt 中的行格式一致，全局日志没有通道标记）
+// 用法：log_decode [--channel <name>] <file.slog>...
+//   --channel 只输出指定通道的日志，"main" 表示全局日志
+#include "log_format.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+static const char* levelTag(uint8_t level) {
+    static const char* kTags[] = {"[DEBUG]", "[INFO ]", "[WARN ]", "[ERROR]"};
+    return level < sizeof(kTags) / sizeof(kTags[0]) ? kTags[level] : "[?????]";
+}
+
+static bool decodeFile(const std::string& path, const char* channelFilter) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Cannot open " << path << std::endl;
+        return false;
+    }
+    const std::vector<uint8_t> buf((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    std::vector<std::string> formats;
+    bool inSection = false;
+    size_t pos = 0;
+    while (pos + sizeof(LogBlockHeader) <= buf.size()) {
+        LogBlockHeader block;
+        std::memcpy(&block, &buf[pos], sizeof(block));
+        const uint8_t* body = &buf[pos + sizeof(block)];
+        const auto type = static_cast<LogBlockType>(block.type);
+        if (!inSection && type != LogBlockType::Section) {
+            std::cerr << path << ": not a structured log file" << std::endl;
+            return false;
+        }
+        if (block.length > buf.size() - pos - sizeof(block)) {
+            // 进程异常退出时最后一块可能不完整
+            std::cerr << path << ": truncated block at offset " << pos << std::endl;
+            return false;
+        }
+
+        if (type == LogBlockType::Section) {
+            uint32_t magic = 0;
+            if (block.length >= sizeof(magic)) std::memcpy(&magic, body, sizeof(magic));
+            if (magic != kStructuredLogMagic) {
+                std::cerr << path << ": not a structured log file" << std::endl;
+                return false;
+            }
+            formats.clear();
+            inSection = true;
+        } else if (type == LogBlockType::Format && block.length >= sizeof(uint32_t)) {
+            uint32_t id;
+            std::memcpy(&id, body, sizeof(id));
+            if (id >= formats.size()) formats.resize(id + 1);
+            formats[id].assign(reinterpret_cast<const char*>(body + sizeof(id)), block.length - sizeof(id));
+        } else if (type == LogBlockType::Record && block.length >= sizeof(LogRecordBody)) {
+            LogRecordBody record;
+            std::memcpy(&record, body, sizeof(record));
+            if (sizeof(record) + record.channelLen <= block.length) {
+                const std::string channel(reinterpret_cast<const char*>(body + sizeof(record)), record.channelLen);
+                const char* target = channel.empty() ? "main" : channel.c_str();
+                if (channelFilter == nullptr || strcmp(channelFilter, target) == 0) {
+                    const uint8_t* args = body + sizeof(record) + record.channelLen;
+                    const size_t argsLen = block.length - sizeof(record) - record.channelLen;
+                    const char* format = record.formatId < formats.size() ? formats[record.formatId].c_str()
+                                                                           : "(unknown log format)";
+
+                    std::string line = formatLogTime(static_cast<uint64_t>(record.timeNs));
+                    line += ' ';
+                    line += levelTag(record.level);
+                    line += ' ';
+                    if (!channel.empty()) line += "[" + channel + "] ";
+                    line += formatLogMessage(format, args, argsLen);
+                    line += '\n';
+                    std::cout.write(line.data(), static_cast<std::streamsize>(line.size()));
+                }
+            }
+        }
+        pos += sizeof(block) + block.length;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    const char* channel = nullptr;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--channel") == 0 && i + 1 < argc) {
+            channel = argv[++i];
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+    if (files.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--channel <name>] <file.slog>...\n";
+        return 1;
+    }
+
+    bool ok = true;
+    for (const auto& path : files) {
+        ok &= decodeFile(path, channel);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,314 @@
+// log_format.h
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <type_traits>
+
+// 延迟格式化日志：调用日志宏时只记录格式编号和原始参数，格式化推迟到后台线程或离线解码
+//
+// 参数编码 = 逐个参数的 类型标记(1字节) + 值（小端）
+//   整数 / 浮点数 / 指针：8 字节；字符串：4 字节长度 + 内容（不含结尾的 '\0'）
+//   编码空间不足时截断当前字符串并丢弃之后的参数，解码时缺少参数的转换说明原样输出
+//
+// 结构化日志文件（LogAsyncOptions::structuredFile，用 log_decode 还原为文本日志）：
+//   文件 = 若干块，块 = LogBlockHeader + 正文
+//   节块：magic + 版本，每次打开文件时写入；格式编号只在一节内有效
+//   格式块：编号 + 格式字符串，某编号第一次出现在本节时写在其记录之前
+//   记录块：LogRecordBody + 通道名 + 参数编码
+
+constexpr uint32_t kStructuredLogMagic = 0x474F4C53;    // "SLOG"
+constexpr uint32_t kStructuredLogVersion = 1;
+
+enum class LogBlockType : uint32_t {
+    Section = 1,
+    Format = 2,
+    Record = 3
+};
+
+struct LogBlockHeader {
+    uint32_t type;
+    uint32_t length;        // 正文长度（不含块头）
+};
+
+struct LogRecordBody {
+    int64_t timeNs;         // 记录时间（system_clock，纳秒）
+    uint32_t formatId;
+    uint16_t channelLen;
+    uint8_t level;          // LogLevel 的数值
+    uint8_t reserved;
+};
+
+enum class LogArgType : uint8_t {
+    Signed = 'i',
+    Unsigned = 'u',
+    Double = 'f',
+    Pointer = 'p',
+    String = 's'
+};
+
+// 调用线程：把参数依次编码到定长缓冲区
+class LogArgWriter {
+public:
+    LogArgWriter(uint8_t* buf, size_t capacity) : buf_(buf), capacity_(capacity) {}
+
+    size_t size() const { return size_; }
+
+    template <typename T>
+    void add(const T& value) {
+        using D = std::decay_t<T>;
+        if constexpr (std::is_array_v<T>) {
+            addString(value, strlen(value));
+        } else if constexpr (std::is_same_v<D, char*> || std::is_same_v<D, const char*>) {
+            if (value == nullptr) {
+                addString("(null)", 6);
+            } else {
+                addString(value, strlen(value));
+            }
+        } else if constexpr (std::is_same_v<D, std::string>) {
+            addString(value.data(), value.size());
+        } else if constexpr (std::is_floating_point_v<D>) {
+            addValue(LogArgType::Double, static_cast<double>(value));
+        } else if constexpr (std::is_pointer_v<D> || std::is_null_pointer_v<D>) {
+            addValue(LogArgType::Pointer, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value)));
+        } else if constexpr (std::is_enum_v<D>) {
+            add(static_cast<std::underlying_type_t<D>>(value));
+        } else {
+            static_assert(std::is_integral_v<D>, "unsupported log argument type");
+            if constexpr (std::is_signed_v<D>) {
+                addValue(LogArgType::Signed, static_cast<int64_t>(value));
+            } else {
+                addValue(LogArgType::Unsigned, static_cast<uint64_t>(value));
+            }
+        }
+    }
+
+private:
+    template <typename V>
+    void addValue(LogArgType type, V value) {
+        static_assert(sizeof(V) == 8, "log argument values are 8 bytes");
+        if (full_ || size_ + 1 + sizeof(value) > capacity_) {
+            full_ = true;
+            return;
+        }
+        buf_[size_] = static_cast<uint8_t>(type);
+        std::memcpy(buf_ + size_ + 1, &value, sizeof(value));
+        size_ += 1 + sizeof(value);
+    }
+
+    void addString(const char* data, size_t len) {
+        if (full_ || size_ + 1 + sizeof(uint32_t) > capacity_) {
+            full_ = true;
+            return;
+        }
+        const size_t room = capacity_ - size_ - 1 - sizeof(uint32_t);
+        if (len >= room) {
+            len = room;
+            full_ = true;
+        }
+        const uint32_t len32 = static_cast<uint32_t>(len);
+        buf_[size_] = static_cast<uint8_t>(LogArgType::String);
+        std::memcpy(buf_ + size_ + 1, &len32, sizeof(len32));
+        std::memcpy(buf_ + size_ + 1 + sizeof(len32), data, len);
+        size_ += 1 + sizeof(len32) + len;
+    }
+
+    uint8_t* buf_;
+    size_t capacity_;
+    size_t size_ = 0;
+    bool full_ = false;
+};
+
+// 编码全部参数，返回编码长度
+template <typename... Args>
+inline size_t packLogArgs(uint8_t* buf, size_t capacity, const Args&... args) {
+    LogArgWriter writer(buf, capacity);
+    (writer.add(args), ...);
+    return writer.size();
+}
+
+// 解码端：依次读取参数
+class LogArgReader {
+public:
+    struct Arg {
+        LogArgType type = LogArgType::Signed;
+        uint64_t bits = 0;              // 整数 / 指针的值，浮点数的位模式
+        const char* str = nullptr;
+        uint32_t len = 0;
+
+        int64_t asSigned() const {
+            return type == LogArgType::Double ? static_cast<int64_t>(asDouble()) : static_cast<int64_t>(bits);
+        }
+        uint64_t asUnsigned() const {
+            return type == LogArgType::Double ? static_cast<uint64_t>(asDouble()) : bits;
+        }
+        double asDouble() const {
+            if (type == LogArgType::Double) {
+                double v;
+                std::memcpy(&v, &bits, sizeof(v));
+                return v;
+            }
+            return type == LogArgType::Signed ? static_cast<double>(static_cast<int64_t>(bits))
+                                              : static_cast<double>(bits);
+        }
+    };
+
+    LogArgReader(const uint8_t* data, size_t len) : pos_(data), end_(data + len) {}
+
+    bool next(Arg& arg) {
+        if (pos_ >= end_) return false;
+        arg.type = static_cast<LogArgType>(*pos_);
+        if (arg.type == LogArgType::String) {
+            uint32_t len;
+            if (end_ - pos_ < 1 + static_cast<ptrdiff_t>(sizeof(len))) return fail();
+            std::memcpy(&len, pos_ + 1, sizeof(len));
+            if (static_cast<size_t>(end_ - pos_) - 1 - sizeof(len) < len) return fail();
+            arg.str = reinterpret_cast<const char*>(pos_ + 1 + sizeof(len));
+            arg.len = len;
+            pos_ += 1 + sizeof(len) + len;
+            return true;
+        }
+        if (end_ - pos_ < 1 + static_cast<ptrdiff_t>(sizeof(arg.bits))) return fail();
+        std::memcpy(&arg.bits, pos_ + 1, sizeof(arg.bits));
+        arg.str = nullptr;
+        arg.len = 0;
+        pos_ += 1 + sizeof(arg.bits);
+        return true;
+    }
+
+private:
+    bool fail() {
+        pos_ = end_;
+        return false;
+    }
+
+    const uint8_t* pos_;
+    const uint8_t* end_;
+};
+
+// 按一个转换说明格式化单个值；stars 为 '*' 指定的宽度 / 精度
+template <typename T>
+inline void appendLogConversion(std::string& out, const std::string& spec, const int* stars, int starCount,
+                                T value) {
+    auto print = [&](char* dst, size_t cap) {
+        switch (starCount) {
+            case 0:  return snprintf(dst, cap, spec.c_str(), value);
+            case 1:  return snprintf(dst, cap, spec.c_str(), stars[0], value);
+            default: return snprintf(dst, cap, spec.c_str(), stars[0], stars[1], value);
+        }
+    };
+    char buf[256];
+    const int n = print(buf, sizeof(buf));
+    if (n < 0) return;
+    if (static_cast<size_t>(n) < sizeof(buf)) {
+        out.append(buf, static_cast<size_t>(n));
+    } else {
+        const size_t offset = out.size();
+        out.resize(offset + static_cast<size_t>(n) + 1);
+        print(&out[offset], static_cast<size_t>(n) + 1);
+        out.resize(offset + static_cast<size_t>(n));
+    }
+}
+
+// 用记录的参数还原 printf 风格的消息，结果与调用时直接 snprintf 一致
+// 整数按转换说明的长度修饰符截断（与 printf 对实参的处理相同），64 位修饰符统一为 ll
+inline std::string formatLogMessage(const char* format, const uint8_t* args, size_t len) {
+    std::string out;
+    LogArgReader reader(args, len);
+    LogArgReader::Arg arg;
+    const char* p = format;
+    while (*p != '\0') {
+        const char* percent = strchr(p, '%');
+        if (percent == nullptr) {
+            out.append(p);
+            break;
+        }
+        out.append(p, percent);
+        p = percent + 1;
+        if (*p == '%') {
+            out += '%';
+            ++p;
+            continue;
+        }
+
+        std::string spec = "%";
+        int stars[2];
+        int starCount = 0;
+        bool missing = false;
+        while (*p != '\0' && strchr("-+ #0", *p) != nullptr) spec += *p++;
+        for (int field = 0; field < 2; ++field) {
+            if (field == 1) {
+                if (*p != '.') break;
+                spec += *p++;
+            }
+            if (*p == '*') {
+                spec += *p++;
+                if (reader.next(arg)) {
+                    stars[starCount++] = static_cast<int>(arg.asSigned());
+                } else {
+                    missing = true;
+                }
+            } else {
+                while (*p >= '0' && *p <= '9') spec += *p++;
+            }
+        }
+        std::string length;
+        while (*p != '\0' && strchr("hlLqjzt", *p) != nullptr) length += *p++;
+        const char conv = *p;
+        if (conv == '\0') {
+            out.append(percent);
+            break;
+        }
+        ++p;
+
+        const bool isInteger = strchr("diouxXc", conv) != nullptr;
+        const bool known = isInteger || strchr("eEfFgGaAspn", conv) != nullptr;
+        if (!known || missing || !reader.next(arg)) {
+            // 未知的转换说明或缺少参数：原样输出
+            out.append(percent, p);
+            continue;
+        }
+
+        const bool wide = !length.empty() && length[0] != 'h';
+        if (conv == 'c') {
+            appendLogConversion(out, spec + 'c', stars, starCount, static_cast<int>(arg.asSigned()));
+        } else if (conv == 'd' || conv == 'i') {
+            if (wide) {
+                appendLogConversion(out, spec + "ll" + conv, stars, starCount, static_cast<long long>(arg.asSigned()));
+            } else {
+                appendLogConversion(out, spec + length + conv, stars, starCount, static_cast<int>(arg.asSigned()));
+            }
+        } else if (isInteger) {
+            if (wide) {
+                appendLogConversion(out, spec + "ll" + conv, stars, starCount,
+                                    static_cast<unsigned long long>(arg.asUnsigned()));
+            } else {
+                appendLogConversion(out, spec + length + conv, stars, starCount,
+                                    static_cast<unsigned int>(arg.asUnsigned()));
+            }
+        } else if (conv == 's') {
+            const std::string text = arg.type == LogArgType::String ? std::string(arg.str, arg.len) : "(?)";
+            appendLogConversion(out, spec + 's', stars, starCount, text.c_str());
+        } else if (conv == 'p') {
+            appendLogConversion(out, spec + 'p', stars, starCount,
+                                reinterpret_cast<const void*>(static_cast<uintptr_t>(arg.bits)));
+        } else if (conv != 'n') {
+            appendLogConversion(out, spec + conv, stars, starCount, arg.asDouble());
+        }
+    }
+    return out;
+}
+
+// 与日志的时间格式一致：YYYY-mm-dd HH:MM:SS.mmm（本地时间）
+inline std::string formatLogTime(uint64_t ns) {
+    const time_t seconds = static_cast<time_t>(ns / 1000000000);
+    std::tm tm{};
+    localtime_r(&seconds, &tm);
+    char buf[32];
+    size_t n = strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
+    snprintf(buf + n, sizeof(buf) - n, ".%03d", static_cast<int>(ns / 1000000 % 1000));
+    return buf;
+}
@@ -16,6 +16,14 @@
 #include <filesystem>
 #include <memory>
 #include <system_error>
+#include <chrono>
+#include <thread>
+#include <condition_variable>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "ring_buffer.h"
+#include "log_format.h"
 
 namespace fs = std::filesystem;
 
@@ -26,6 +34,18 @@ enum class LogLevel {
     ERROR
 };
 
+// 异步日志参数
+// 异步模式下调用日志宏的线程只把格式编号和原始参数写入本线程的无锁队列（不格式化、不加锁、不做文件I/O），
+// 由后台线程批量格式化并写入各通道的日志文件；队列满时丢弃记录并计数，从不阻塞调用线程
+struct LogAsyncOptions {
+    size_t queueBytes = 1024 * 1024;        // 每个线程的队列大小（字节），超过的记录被丢弃
+    uint32_t flushIntervalMs = 50;          // 写入间隔上限：记录最迟在该时间后写入文件（毫秒）
+    size_t writeBufferBytes = 256 * 1024;   // 单个文件的写缓冲区，积满时立即写入
+    // 非空时日志宏的记录不再格式化为文本，原样写入该结构化日志文件（用 log_decode 还原为文本日志）；
+    // 控制台输出和二进制数据日志不受影响
+    std::string structuredFile;
+};
+
 class LogRecord {
 public:
     // 获取日志单例实例
@@ -39,6 +59,38 @@ public:
         getInstance()._init(consoleLog, fileLog, logDir);
     }
 
+    // 启用异步模式（在 init 之后调用，只能启用一次），进程退出时自动写完剩余记录
+    static void enableAsync(const LogAsyncOptions& options = LogAsyncOptions()) {
+        getInstance()._enableAsync(options);
+    }
+
+    // 停止后台线程并写完已入队的记录，之后恢复同步模式
+    static void stopAsync() {
+        getInstance()._stopAsync();
+    }
+
+    // 异步模式下因队列已满而丢弃的记录数
+    static uint64_t droppedRecords() {
+        return getInstance()._droppedRecords();
+    }
+
+    // 登记调用点的格式字符串，返回格式编号（日志宏在每个调用点首次执行时调用一次）
+    static uint32_t registerFormat(const char* format) {
+        return getInstance()._registerFormat(format);
+    }
+
+    // 日志宏的入口：异步模式下只记录格式编号和参数，同步模式下立即格式化
+    template <typename... Args>
+    static void addFormatLog(uint32_t formatId, const std::string& channel, LogLevel level, const char* format,
+                             const Args&... args) {
+        LogRecord& log = getInstance();
+        if (log._async.load(std::memory_order_acquire)) {
+            log._pushDeferred(formatId, channel, level, args...);
+            return;
+        }
+        addChannelLog(channel, level, format, args...);
+    }
+
     // 添加格式化日志
     static void addLog(LogLevel level, const char* format, ...) {
         va_list args;
@@ -70,16 +122,92 @@ private:
         std::ofstream file;
         std::string filename;
         bool needsReopen = false;  // 标记是否需要重新打开文件
+        std::string pending;       // 异步模式：等待写入文件的内容
+    };
+
+    // 异步记录类型
+    enum class AsyncKind : uint8_t {
+        Line,        // 已格式化的日志消息
+        Hex,         // 二进制数据，写入时转为十六进制
+        Text,        // 二进制数据，按文本写入
+        Deferred     // 日志宏的格式编号和参数编码，写入时格式化
+    };
+
+    // 异步记录 = 记录头 + 通道名 + 前缀 + 负载
+    struct AsyncHeader {
+        int64_t time;            // 记录时间（_asyncTimestamp()，写入时换算为系统时间）
+        uint32_t formatId;       // Deferred 记录的格式编号
+        uint32_t payloadLen;
+        uint16_t channelLen;
+        uint16_t prefixLen;
+        AsyncKind kind;
+        LogLevel level;
+    };
+
+    // 单个生产线程的队列：只有该线程写入、后台线程读取
+    struct AsyncQueue {
+        explicit AsyncQueue(size_t bytes) : ring(bytes) {}
+        RingBuffer ring;
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<bool> closed{false};   // 生产线程已退出，读空后移除
     };
 
-    bool _consoleLog = true;
-    bool _fileLog = false;
+    // 线程退出时标记队列关闭（队列由后台线程持有到读空为止）
+    struct AsyncQueueHandle {
+        std::shared_ptr<AsyncQueue> queue;
+        ~AsyncQueueHandle() {
+            if (queue) queue->closed.store(true, std::memory_order_release);
+        }
+    };
+
+    std::atomic<bool> _consoleLog{true};
+    std::atomic<bool> _fileLog{false};
     fs::path _logDir;
     std::mutex _mutex;
     std::map<std::string, ChannelLog> _channelLogs;
+
+    // 异步模式
+    static constexpr size_t kAsyncRecordsPerQueue = 4096;
+    std::atomic<bool> _async{false};
+    LogAsyncOptions _asyncOptions;
+    std::thread _asyncWriter;
+    std::mutex _asyncWakeMutex;             // 只用于后台线程的定时等待，生产线程不使用
+    std::condition_variable _asyncWake;
+    bool _asyncStop = false;
+    std::mutex _queuesMutex;                // 保护队列列表（线程首次记录日志时注册）
+    std::vector<std::shared_ptr<AsyncQueue>> _queues;
+    uint64_t _retiredDropped = 0;           // 已移除队列的丢弃计数
+    uint64_t _reportedDropped = 0;          // 已写入日志的丢弃计数（后台线程）
+    std::string _consoleOut;                // 后台线程：待输出到控制台的内容
+    std::string _consoleErr;
+    int64_t _cachedSecond = -1;             // 后台线程：时间字符串缓存（按秒）
+    std::string _cachedTime;
+
+    // 记录时间戳：x86 上 TSC 恒定速率时直接读 TSC（比 clock_gettime 快），由后台线程按校准结果换算为系统时间
+    bool _useTsc = false;
+    int64_t _tscStartTicks = 0;             // 启用异步模式时的 TSC 与系统时间，用于校准频率
+    int64_t _tscStartNs = 0;
+    int64_t _tscBaseTicks = 0;              // 后台线程：换算基准，定期更新以跟随系统时间调整
+    int64_t _tscBaseNs = 0;
+    double _tscNsPerTick = 0;
+
+    // 延迟格式化
+    static constexpr size_t kDeferredChannelBytes = 256;
+    static constexpr size_t kDeferredArgsBytes = 1024;
+    std::mutex _formatsMutex;               // 保护格式表（每个调用点只登记一次）
+    std::vector<std::string> _formats;
+    std::vector<std::string> _writerFormats;        // 后台线程：格式表的副本，读取时不加锁
+    std::string _structuredPath;                    // 后台线程：结构化日志文件，为空时格式化为文本
+    std::ofstream _structuredFile;
+    std::string _structuredPending;
+    std::vector<bool> _structuredFormatsWritten;    // 本节已写入格式块的编号
     
     // 私有构造函数（单例模式）
     LogRecord() = default;
+
+    ~LogRecord() {
+        _stopAsync();
+    }
     
     // 禁用拷贝和赋值
     LogRecord(const LogRecord&) = delete;
@@ -112,15 +240,25 @@ private:
     }
 
     void _addLog(const std::string& channel, LogLevel level, const char* format, va_list args) {
+        const bool consoleLog = _consoleLog.load(std::memory_order_relaxed);
+        const bool fileLog = _fileLog.load(std::memory_order_relaxed);
+        if (!consoleLog && !fileLog) return;
+
         char buffer[1024];
-        vsnprintf(buffer, sizeof(buffer), format, args);
+        int n = vsnprintf(buffer, sizeof(buffer), format, args);
         
+        if (_async.load(std::memory_order_acquire)) {
+            const size_t len = n < 0 ? 0 : std::min(static_cast<size_t>(n), sizeof(buffer) - 1);
+            _pushAsync(AsyncKind::Line, level, channel, std::string(), reinterpret_cast<const uint8_t*>(buffer), len);
+            return;
+        }
+
         const auto logLine = _formatLogLine(channel, level, buffer);
         
         std::lock_guard<std::mutex> lock(_mutex);
         
         // 输出到控制台
-        if (_consoleLog) {
+        if (consoleLog) {
             if (level >= LogLevel::WARNING) {
                 std::cerr << logLine << std::endl;
             } else {
@@ -129,7 +267,7 @@ private:
         }
         
         // 输出到文件
-        if (_fileLog) {
+        if (fileLog) {
             // 确保日志目录存在
             _ensureLogDirectory();
             
@@ -186,10 +324,14 @@ private:
     }
 
     void _logBinary(const std::string& channel, const std::string& prefix, const uint8_t* data, size_t len) {
+        if (!_fileLog.load(std::memory_order_relaxed)) return;
+        if (_async.load(std::memory_order_acquire)) {
+            _pushAsync(AsyncKind::Hex, LogLevel::INFO, channel, prefix, data, len);
+            return;
+        }
+
         std::lock_guard<std::mutex> lock(_mutex);
         
-        if (!_fileLog) return;
-        
         // 确保日志目录存在
         _ensureLogDirectory();
         
@@ -224,10 +366,14 @@ private:
 
     // 二进制转文本日志函数
 void _logBinaryAsText(const std::string& channel, const std::string& prefix, const uint8_t* data, size_t len) {
+    if (!_fileLog.load(std::memory_order_relaxed)) return;
+    if (_async.load(std::memory_order_acquire)) {
+        _pushAsync(AsyncKind::Text, LogLevel::INFO, channel, prefix, data, len);
+        return;
+    }
+
     std::lock_guard<std::mutex> lock(_mutex);
     
-    if (!_fileLog) return;  
-    
     try {
         std::ostringstream oss;
         oss << prefix << " " <<  std::to_string(len) << " bytes: ";
@@ -299,6 +445,481 @@ ChannelLog& _getChannelLog(const std::string& channel) {
     return _channelLogs.emplace(channel, std::move(newLog)).first->second;
 }
 
+    void _enableAsync(const LogAsyncOptions& options) {
+        std::lock_guard<std::mutex> lock(_asyncWakeMutex);
+        if (_asyncWriter.joinable()) return;
+
+        _asyncOptions = options;
+        _structuredPath = options.structuredFile;
+        _useTsc = _tscInvariant();
+        if (_useTsc) _calibrateTsc(true);
+        _asyncStop = false;
+        _asyncWriter = std::thread([this] { _asyncWriterLoop(); });
+        _async.store(true, std::memory_order_release);
+    }
+
+    void _stopAsync() {
+        {
+            std::lock_guard<std::mutex> lock(_asyncWakeMutex);
+            if (!_asyncWriter.joinable()) return;
+            _async.store(false, std::memory_order_release);
+            _asyncStop = true;
+        }
+        _asyncWake.notify_one();
+        _asyncWriter.join();
+    }
+
+    uint64_t _droppedRecords() {
+        std::lock_guard<std::mutex> lock(_queuesMutex);
+        uint64_t dropped = _retiredDropped;
+        for (const auto& queue : _queues) {
+            dropped += queue->dropped.load(std::memory_order_relaxed);
+        }
+        return dropped;
+    }
+
+    // TSC 以恒定速率运行且在各核心间同步时才能作为时间戳
+    static bool _tscInvariant() {
+#if defined(__x86_64__) || defined(__i386__)
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::string line;
+        while (std::getline(cpuinfo, line)) {
+            if (line.compare(0, 5, "flags") == 0) {
+                return line.find(" constant_tsc") != std::string::npos &&
+                       line.find(" nonstop_tsc") != std::string::npos;
+            }
+        }
+#endif
+        return false;
+    }
+
+    static int64_t _readTsc() {
+#if defined(__x86_64__) || defined(__i386__)
+        return static_cast<int64_t>(__rdtsc());
+#else
+        return 0;
+#endif
+    }
+
+    int64_t _asyncTimestamp() const {
+        if (_useTsc) return _readTsc();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    // 启用时测量 10 毫秒得到初始频率；之后后台线程每秒用启用以来的总时长修正频率，并更新换算基准
+    void _calibrateTsc(bool initial) {
+        const auto sample = [](int64_t& ticks, int64_t& ns) {
+            ticks = _readTsc();
+            ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        };
+        if (initial) {
+            sample(_tscStartTicks, _tscStartNs);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        int64_t ticks, ns;
+        sample(ticks, ns);
+        if (!initial && ns - _tscBaseNs < 1000000000) return;
+        if (ticks > _tscStartTicks) {
+            _tscNsPerTick = static_cast<double>(ns - _tscStartNs) / static_cast<double>(ticks - _tscStartTicks);
+        }
+        _tscBaseTicks = ticks;
+        _tscBaseNs = ns;
+    }
+
+    // 后台线程：记录时间换算为系统时间
+    std::chrono::system_clock::time_point _asyncTime(int64_t stamp) const {
+        int64_t ns = stamp;
+        if (_useTsc) {
+            ns = _tscBaseNs + static_cast<int64_t>(static_cast<double>(stamp - _tscBaseTicks) * _tscNsPerTick);
+        }
+        return std::chrono::system_clock::time_point{
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(ns))};
+    }
+
+    uint32_t _registerFormat(const char* format) {
+        std::lock_guard<std::mutex> lock(_formatsMutex);
+        _formats.emplace_back(format);
+        return static_cast<uint32_t>(_formats.size() - 1);
+    }
+
+    // 后台线程：格式编号对应的格式字符串，新登记的格式在首次遇到时复制
+    const std::string& _writerFormat(uint32_t formatId) {
+        if (formatId >= _writerFormats.size()) {
+            std::lock_guard<std::mutex> lock(_formatsMutex);
+            _writerFormats.assign(_formats.begin(), _formats.end());
+        }
+        static const std::string kUnknown = "(unknown log format)";
+        return formatId < _writerFormats.size() ? _writerFormats[formatId] : kUnknown;
+    }
+
+    // 本线程的队列，首次调用时创建并注册
+    AsyncQueue* _threadQueue() {
+        static thread_local AsyncQueueHandle handle;
+        if (!handle.queue) {
+            handle.queue = std::make_shared<AsyncQueue>(_asyncOptions.queueBytes);
+            std::lock_guard<std::mutex> lock(_queuesMutex);
+            _queues.push_back(handle.queue);
+        }
+        return handle.queue.get();
+    }
+
+    // 生产线程：写入本线程队列，空间不足时丢弃并计数
+    void _pushAsync(AsyncKind kind, LogLevel level, const std::string& channel, const std::string& prefix,
+                    const uint8_t* data, size_t len) {
+        AsyncHeader header{};
+        header.time = _asyncTimestamp();
+        header.payloadLen = static_cast<uint32_t>(len);
+        header.channelLen = static_cast<uint16_t>(std::min<size_t>(channel.size(), UINT16_MAX));
+        header.prefixLen = static_cast<uint16_t>(std::min<size_t>(prefix.size(), UINT16_MAX));
+        header.kind = kind;
+        header.level = level;
+
+        const iovec iov[] = {
+            {&header, sizeof(header)},
+            {const_cast<char*>(channel.data()), header.channelLen},
+            {const_cast<char*>(prefix.data()), header.prefixLen},
+            {const_cast<uint8_t*>(data), len},
+        };
+        const size_t size = sizeof(header) + header.channelLen + header.prefixLen + len;
+
+        AsyncQueue* queue = _threadQueue();
+        if (len > UINT32_MAX || !queue->ring.pushRecord(iov, 4, size)) {
+            queue->dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // 生产线程：日志宏的记录在栈上拼成一条完整记录（参数直接编码到最终位置），一次写入队列
+    template <typename... Args>
+    void _pushDeferred(uint32_t formatId, const std::string& channel, LogLevel level, const Args&... args) {
+        if (!_consoleLog.load(std::memory_order_relaxed) && !_fileLog.load(std::memory_order_relaxed)) return;
+
+        uint8_t record[sizeof(AsyncHeader) + kDeferredChannelBytes + kDeferredArgsBytes];
+        AsyncHeader header{};
+        header.time = _asyncTimestamp();
+        header.formatId = formatId;
+        header.channelLen = static_cast<uint16_t>(std::min(channel.size(), kDeferredChannelBytes));
+        header.kind = AsyncKind::Deferred;
+        header.level = level;
+        uint8_t* channelData = record + sizeof(header);
+        std::memcpy(channelData, channel.data(), header.channelLen);
+        header.payloadLen = static_cast<uint32_t>(
+            packLogArgs(channelData + header.channelLen, kDeferredArgsBytes, args...));
+        std::memcpy(record, &header, sizeof(header));
+
+        AsyncQueue* queue = _threadQueue();
+        if (!queue->ring.pushRecord(record, sizeof(header) + header.channelLen + header.payloadLen)) {
+            queue->dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // 后台线程：读空所有队列后写入文件，空闲时最多等待 flushIntervalMs
+    void _asyncWriterLoop() {
+        const auto interval = std::chrono::milliseconds(_asyncOptions.flushIntervalMs);
+        while (true) {
+            bool stopping;
+            {
+                std::lock_guard<std::mutex> lock(_asyncWakeMutex);
+                stopping = _asyncStop;
+            }
+
+            if (_useTsc) _calibrateTsc(false);
+
+            // 停止时生产线程已回到同步模式，读空所有队列后退出
+            const size_t records = _drainQueues();
+            if (stopping) {
+                while (_drainQueues() > 0) {}
+                std::lock_guard<std::mutex> lock(_mutex);
+                _structuredFile.close();
+                return;
+            }
+
+            if (records == 0) {
+                std::unique_lock<std::mutex> lock(_asyncWakeMutex);
+                _asyncWake.wait_for(lock, interval, [this] { return _asyncStop; });
+            }
+        }
+    }
+
+    // 读取并格式化所有队列中的记录，写入文件，返回处理的记录数
+    size_t _drainQueues() {
+        std::vector<std::shared_ptr<AsyncQueue>> queues;
+        {
+            std::lock_guard<std::mutex> lock(_queuesMutex);
+            queues = _queues;
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        size_t total = 0;
+        RingRecord records[64];
+        std::vector<uint8_t> scratch;
+        for (const auto& queue : queues) {
+            // 先读取关闭标记：此后队列不会再有新记录
+            const bool closed = queue->closed.load(std::memory_order_acquire);
+            // 每轮每个队列最多处理 kAsyncRecordsPerQueue 条，持续写日志的线程不会拖延其他队列的写入
+            size_t count;
+            size_t queueRecords = 0;
+            while (queueRecords < kAsyncRecordsPerQueue && (count = queue->ring.peekRecords(records, 64)) > 0) {
+                for (size_t i = 0; i < count; ++i) {
+                    const RingRecord& record = records[i];
+                    const uint8_t* data = static_cast<const uint8_t*>(record.spans[0].iov_base);
+                    if (record.count == 2) {
+                        // 记录跨越环尾，拼接为连续内存
+                        scratch.assign(data, data + record.spans[0].iov_len);
+                        const uint8_t* rest = static_cast<const uint8_t*>(record.spans[1].iov_base);
+                        scratch.insert(scratch.end(), rest, rest + record.spans[1].iov_len);
+                        data = scratch.data();
+                    }
+                    _formatAsyncRecord(data);
+                }
+                queue->ring.commitRecords(records, count);
+                queueRecords += count;
+            }
+            total += queueRecords;
+            if (closed && queue->ring.empty()) {
+                std::lock_guard<std::mutex> queuesLock(_queuesMutex);
+                _retiredDropped += queue->dropped.load(std::memory_order_relaxed);
+                _queues.erase(std::find(_queues.begin(), _queues.end(), queue));
+            }
+        }
+
+        const uint64_t dropped = _droppedRecords();
+        if (dropped > _reportedDropped) {
+            char message[128];
+            snprintf(message, sizeof(message), "Dropped %llu log records (log queue full)",
+                     static_cast<unsigned long long>(dropped - _reportedDropped));
+            _reportedDropped = dropped;
+            _appendAsyncLine("", LogLevel::WARNING, std::chrono::system_clock::now(), message, strlen(message));
+        }
+
+        _flushPending();
+        return total;
+    }
+
+    void _formatAsyncRecord(const uint8_t* data) {
+        AsyncHeader header;
+        std::memcpy(&header, data, sizeof(header));
+        const char* channelData = reinterpret_cast<const char*>(data + sizeof(header));
+        const std::string channel(channelData, header.channelLen);
+        const char* prefix = channelData + header.channelLen;
+        const uint8_t* payload = reinterpret_cast<const uint8_t*>(prefix + header.prefixLen);
+        const std::chrono::system_clock::time_point time = _asyncTime(header.time);
+
+        switch (header.kind) {
+            case AsyncKind::Line:
+                _appendAsyncLine(channel, header.level, time, reinterpret_cast<const char*>(payload),
+                                 header.payloadLen);
+                break;
+            case AsyncKind::Deferred: {
+                const std::string& format = _writerFormat(header.formatId);
+                if (!_structuredPath.empty() && _fileLog.load(std::memory_order_relaxed) &&
+                    _appendStructuredRecord(header, time, channelData, payload, format)) {
+                    // 文件只保存原始记录，只有控制台输出需要格式化
+                    if (_consoleLog.load(std::memory_order_relaxed)) {
+                        const std::string message = formatLogMessage(format.c_str(), payload, header.payloadLen);
+                        _appendConsoleLine(channel, header.level, time, message.data(), message.size());
+                    }
+                } else {
+                    const std::string message = formatLogMessage(format.c_str(), payload, header.payloadLen);
+                    _appendAsyncLine(channel, header.level, time, message.data(), message.size());
+                }
+                break;
+            }
+            case AsyncKind::Hex: {
+                // 与同步模式格式一致：时间 前缀字节数 bytes: 十六进制
+                static const char kHex[] = "0123456789abcdef";
+                ChannelLog& clog = _channelLog(channel);
+                std::string& out = clog.pending;
+                out += _asyncTimeStr(time);
+                out += ' ';
+                out.append(prefix, header.prefixLen);
+                out += std::to_string(header.payloadLen);
+                out += " bytes: ";
+                for (uint32_t i = 0; i < header.payloadLen; ++i) {
+                    out += kHex[payload[i] >> 4];
+                    out += kHex[payload[i] & 0x0F];
+                    if (i + 1 < header.payloadLen) out += ' ';
+                }
+                out += '\n';
+                _writePendingIfFull(clog);
+                break;
+            }
+            case AsyncKind::Text: {
+                std::string text(prefix, header.prefixLen);
+                text += " " + std::to_string(header.payloadLen) + " bytes: ";
+                text.append(reinterpret_cast<const char*>(payload), header.payloadLen);
+                ChannelLog& clog = _channelLog(channel);
+                _appendLinePrefix(clog.pending, channel, LogLevel::INFO, time);
+                clog.pending += text;
+                clog.pending += '\n';
+                _writePendingIfFull(clog);
+                break;
+            }
+        }
+    }
+
+    // 格式化一条日志消息，写入控制台和文件缓冲区
+    void _appendAsyncLine(const std::string& channel, LogLevel level, std::chrono::system_clock::time_point time,
+                          const char* message, size_t len) {
+        if (_consoleLog.load(std::memory_order_relaxed)) {
+            _appendConsoleLine(channel, level, time, message, len);
+        }
+        if (_fileLog.load(std::memory_order_relaxed)) {
+            ChannelLog& clog = _channelLog(channel.empty() ? "main" : channel);
+            _appendLinePrefix(clog.pending, channel, level, time);
+            clog.pending.append(message, len);
+            clog.pending += '\n';
+            _writePendingIfFull(clog);
+        }
+    }
+
+    void _appendConsoleLine(const std::string& channel, LogLevel level, std::chrono::system_clock::time_point time,
+                            const char* message, size_t len) {
+        std::string& out = level >= LogLevel::WARNING ? _consoleErr : _consoleOut;
+        _appendLinePrefix(out, channel, level, time);
+        out.append(message, len);
+        out += '\n';
+    }
+
+    // 把日志宏的原始记录追加到结构化日志文件的缓冲区，文件无法打开时返回 false（改为写入文本日志）
+    bool _appendStructuredRecord(const AsyncHeader& header, std::chrono::system_clock::time_point time,
+                                 const char* channel, const uint8_t* args, const std::string& format) {
+        if (!_structuredFile.is_open() && !_openStructuredFile()) return false;
+
+        if (header.formatId >= _structuredFormatsWritten.size()) {
+            _structuredFormatsWritten.resize(header.formatId + 1, false);
+        }
+        if (!_structuredFormatsWritten[header.formatId]) {
+            const LogBlockHeader block{static_cast<uint32_t>(LogBlockType::Format),
+                                       static_cast<uint32_t>(sizeof(header.formatId) + format.size())};
+            _structuredPending.append(reinterpret_cast<const char*>(&block), sizeof(block));
+            _structuredPending.append(reinterpret_cast<const char*>(&header.formatId), sizeof(header.formatId));
+            _structuredPending += format;
+            _structuredFormatsWritten[header.formatId] = true;
+        }
+
+        LogRecordBody body{};
+        body.timeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+        body.formatId = header.formatId;
+        body.channelLen = header.channelLen;
+        body.level = static_cast<uint8_t>(header.level);
+        const LogBlockHeader block{static_cast<uint32_t>(LogBlockType::Record),
+                                   static_cast<uint32_t>(sizeof(body) + header.channelLen + header.payloadLen)};
+        _structuredPending.append(reinterpret_cast<const char*>(&block), sizeof(block));
+        _structuredPending.append(reinterpret_cast<const char*>(&body), sizeof(body));
+        _structuredPending.append(channel, header.channelLen);
+        _structuredPending.append(reinterpret_cast<const char*>(args), header.payloadLen);
+        if (_structuredPending.size() >= _asyncOptions.writeBufferBytes) _writeStructuredPending();
+        return true;
+    }
+
+    // 以追加方式打开结构化日志文件并开始新的一节（格式编号重新登记）
+    bool _openStructuredFile() {
+        try {
+            const fs::path path(_structuredPath);
+            if (path.has_parent_path()) fs::create_directories(path.parent_path());
+            _structuredFile.open(path, std::ios::out | std::ios::app | std::ios::binary);
+        } catch (const std::exception& e) {
+            std::cerr << "Error creating structured log file: " << e.what() << std::endl;
+        }
+        if (!_structuredFile.is_open()) {
+            std::cerr << "ERROR: Failed to open structured log file: " << _structuredPath
+                      << ", writing text logs instead" << std::endl;
+            _structuredPath.clear();
+            return false;
+        }
+
+        const uint32_t section[] = {kStructuredLogMagic, kStructuredLogVersion};
+        const LogBlockHeader block{static_cast<uint32_t>(LogBlockType::Section), sizeof(section)};
+        _structuredPending.append(reinterpret_cast<const char*>(&block), sizeof(block));
+        _structuredPending.append(reinterpret_cast<const char*>(section), sizeof(section));
+        _structuredFormatsWritten.clear();
+        return true;
+    }
+
+    void _writeStructuredPending() {
+        if (_structuredFile.is_open()) {
+            _structuredFile.write(_structuredPending.data(), static_cast<std::streamsize>(_structuredPending.size()));
+            _structuredFile.flush();
+        }
+        _structuredPending.clear();
+    }
+
+    // 与 _formatLogLine 格式一致：时间 [级别] [通道]
+    void _appendLinePrefix(std::string& out, const std::string& channel, LogLevel level,
+                           std::chrono::system_clock::time_point time) {
+        out += _asyncTimeStr(time);
+        switch (level) {
+            case LogLevel::DEBUG:    out += " [DEBUG] "; break;
+            case LogLevel::INFO:     out += " [INFO ] "; break;
+            case LogLevel::WARNING:  out += " [WARN ] "; break;
+            case LogLevel::ERROR:    out += " [ERROR] "; break;
+        }
+        if (!channel.empty()) {
+            out += '[';
+            out += channel;
+            out += "] ";
+        }
+    }
+
+    ChannelLog& _channelLog(const std::string& channel) {
+        auto it = _channelLogs.find(channel);
+        return it != _channelLogs.end() ? it->second : _getChannelLog(channel);
+    }
+
+    // 把缓冲的内容全部写入控制台和文件（每轮读空队列后调用）
+    void _flushPending() {
+        if (!_consoleOut.empty()) {
+            std::cout.write(_consoleOut.data(), _consoleOut.size());
+            std::cout.flush();
+            _consoleOut.clear();
+        }
+        if (!_consoleErr.empty()) {
+            std::cerr.write(_consoleErr.data(), _consoleErr.size());
+            _consoleErr.clear();
+        }
+        for (auto& entry : _channelLogs) {
+            if (!entry.second.pending.empty()) _writePending(entry.second);
+        }
+        if (!_structuredPending.empty()) _writeStructuredPending();
+    }
+
+    void _writePendingIfFull(ChannelLog& clog) {
+        if (clog.pending.size() >= _asyncOptions.writeBufferBytes) _writePending(clog);
+    }
+
+    // 一次写入文件的全部缓冲内容
+    void _writePending(ChannelLog& clog) {
+        try {
+            if (clog.needsReopen || !clog.file.is_open()) {
+                _ensureLogDirectory();
+                _reopenChannelLog(clog);
+            }
+            if (clog.file.is_open()) {
+                clog.file.write(clog.pending.data(), static_cast<std::streamsize>(clog.pending.size()));
+                clog.file.flush();
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error writing log: " << e.what() << std::endl;
+        }
+        clog.pending.clear();
+    }
+
+    // 后台线程的时间格式化：同一秒内的记录复用日期时间部分
+    std::string _asyncTimeStr(std::chrono::system_clock::time_point time) {
+        const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+        const int64_t second = ms / 1000;
+        if (second != _cachedSecond) {
+            const std::string full = _timeStr(time);
+            _cachedTime = full.substr(0, full.size() - 3);   // 去掉毫秒
+            _cachedSecond = second;
+        }
+        char millis[8];
+        snprintf(millis, sizeof(millis), "%03d", static_cast<int>(ms % 1000));
+        return _cachedTime + millis;
+    }
+
     std::string _formatLogLine(const std::string& channel, LogLevel level, const char* message) {
         std::ostringstream oss;
         oss << _currentTimeStr();
@@ -322,7 +943,10 @@ ChannelLog& _getChannelLog(const std::string& channel) {
 
     // 获取当前时间字符串
     std::string _currentTimeStr() {
-        auto now = std::chrono::system_clock::now();
+        return _timeStr(std::chrono::system_clock::now());
+    }
+
+    std::string _timeStr(std::chrono::system_clock::time_point now) {
         auto now_time = std::chrono::system_clock::to_time_t(now);
         auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
             now.time_since_epoch()) % 1000;
@@ -341,17 +965,25 @@ ChannelLog& _getChannelLog(const std::string& channel) {
     }
 };
 
+// 日志宏的实现：每个调用点的格式字符串（必须是字符串常量）在首次执行时登记一次，
+// 异步模式下之后每次调用只复制格式编号、时间和参数
+#define LOG_AT(channel, level, format, ...)                                                       \
+    do {                                                                                          \
+        static const uint32_t _logFormatId = LogRecord::registerFormat(format);                   \
+        LogRecord::addFormatLog(_logFormatId, channel, level, format, ##__VA_ARGS__);             \
+    } while (0)
+
 // 全局日志宏
-#define LOG_DEBUG(format, ...)    LogRecord::addLog(LogLevel::DEBUG, format, ##__VA_ARGS__)
-#define LOG_INFO(format, ...)     LogRecord::addLog(LogLevel::INFO, format, ##__VA_ARGS__)
-#define LOG_WARNING(format, ...)  LogRecord::addLog(LogLevel::WARNING, format, ##__VA_ARGS__)
-#define LOG_ERROR(format, ...)    LogRecord::addLog(LogLevel::ERROR, format, ##__VA_ARGS__)
+#define LOG_DEBUG(format, ...)    LOG_AT(std::string(), LogLevel::DEBUG, format, ##__VA_ARGS__)
+#define LOG_INFO(format, ...)     LOG_AT(std::string(), LogLevel::INFO, format, ##__VA_ARGS__)
+#define LOG_WARNING(format, ...)  LOG_AT(std::string(), LogLevel::WARNING, format, ##__VA_ARGS__)
+#define LOG_ERROR(format, ...)    LOG_AT(std::string(), LogLevel::ERROR, format, ##__VA_ARGS__)
 
 // 通道日志宏
-#define CH_LOG_DEBUG(channel, format, ...)    LogRecord::addChannelLog(channel, LogLevel::DEBUG, format, ##__VA_ARGS__)
-#define CH_LOG_INFO(channel, format, ...)     LogRecord::addChannelLog(channel, LogLevel::INFO, format, ##__VA_ARGS__)
-#define CH_LOG_WARNING(channel, format, ...)  LogRecord::addChannelLog(channel, LogLevel::WARNING, format, ##__VA_ARGS__)
-#define CH_LOG_ERROR(channel, format, ...)    LogRecord::addChannelLog(channel, LogLevel::ERROR, format, ##__VA_ARGS__)
+#define CH_LOG_DEBUG(channel, format, ...)    LOG_AT(channel, LogLevel::DEBUG, format, ##__VA_ARGS__)
+#define CH_LOG_INFO(channel, format, ...)     LOG_AT(channel, LogLevel::INFO, format, ##__VA_ARGS__)
+#define CH_LOG_WARNING(channel, format, ...)  LOG_AT(channel, LogLevel::WARNING, format, ##__VA_ARGS__)
+#define CH_LOG_ERROR(channel, format, ...)    LOG_AT(channel, LogLevel::ERROR, format, ##__VA_ARGS__)
 
 // 二进制日志宏（十六进制格式）
 #define LOG_BINARY(channel, prefix, data, len) LogRecord::logBinary(channel, prefix, data, len)
@@ -1,6 +1,7 @@
 #include "channel_manager.h"
 #include "config_parser.h"
 #include "database.h"
+#include "metrics_server.h"
 #include <iostream>
 #include <csignal>
 #include <atomic>
@@ -11,6 +12,9 @@
 #include "logrecord.h"
 std::atomic<bool> running{true};
 
+// 指标HTTP服务默认端口（仅监听回环地址），--metrics-port 0 表示关闭
+static constexpr uint16_t kDefaultMetricsPort = 9464;
+
 void signalHandler(int signal) {
     running = false;
     if(signal == SIGINT) {
@@ -25,6 +29,21 @@ int main(int argc, char* argv[]) {
     signal(SIGTERM, signalHandler);
 
     LogRecord::init(true, true, "logs");
+    // --async-log：日志由后台线程批量格式化并写入，转发线程不再等待文件I/O
+    // --structured-log：同上，但日志宏的记录不格式化，写入 logs/structured.slog（用 log_decode 查看）
+    LogAsyncOptions logOptions;
+    bool asyncLog = false;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--async-log") == 0) {
+            asyncLog = true;
+        } else if (strcmp(argv[i], "--structured-log") == 0) {
+            asyncLog = true;
+            logOptions.structuredFile = "logs/structured.slog";
+        }
+    }
+    if (asyncLog) {
+        LogRecord::enableAsync(logOptions);
+    }
     try {
         // 处理命令行参数 
          if (argc > 1 && strcmp(argv[1], "--update") == 0) {
@@ -45,6 +64,21 @@ int main(int argc, char* argv[]) {
         }
         
         
+        // 指标服务
+        uint16_t metrics_port = kDefaultMetricsPort;
+        for (int i = 1; i + 1 < argc; ++i) {
+            if (strcmp(argv[i], "--metrics-port") == 0) {
+                metrics_port = static_cast<uint16_t>(std::stoi(argv[i + 1]));
+            }
+        }
+        std::unique_ptr<MetricsServer> metrics_server;
+        if (metrics_port != 0) {
+            metrics_server = std::make_unique<MetricsServer>(metrics_port);
+            if (!metrics_server->start()) {
+                metrics_server.reset();
+            }
+        }
+
         // 从数据库加载初始配置
         Database db;
         auto channels = db.loadChannels();
@@ -55,7 +89,7 @@ int main(int argc, char* argv[]) {
         // 初始加载配置
         for (const auto& config : channels) {
             manager.addChannel(std::make_unique<ProtocolChannel>(
-                config.name, config.input, config.output, manager.getThreadPool()));
+                config, manager.getThreadPool()));
             last_configs[config.name] = config;
         }
         LOG_INFO("Starting protocol converter...");
@@ -91,7 +125,7 @@ int main(int argc, char* argv[]) {
                     const auto& name = config.name;
                     if (last_configs.find(name) == last_configs.end()) {
                         manager.addChannel(std::make_unique<ProtocolChannel>(
-                            name, config.input, config.output, manager.getThreadPool()));
+                            config, manager.getThreadPool()));
                         last_configs[name] = config;
                     }
                 }
@@ -101,6 +135,8 @@ int main(int argc, char* argv[]) {
         }
         // 停止所有通道
         manager.stopAll();
+        metrics_server.reset();
+        LogRecord::stopAsync();
     }
     catch (const std::exception& e) {
         LOG_ERROR("Fatal error: %s", e.what());
@@ -0,0 +1,191 @@
+// metrics.cpp
+#include "metrics.h"
+#include "logrecord.h"
+#include <algorithm>
+#include <cstdio>
+
+static constexpr const char* kMetricPrefix = "protocol_converter_";
+
+size_t LatencyHistogram::bucketIndex(uint64_t ns) {
+    if (ns < (uint64_t{1} << kMinShift)) return 0;
+
+    const int msb = 63 - __builtin_clzll(ns);
+    const size_t octave = static_cast<size_t>(msb - kMinShift);
+    if (octave >= static_cast<size_t>(kOctaves)) return kBucketCount - 1;
+
+    const size_t sub = (ns >> (msb - kSubBucketBits)) & (kSubBuckets - 1);
+    return 1 + octave * kSubBuckets + sub;
+}
+
+uint64_t LatencyHistogram::upperBound(size_t index) {
+    if (index == 0) return uint64_t{1} << kMinShift;
+    if (index >= kBucketCount - 1) return 0;
+
+    const size_t octave = (index - 1) / kSubBuckets;
+    const size_t sub = (index - 1) % kSubBuckets;
+    const int msb = static_cast<int>(octave) + kMinShift;
+    const uint64_t step = uint64_t{1} << (msb - kSubBucketBits);
+    return (uint64_t{1} << msb) + (sub + 1) * step;
+}
+
+void LatencyHistogram::record(uint64_t ns) {
+    buckets_[bucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+    sum_ns_.fetch_add(ns, std::memory_order_relaxed);
+}
+
+HistogramSnapshot LatencyHistogram::snapshot() const {
+    HistogramSnapshot snap;
+    snap.counts.reserve(kBucketCount);
+    for (const auto& bucket : buckets_) {
+        snap.counts.push_back(bucket.load(std::memory_order_relaxed));
+    }
+    // 以桶计数之和为准，保证 _count 与 +Inf 桶一致
+    for (uint64_t c : snap.counts) {
+        snap.count += c;
+    }
+    snap.sum_ns = sum_ns_.load(std::memory_order_relaxed);
+    return snap;
+}
+
+void MetricsRegistry::add(const MetricsSource* source) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sources_.push_back(source);
+}
+
+void MetricsRegistry::remove(const MetricsSource* source) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sources_.erase(std::remove(sources_.begin(), sources_.end(), source), sources_.end());
+}
+
+// 标签值转义（Prometheus 文本格式：反斜杠、双引号、换行）
+static std::string escapeLabel(const std::string& value) {
+    std::string out;
+    out.reserve(value.size());
+    for (char c : value) {
+        switch (c) {
+            case '\\': out += "\\\\"; break;
+            case '"':  out += "\\\""; break;
+            case '\n': out += "\\n"; break;
+            default:   out += c; break;
+        }
+    }
+    return out;
+}
+
+static void writeHeader(std::string& out, const char* name, const char* type, const char* help) {
+    out += "# HELP "; out += kMetricPrefix; out += name; out += ' '; out += help; out += '\n';
+    out += "# TYPE "; out += kMetricPrefix; out += name; out += ' '; out += type; out += '\n';
+}
+
+static void writeSample(std::string& out, const char* name, const char* suffix,
+                        const std::string& labels, uint64_t value) {
+    out += kMetricPrefix; out += name; out += suffix;
+    out += '{'; out += labels; out += "} ";
+    out += std::to_string(value);
+    out += '\n';
+}
+
+static std::string formatSeconds(uint64_t ns) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.9g", static_cast<double>(ns) / 1e9);
+    return buf;
+}
+
+static std::string directionLabels(const ChannelSnapshot& ch, const DirectionSnapshot& dir) {
+    return "channel=\"" + escapeLabel(ch.channel) + "\",direction=\"" + dir.direction + "\"";
+}
+
+static std::string endpointLabels(const ChannelSnapshot& ch, const EndpointSnapshot& ep) {
+    return "channel=\"" + escapeLabel(ch.channel) + "\",node=\"" + ep.node +
+           "\",type=\"" + escapeLabel(ep.type) + "\"";
+}
+
+std::string MetricsRegistry::render() {
+    std::vector<ChannelSnapshot> channels;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        channels.reserve(sources_.size());
+        for (const MetricsSource* source : sources_) {
+            channels.push_back(source->snapshot());
+        }
+    }
+
+    std::string out;
+    out.reserve(4096 + channels.size() * 16384);
+
+    // 方向指标：同名指标的样本需连续输出
+    struct DirectionFamily {
+        const char* name;
+        const char* type;
+        const char* help;
+        uint64_t DirectionSnapshot::*field;
+    };
+    static const DirectionFamily kDirectionFamilies[] = {
+        {"bytes_in_total", "counter", "Bytes received from the source endpoint.", &DirectionSnapshot::bytes_in},
+        {"packets_in_total", "counter", "Reads received from the source endpoint.", &DirectionSnapshot::packets_in},
+        {"bytes_out_total", "counter", "Bytes accepted by the target endpoint.", &DirectionSnapshot::bytes_out},
+        {"packets_out_total", "counter", "Writes or datagrams accepted by the target endpoint.", &DirectionSnapshot::packets_out},
+        {"dropped_packets_total", "counter", "Reads dropped because the direction buffer was full.", &DirectionSnapshot::dropped_packets},
+        {"dropped_bytes_total", "counter", "Bytes dropped because the direction buffer was full.", &DirectionSnapshot::dropped_bytes},
+        {"buffer_depth_bytes", "gauge", "Bytes currently queued in the direction buffer.", &DirectionSnapshot::depth},
+        {"buffer_high_water_bytes", "gauge", "Peak bytes queued in the direction buffer.", &DirectionSnapshot::depth_high},
+    };
+    for (const auto& family : kDirectionFamilies) {
+        writeHeader(out, family.name, family.type, family.help);
+        for (const auto& ch : channels) {
+            for (const auto& dir : ch.directions) {
+                writeSample(out, family.name, "", directionLabels(ch, dir), dir.*family.field);
+            }
+        }
+    }
+
+    // 接收到发送的延迟直方图
+    writeHeader(out, "forward_latency_seconds", "histogram",
+                "Time from receiving data to handing it to the target endpoint.");
+    for (const auto& ch : channels) {
+        for (const auto& dir : ch.directions) {
+            const std::string labels = directionLabels(ch, dir);
+            const HistogramSnapshot& h = dir.latency;
+            uint64_t cumulative = 0;
+            for (size_t i = 0; i + 1 < h.counts.size(); ++i) {
+                cumulative += h.counts[i];
+                writeSample(out, "forward_latency_seconds", "_bucket",
+                            labels + ",le=\"" + formatSeconds(LatencyHistogram::upperBound(i)) + "\"",
+                            cumulative);
+            }
+            writeSample(out, "forward_latency_seconds", "_bucket", labels + ",le=\"+Inf\"", h.count);
+            out += kMetricPrefix; out += "forward_latency_seconds_sum{"; out += labels; out += "} ";
+            out += formatSeconds(h.sum_ns); out += '\n';
+            writeSample(out, "forward_latency_seconds", "_count", labels, h.count);
+        }
+    }
+
+    // 端点指标
+    writeHeader(out, "endpoint_write_errors_total", "counter", "Failed writes on the endpoint.");
+    for (const auto& ch : channels) {
+        for (const auto& ep : ch.endpoints) {
+            writeSample(out, "endpoint_write_errors_total", "", endpointLabels(ch, ep), ep.write_errors);
+        }
+    }
+    writeHeader(out, "endpoint_reconnects_total", "counter", "Reconnect attempts scheduled by the endpoint.");
+    for (const auto& ch : channels) {
+        for (const auto& ep : ch.endpoints) {
+            writeSample(out, "endpoint_reconnects_total", "", endpointLabels(ch, ep), ep.reconnects);
+        }
+    }
+    writeHeader(out, "endpoint_receive_drops_total", "counter",
+                "Inbound messages dropped because they exceeded the endpoint's receive limit.");
+    for (const auto& ch : channels) {
+        for (const auto& ep : ch.endpoints) {
+            writeSample(out, "endpoint_receive_drops_total", "", endpointLabels(ch, ep), ep.receive_drops);
+        }
+    }
+
+    // 日志指标（进程级）
+    writeHeader(out, "log_dropped_records_total", "counter",
+                "Log records dropped because an asynchronous log queue was full.");
+    out += kMetricPrefix; out += "log_dropped_records_total ";
+    out += std::to_string(LogRecord::droppedRecords()); out += '\n';
+
+    return out;
+}
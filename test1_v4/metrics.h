@@ -0,0 +1,156 @@
+// metrics.h
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include "ring_buffer.h"
+
+// 分片计数器：每个线程固定写入一个缓存行对齐的分片，读取时汇总
+// 写入为无锁的 relaxed 原子加，多个线程同时计数时不会争用同一缓存行
+class Counter {
+public:
+    void add(uint64_t n = 1) {
+        cells_[threadSlot()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    uint64_t value() const {
+        uint64_t total = 0;
+        for (const auto& cell : cells_) {
+            total += cell.value.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+private:
+    static constexpr size_t kShards = 8;
+
+    struct alignas(kCacheLineSize) Cell {
+        std::atomic<uint64_t> value{0};
+    };
+
+    static size_t threadSlot() {
+        static std::atomic<size_t> next{0};
+        static thread_local size_t slot = next.fetch_add(1, std::memory_order_relaxed) % kShards;
+        return slot;
+    }
+
+    std::array<Cell, kShards> cells_;
+};
+
+// 峰值记录：只在新值更大时写入
+class MaxGauge {
+public:
+    void update(uint64_t v) {
+        uint64_t current = value_.load(std::memory_order_relaxed);
+        while (v > current &&
+               !value_.compare_exchange_weak(current, v, std::memory_order_relaxed)) {
+        }
+    }
+
+    uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+struct HistogramSnapshot {
+    std::vector<uint64_t> counts;   // 各桶计数（非累计），最后一个为溢出桶
+    uint64_t count = 0;
+    uint64_t sum_ns = 0;
+};
+
+// 对数线性直方图（纳秒）：每个2的幂区间再线性分为 kSubBuckets 段，相对误差不超过 1/kSubBuckets
+// 桶0为 [0, 2^kMinShift)，最后一个桶为溢出桶
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 2;
+    static constexpr size_t kSubBuckets = size_t{1} << kSubBucketBits;
+    static constexpr int kMinShift = 10;    // ~1us
+    static constexpr int kOctaves = 25;     // 上限 2^35ns ~34s
+    static constexpr size_t kBucketCount = 1 + kOctaves * kSubBuckets + 1;
+
+    void record(uint64_t ns);
+    HistogramSnapshot snapshot() const;
+
+    // 第 index 个桶的上界（纳秒，不含），溢出桶返回 0
+    static uint64_t upperBound(size_t index);
+
+private:
+    static size_t bucketIndex(uint64_t ns);
+
+    std::array<std::atomic<uint64_t>, kBucketCount> buckets_{};
+    std::atomic<uint64_t> sum_ns_{0};
+};
+
+// 单个转发方向的指标
+struct DirectionMetrics {
+    Counter bytes_in;
+    Counter packets_in;
+    Counter bytes_out;
+    Counter packets_out;
+    Counter dropped_packets;
+    Counter dropped_bytes;
+    MaxGauge depth_high;          // 缓冲区占用峰值
+    LatencyHistogram latency;     // 接收到发送的时间
+};
+
+struct DirectionSnapshot {
+    std::string direction;        // 如 "node1_to_node2"
+    uint64_t bytes_in = 0;
+    uint64_t packets_in = 0;
+    uint64_t bytes_out = 0;
+    uint64_t packets_out = 0;
+    uint64_t dropped_packets = 0;
+    uint64_t dropped_bytes = 0;
+    uint64_t depth = 0;
+    uint64_t depth_high = 0;
+    HistogramSnapshot latency;
+};
+
+struct EndpointSnapshot {
+    std::string node;             // "node1" / "node2"
+    std::string type;             // 端点类型，如 "tcp_server"
+    uint64_t write_errors = 0;
+    uint64_t reconnects = 0;
+    uint64_t receive_drops = 0;
+};
+
+struct ChannelSnapshot {
+    std::string channel;
+    std::vector<DirectionSnapshot> directions;
+    std::vector<EndpointSnapshot> endpoints;
+};
+
+// 指标来源（每个通道一个）
+class MetricsSource {
+public:
+    virtual ~MetricsSource() = default;
+    virtual ChannelSnapshot snapshot() const = 0;
+};
+
+// 指标注册表：通道启动时注册、停止时注销，render() 输出 Prometheus 文本格式
+class MetricsRegistry {
+public:
+    static MetricsRegistry& getInstance() {
+        static MetricsRegistry instance;
+        return instance;
+    }
+
+    void add(const MetricsSource* source);
+    // 返回后注册表不再访问该来源
+    void remove(const MetricsSource* source);
+
+    std::string render();
+
+private:
+    MetricsRegistry() = default;
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    std::mutex mutex_;
+    std::vector<const MetricsSource*> sources_;
+};
@@ -0,0 +1,164 @@
+// metrics_server.cpp
+#include "metrics_server.h"
+#include "metrics.h"
+#include "logrecord.h"
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <cstring>
+
+// 请求头上限，超过后直接断开
+static constexpr size_t kMaxRequestSize = 8192;
+
+MetricsServer::MetricsServer(uint16_t port) : _port(port) {}
+
+MetricsServer::~MetricsServer() {
+    stop();
+}
+
+bool MetricsServer::start() {
+    _listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (_listenFd < 0) {
+        LOG_ERROR("Metrics socket creation failed: %s", strerror(errno));
+        return false;
+    }
+
+    int opt = 1;
+    setsockopt(_listenFd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(_port);
+
+    if (bind(_listenFd, (sockaddr*)&address, sizeof(address)) < 0 || listen(_listenFd, 16) < 0) {
+        LOG_ERROR("Metrics bind/listen on port %u failed: %s", _port, strerror(errno));
+        ::close(_listenFd);
+        _listenFd = -1;
+        return false;
+    }
+
+    _loop.start();
+    if (!_loop.add(_listenFd, EPOLLIN, [this](uint32_t) { handleAccept(); })) {
+        LOG_ERROR("Metrics epoll_ctl failed: %s", strerror(errno));
+        _loop.stop();
+        ::close(_listenFd);
+        _listenFd = -1;
+        return false;
+    }
+
+    LOG_INFO("Metrics available at http://127.0.0.1:%u/metrics", _port);
+    return true;
+}
+
+void MetricsServer::stop() {
+    if (_listenFd < 0) return;
+
+    _loop.runSync([this] {
+        _loop.remove(_listenFd);
+        for (auto& conn : _connections) {
+            _loop.remove(conn.first);
+            ::close(conn.first);
+        }
+        _connections.clear();
+    });
+    _loop.stop();
+    ::close(_listenFd);
+    _listenFd = -1;
+}
+
+void MetricsServer::handleAccept() {
+    while (true) {
+        int fd = accept4(_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                LOG_ERROR("Metrics accept failed: %s", strerror(errno));
+            }
+            return;
+        }
+
+        if (!_loop.add(fd, EPOLLIN | EPOLLRDHUP, [this, fd](uint32_t events) { handleClient(fd, events); })) {
+            ::close(fd);
+            continue;
+        }
+        _connections[fd] = Connection{};
+    }
+}
+
+void MetricsServer::handleClient(int fd, uint32_t events) {
+    auto it = _connections.find(fd);
+    if (it == _connections.end()) return;
+    Connection& conn = it->second;
+
+    if (events & (EPOLLHUP | EPOLLERR)) {
+        closeClient(fd);
+        return;
+    }
+
+    if (events & EPOLLOUT) {
+        flushResponse(fd, conn);
+        return;
+    }
+
+    if (events & (EPOLLIN | EPOLLRDHUP)) {
+        char buffer[1024];
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0) {
+            if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+                closeClient(fd);
+            }
+            return;
+        }
+
+        conn.request.append(buffer, n);
+        if (conn.request.find("\r\n\r\n") == std::string::npos) {
+            if (conn.request.size() > kMaxRequestSize) {
+                closeClient(fd);
+            }
+            return;
+        }
+
+        buildResponse(conn);
+        _loop.modify(fd, EPOLLOUT);
+        flushResponse(fd, conn);
+    }
+}
+
+void MetricsServer::buildResponse(Connection& conn) {
+    std::string status = "200 OK";
+    std::string body;
+    if (conn.request.compare(0, 13, "GET /metrics ") == 0 || conn.request.compare(0, 6, "GET / ") == 0) {
+        body = MetricsRegistry::getInstance().render();
+    } else {
+        status = "404 Not Found";
+        body = "Not Found\n";
+    }
+
+    conn.response = "HTTP/1.1 " + status + "\r\n"
+                    "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                    "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                    "Connection: close\r\n\r\n" + body;
+    conn.sent = 0;
+}
+
+void MetricsServer::flushResponse(int fd, Connection& conn) {
+    while (conn.sent < conn.response.size()) {
+        ssize_t n = send(fd, conn.response.data() + conn.sent,
+                         conn.response.size() - conn.sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return; // 等待可写
+            }
+            break;
+        }
+        conn.sent += n;
+    }
+    closeClient(fd);
+}
+
+void MetricsServer::closeClient(int fd) {
+    _loop.remove(fd);
+    ::close(fd);
+    _connections.erase(fd);
+}
@@ -0,0 +1,35 @@
+// metrics_server.h
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include "event_loop.h"
+
+// 指标HTTP服务：仅监听回环地址，GET /metrics 返回 Prometheus 文本格式
+// 使用独立的事件循环，慢速的抓取方不会影响数据转发
+class MetricsServer {
+public:
+    explicit MetricsServer(uint16_t port);
+    ~MetricsServer();
+
+    bool start();
+    void stop();
+
+private:
+    struct Connection {
+        std::string request;
+        std::string response;
+        size_t sent = 0;
+    };
+
+    void handleAccept();
+    void handleClient(int fd, uint32_t events);
+    void buildResponse(Connection& conn);
+    void flushResponse(int fd, Connection& conn);
+    void closeClient(int fd);
+
+    const uint16_t _port;
+    int _listenFd = -1;
+    EventLoop _loop;
+    std::unordered_map<int, Connection> _connections;   // 仅在事件循环线程中访问
+};
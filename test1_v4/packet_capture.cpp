@@ -0,0 +1,322 @@
+// packet_capture.cpp
+#include "packet_capture.h"
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// 增强分组块的固定开销：块头(8) + 接口号/时间戳/长度(20) + 块尾长度(4)
+static constexpr size_t kEnhancedPacketOverhead = 32;
+
+static size_t pad4(size_t n) {
+    return (n + 3) & ~static_cast<size_t>(3);
+}
+
+static void appendU16(std::vector<uint8_t>& out, uint16_t v) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(&v);
+    out.insert(out.end(), p, p + sizeof(v));
+}
+
+static void appendU32(std::vector<uint8_t>& out, uint32_t v) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(&v);
+    out.insert(out.end(), p, p + sizeof(v));
+}
+
+static void appendOption(std::vector<uint8_t>& out, uint16_t code, const void* value, size_t len) {
+    appendU16(out, code);
+    appendU16(out, static_cast<uint16_t>(len));
+    const uint8_t* p = static_cast<const uint8_t*>(value);
+    out.insert(out.end(), p, p + len);
+    out.resize(pad4(out.size()), 0);
+}
+
+// 块 = 类型 + 总长度 + 正文 + 总长度
+static void appendBlock(std::vector<uint8_t>& out, uint32_t type, const std::vector<uint8_t>& body) {
+    const uint32_t total = static_cast<uint32_t>(12 + body.size());
+    appendU32(out, type);
+    appendU32(out, total);
+    out.insert(out.end(), body.begin(), body.end());
+    appendU32(out, total);
+}
+
+PacketCapture::PacketCapture(const std::string& dir, const std::string& channel,
+                             size_t segmentBytes, uint32_t segments)
+    : dir_(dir), channel_(channel),
+      segment_bytes_(std::max(segmentBytes > 0 ? segmentBytes : kDefaultSegmentBytes, kMinSegmentBytes)),
+      segments_(segments > 0 ? segments : kDefaultSegments) {}
+
+PacketCapture::~PacketCapture() {
+    close();
+}
+
+uint32_t PacketCapture::addInterface(const std::string& label, uint16_t linkType) {
+    interfaces_.push_back({label, linkType});
+    return static_cast<uint32_t>(interfaces_.size() - 1);
+}
+
+bool PacketCapture::open() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (current_.map != nullptr) return true;
+
+    if (::mkdir(dir_.c_str(), 0755) < 0 && errno != EEXIST) {
+        error_ = "Create capture directory " + dir_ + " failed: " + strerror(errno);
+        return false;
+    }
+    // 第一段直接以最终文件名创建，失败时由调用方决定是否禁用抓包
+    const uint32_t index = firstSegmentIndex();
+    if (!createSegment(segmentPath(index), current_, error_)) return false;
+    segment_index_ = index;
+    header_bytes_ = current_.used;
+
+    stopping_ = false;
+    preparer_ = std::thread([this] { prepareLoop(); });
+    return true;
+}
+
+void PacketCapture::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    prepare_wake_.notify_all();
+    if (preparer_.joinable()) preparer_.join();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    finishSegment(retired_, error_);
+    if (current_is_next_ && ::rename(nextSegmentPath().c_str(), segmentPath(segment_index_).c_str()) == 0) {
+        current_is_next_ = false;
+    }
+    finishSegment(current_, error_);
+    discardNextSegment();
+}
+
+void PacketCapture::write(uint32_t interfaceId, const uint8_t* data, size_t len) {
+    const uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (current_.map == nullptr) {
+        ++dropped_;
+        return;
+    }
+
+    const size_t caplen = std::min(len, segment_bytes_ - header_bytes_ - kEnhancedPacketOverhead);
+    const size_t block = kEnhancedPacketOverhead + pad4(caplen);
+    if (current_.used + block > segment_bytes_) {
+        // 当前段已满：交给后台线程关闭，换上预先创建的下一段（覆盖最旧的段）
+        retired_ = current_;
+        current_ = next_;
+        next_ = Segment();
+        prepare_wake_.notify_one();
+        if (current_.map == nullptr) {
+            // 下一段还没有准备好，后台线程创建成功后恢复写入
+            ++dropped_;
+            return;
+        }
+        segment_index_ = (segment_index_ + 1) % segments_;
+        current_is_next_ = true;
+    }
+
+    const uint32_t header[] = {
+        kPcapngEnhancedPacket,
+        static_cast<uint32_t>(block),
+        interfaceId,
+        static_cast<uint32_t>(ns >> 32),
+        static_cast<uint32_t>(ns),
+        static_cast<uint32_t>(caplen),
+        static_cast<uint32_t>(len),
+    };
+    uint8_t* dst = current_.map + current_.used;
+    std::memcpy(dst, header, sizeof(header));
+    std::memcpy(dst + sizeof(header), data, caplen);
+    std::memset(dst + sizeof(header) + caplen, 0, pad4(caplen) - caplen);
+    const uint32_t trailer = static_cast<uint32_t>(block);
+    std::memcpy(dst + block - sizeof(trailer), &trailer, sizeof(trailer));
+    current_.used += block;
+}
+
+// 后台线程：关闭写满的段、把新的当前段改名为编号文件名、提前创建下一段
+// 文件操作不持锁，写入线程只在交换映射时与本线程竞争 mutex_
+void PacketCapture::prepareLoop() {
+    std::chrono::steady_clock::duration retryDelay = kRetryMinDelay;
+    std::chrono::steady_clock::time_point retryAt{};
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        const bool retryDue = std::chrono::steady_clock::now() >= retryAt;
+        const bool rename = current_is_next_ && retryDue;
+        const bool prepare = !current_is_next_ && next_.map == nullptr && retryDue;
+        if (retired_.map == nullptr && !rename && !prepare) {
+            if (current_is_next_ || next_.map == nullptr) {
+                prepare_wake_.wait_until(lock, retryAt);
+            } else {
+                prepare_wake_.wait(lock);
+            }
+            continue;
+        }
+
+        Segment retired = retired_;
+        retired_ = Segment();
+        const uint32_t index = segment_index_;
+        lock.unlock();
+
+        std::string error;
+        finishSegment(retired, error);
+        // .next 文件仍是当前段时不能重新创建（O_TRUNC 会清空当前段），改名成功后才准备下一段
+        bool renamed = false;
+        if (rename) {
+            renamed = ::rename(nextSegmentPath().c_str(), segmentPath(index).c_str()) == 0;
+            if (!renamed) error = "Rename capture file " + nextSegmentPath() + " failed: " + strerror(errno);
+        }
+        Segment next;
+        const bool created = prepare && createSegment(nextSegmentPath(), next, error);
+
+        lock.lock();
+        if (renamed) current_is_next_ = false;
+        if (renamed || created) retryDelay = kRetryMinDelay;
+        if (created) {
+            if (current_.map == nullptr) {
+                // 滚动时下一段未就绪，写入已暂停：直接作为当前段
+                current_ = next;
+                segment_index_ = (segment_index_ + 1) % segments_;
+                current_is_next_ = true;
+            } else {
+                next_ = next;
+            }
+        }
+        if (!error.empty()) error_ = error;
+        if ((rename && !renamed) || (prepare && !created)) {
+            // 失败（如磁盘已满）后退避重试，期间的记录计入 dropped()
+            retryAt = std::chrono::steady_clock::now() + retryDelay;
+            retryDelay = std::min<std::chrono::steady_clock::duration>(retryDelay * 2, kRetryMaxDelay);
+        }
+    }
+}
+
+uint64_t PacketCapture::dropped() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dropped_;
+}
+
+// 通道名中的路径分隔符替换为 '_'
+std::string PacketCapture::segmentPath(uint32_t index) const {
+    std::string name = channel_;
+    std::replace(name.begin(), name.end(), '/', '_');
+    return dir_ + "/" + name + "." + std::to_string(index) + ".pcapng";
+}
+
+// 从最近写入的段之后开始，保留上次运行的抓包
+uint32_t PacketCapture::firstSegmentIndex() const {
+    uint32_t newest = segments_ - 1;
+    timespec newestTime{};
+    bool found = false;
+    for (uint32_t i = 0; i < segments_; ++i) {
+        struct stat st{};
+        if (::stat(segmentPath(i).c_str(), &st) != 0) continue;
+        if (!found || st.st_mtim.tv_sec > newestTime.tv_sec ||
+            (st.st_mtim.tv_sec == newestTime.tv_sec && st.st_mtim.tv_nsec > newestTime.tv_nsec)) {
+            newest = i;
+            newestTime = st.st_mtim;
+            found = true;
+        }
+    }
+    return (newest + 1) % segments_;
+}
+
+std::string PacketCapture::nextSegmentPath() const {
+    std::string name = channel_;
+    std::replace(name.begin(), name.end(), '/', '_');
+    return dir_ + "/" + name + ".next.pcapng";
+}
+
+// 创建段文件并写入段头；后台线程调用时不持锁（只读取 open() 之后不再修改的成员）
+bool PacketCapture::createSegment(const std::string& path, Segment& segment, std::string& error) {
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        error = "Open capture file " + path + " failed: " + strerror(errno);
+        return false;
+    }
+
+    // 预分配磁盘空间，写入时不再因分配数据块而缺页阻塞；文件系统不支持时退回稀疏文件
+    // 空间不足时不能退回稀疏文件，否则写入映射时收到 SIGBUS
+    const off_t size = static_cast<off_t>(segment_bytes_);
+    const int rc = posix_fallocate(fd, 0, size);
+    if (rc == ENOSPC || (rc != 0 && ftruncate(fd, size) < 0)) {
+        error = "Allocate capture file " + path + " failed: " + strerror(rc == ENOSPC ? rc : errno);
+        ::close(fd);
+        ::unlink(path.c_str());
+        return false;
+    }
+
+    // MAP_POPULATE 预先建立页表，写入线程不再逐页缺页
+    void* map = mmap(nullptr, segment_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    if (map == MAP_FAILED) {
+        error = "Map capture file " + path + " failed: " + strerror(errno);
+        ::close(fd);
+        ::unlink(path.c_str());
+        return false;
+    }
+
+    segment.fd = fd;
+    segment.map = static_cast<uint8_t*>(map);
+    segment.used = writeHeaderBlocks(segment.map);
+    return true;
+}
+
+// 截断预分配的空间，使文件成为完整的 pcapng 文件
+void PacketCapture::finishSegment(Segment& segment, std::string& error) {
+    if (segment.map == nullptr) return;
+
+    munmap(segment.map, segment_bytes_);
+    if (ftruncate(segment.fd, static_cast<off_t>(segment.used)) < 0) {
+        error = "Truncate capture file failed: " + std::string(strerror(errno));
+    }
+    ::close(segment.fd);
+    segment = Segment();
+}
+
+// 调用方持有 mutex_；关闭时删除未使用的下一段
+void PacketCapture::discardNextSegment() {
+    if (next_.map == nullptr) return;
+
+    munmap(next_.map, segment_bytes_);
+    ::close(next_.fd);
+    next_ = Segment();
+    ::unlink(nextSegmentPath().c_str());
+}
+
+// 节头块 + 每个接口的接口描述块
+size_t PacketCapture::writeHeaderBlocks(uint8_t* dst) const {
+    std::vector<uint8_t> out;
+
+    std::vector<uint8_t> shb;
+    appendU32(shb, kPcapngByteOrderMagic);
+    appendU16(shb, 1);                  // 主版本
+    appendU16(shb, 0);                  // 次版本
+    appendU32(shb, 0xFFFFFFFF);         // 节长度未知（-1）
+    appendU32(shb, 0xFFFFFFFF);
+    static const char kUserAppl[] = "protocol_converter";
+    appendOption(shb, kPcapngOptShbUserAppl, kUserAppl, sizeof(kUserAppl) - 1);
+    appendOption(shb, kPcapngOptEnd, nullptr, 0);
+    appendBlock(out, kPcapngSectionHeader, shb);
+
+    for (const auto& iface : interfaces_) {
+        std::vector<uint8_t> idb;
+        appendU16(idb, iface.link_type);
+        appendU16(idb, 0);              // 保留
+        appendU32(idb, 0);              // 抓包长度不限
+        appendOption(idb, kPcapngOptIfName, channel_.data(), channel_.size());
+        appendOption(idb, kPcapngOptIfDescription, iface.label.data(), iface.label.size());
+        const uint8_t tsresol = 9;      // 纳秒
+        appendOption(idb, kPcapngOptIfTsresol, &tsresol, 1);
+        appendOption(idb, kPcapngOptEnd, nullptr, 0);
+        appendBlock(out, kPcapngInterfaceDescription, idb);
+    }
+
+    std::memcpy(dst, out.data(), out.size());
+    return out.size();
+}
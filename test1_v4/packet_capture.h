@@ -0,0 +1,117 @@
+// packet_capture.h
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+
+// 通道数据抓包：把收发的原始数据写入 pcapng 文件，代替逐字节格式化的十六进制/文本日志
+// 可用 Wireshark 打开，或用 capture_decode 还原为原来的日志格式
+//
+// 文件布局（标准 pcapng，小端）：节头块 + 每个接口一个接口描述块 + 每条数据一个增强分组块
+//   接口 = 通道的一个数据方向：if_name 为通道名，if_description 为方向标签（如 "[NODE1 RECV]"），
+//   时间戳精度为纳秒（if_tsresol = 9）
+//   链路类型区分日志格式：kLinkTypeReceived（原十六进制日志）/ kLinkTypeForwarded（原文本日志）
+//
+// 文件分段滚动：<dir>/<channel>.<n>.pcapng，n = 0..segments-1 循环覆盖最旧的段
+// 每段创建时预分配并整体映射到内存，写入只是内存拷贝；段写满或关闭时截断到实际长度
+// 进程崩溃时段尾会留下未写入的零字节，capture_decode 读到零块即停止
+//
+// 段的创建和关闭由后台线程完成，写入线程滚动时只交换映射：
+//   下一段提前创建为 <dir>/<channel>.next.pcapng，成为当前段后再改名为 <channel>.<n>.pcapng（覆盖最旧的段）
+//   下一段尚未就绪（如磁盘已满）时丢弃记录，后台线程按退避间隔重试，成功后恢复写入
+
+constexpr uint16_t kLinkTypeReceived = 147;    // LINKTYPE_USER0：源端点收到的数据
+constexpr uint16_t kLinkTypeForwarded = 148;   // LINKTYPE_USER1：已转发到目标端点的数据
+
+// pcapng 块类型
+constexpr uint32_t kPcapngSectionHeader = 0x0A0D0D0A;
+constexpr uint32_t kPcapngInterfaceDescription = 0x00000001;
+constexpr uint32_t kPcapngEnhancedPacket = 0x00000006;
+constexpr uint32_t kPcapngByteOrderMagic = 0x1A2B3C4D;
+
+// pcapng 选项代码
+constexpr uint16_t kPcapngOptEnd = 0;
+constexpr uint16_t kPcapngOptIfName = 2;
+constexpr uint16_t kPcapngOptIfDescription = 3;
+constexpr uint16_t kPcapngOptIfTsresol = 9;
+constexpr uint16_t kPcapngOptShbUserAppl = 4;
+
+class PacketCapture {
+public:
+    static constexpr size_t kDefaultSegmentBytes = 64 * 1024 * 1024;
+    static constexpr size_t kMinSegmentBytes = 1024 * 1024;
+    static constexpr uint32_t kDefaultSegments = 4;
+
+    // segmentBytes / segments 为 0 时使用默认值
+    PacketCapture(const std::string& dir, const std::string& channel,
+                  size_t segmentBytes = 0, uint32_t segments = 0);
+    ~PacketCapture();
+
+    PacketCapture(const PacketCapture&) = delete;
+    PacketCapture& operator=(const PacketCapture&) = delete;
+
+    // 在 open() 之前登记接口，返回接口编号
+    uint32_t addInterface(const std::string& label, uint16_t linkType);
+
+    // 创建第一个段，失败时返回 false 并通过 lastError() 说明原因
+    bool open();
+    void close();
+
+    // 写入一条数据（多个线程可同时调用），len 超过段容量时截断
+    void write(uint32_t interfaceId, const uint8_t* data, size_t len);
+
+    // 因段无法创建而丢弃的记录数
+    uint64_t dropped() const;
+    // open() 失败的原因（后台线程创建段失败时同样记录在此，需在 close() 之后读取）
+    const std::string& lastError() const { return error_; }
+
+private:
+    static constexpr std::chrono::seconds kRetryMinDelay{1};
+    static constexpr std::chrono::seconds kRetryMaxDelay{60};
+
+    struct Interface {
+        std::string label;
+        uint16_t link_type;
+    };
+
+    // 一个已映射的段文件
+    struct Segment {
+        int fd = -1;
+        uint8_t* map = nullptr;     // nullptr 表示没有段
+        size_t used = 0;            // 已写入的字节数
+    };
+
+    bool createSegment(const std::string& path, Segment& segment, std::string& error);
+    void finishSegment(Segment& segment, std::string& error);
+    void discardNextSegment();
+    size_t writeHeaderBlocks(uint8_t* dst) const;
+    std::string segmentPath(uint32_t index) const;
+    std::string nextSegmentPath() const;
+    uint32_t firstSegmentIndex() const;
+    void prepareLoop();
+
+    const std::string dir_;
+    const std::string channel_;
+    const size_t segment_bytes_;
+    const uint32_t segments_;
+    std::vector<Interface> interfaces_;
+
+    mutable std::mutex mutex_;           // 保护以下状态（写入只做内存拷贝，持锁时间很短）
+    Segment current_;
+    Segment next_;                       // 后台线程准备好的下一段（仍为 .next 文件名）
+    Segment retired_;                    // 已写满、等待后台线程截断并关闭的段
+    bool current_is_next_ = false;       // 当前段尚未从 .next 改名
+    size_t header_bytes_ = 0;            // 段头（节头块 + 接口描述块）的长度
+    uint32_t segment_index_ = 0;
+    uint64_t dropped_ = 0;
+    std::string error_;
+
+    std::thread preparer_;
+    std::condition_variable prepare_wake_;
+    bool stopping_ = false;
+};
@@ -4,7 +4,12 @@
 #include "tcp_client_endpoint.h"
 #include "udp_server_endpoint.h"
 #include "udp_client_endpoint.h"
+#include "udp_multicast_endpoint.h"
 #include "serial_endpoint.h"
+#include "shm_endpoint.h"
+#include "unix_server_endpoint.h"
+#include "unix_client_endpoint.h"
+#include "unix_socket.h"
 #include "logrecord.h"
 #include <iostream>
 #include <iomanip>
@@ -12,39 +17,105 @@
 #include <memory>
 #include <atomic>
 #include <array>
+#include <algorithm>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/timerfd.h>
+#include <chrono>
+
+// 单次转发的最大字节数（需小于UDP数据报上限）
+static constexpr size_t kForwardBatchSize = 32 * 1024;
+// 端点单次读取的最大字节数（用于为高水位预留余量，含记录头）
+static constexpr size_t kMaxReadSize = 64 * 1024 + 2 * RingBuffer::kRecordHeaderSize;
+// 记录模式下单批转发的最大记录数
+static constexpr size_t kMaxRecordBatch = 64;
+// splice 管道容量（每个方向一个管道）
+static constexpr int kSplicePipeSize = 256 * 1024;
+// 吞吐优先模式的默认合并字节阈值与时间窗口
+static constexpr size_t kDefaultCoalesceBytes = 16 * 1024;
+static constexpr uint32_t kDefaultCoalesceUsec = 1000;
+
+static int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 
 std::unique_ptr<Endpoint> ProtocolChannel::createEndpoint(const EndpointConfig& config) {
     if (config.type == "tcp_server") {
-        return std::make_unique<TcpServerEndpoint>(config.port);
+        return std::make_unique<TcpServerEndpoint>(
+            config.port, TcpServerEndpoint::parsePolicy(config.slow_client_policy), config.send_queue_bytes,
+            config.accept_shards, static_cast<int>(config.listen_backlog));
     }
     else if (config.type == "tcp_client") {
-        return std::make_unique<TcpClientEndpoint>(config.ip, config.port);
+        return std::make_unique<TcpClientEndpoint>(config.ip, config.port,
+                                                   config.reconnect_min_ms, config.reconnect_max_ms);
     }
     else if (config.type == "udp_server") {
-        return std::make_unique<UdpServerEndpoint>(config.port);
+        return std::make_unique<UdpServerEndpoint>(config.port, config.recv_batch, config.recv_slot_bytes,
+                                                   config.peer_expiry_sec);
     }
     else if (config.type == "udp_client") {
-        return std::make_unique<UdpClientEndpoint>(config.ip, config.port);
+        return std::make_unique<UdpClientEndpoint>(config.ip, config.port,
+                                                   config.recv_batch, config.recv_slot_bytes);
     }
     else if (config.type == "serial") {
-        return std::make_unique<SerialEndpoint>(config.serial_port, config.baud_rate);
+        SerialFraming framing;
+        framing.gapChars = config.frame_gap_chars;
+        framing.maxBytes = config.frame_max_bytes;
+        framing.delimiter = config.frame_delimiter;
+        if (framing.delimiter > 0xFF) {
+            throw std::runtime_error("Invalid frame_delimiter: " + std::to_string(framing.delimiter));
+        }
+        SerialLine line;
+        if (config.serial_data_bits > 0) line.dataBits = static_cast<int>(config.serial_data_bits);
+        if (config.serial_stop_bits > 0) line.stopBits = static_cast<int>(config.serial_stop_bits);
+        line.parity = parseSerialParity(config.serial_parity);
+        line.rtsCts = config.serial_rtscts;
+        line.lowLatency = config.serial_low_latency;
+        if (line.dataBits < 5 || line.dataBits > 8 || line.stopBits > 2) {
+            throw std::runtime_error("Invalid serial line settings: " + std::to_string(line.dataBits) +
+                                     " data bits, " + std::to_string(line.stopBits) + " stop bits");
+        }
+        return std::make_unique<SerialEndpoint>(config.serial_port, config.baud_rate, framing, line);
+    }
+    else if (config.type == "shm") {
+        return std::make_unique<ShmEndpoint>(config.shm_name, config.shm_capacity);
+    }
+    else if (config.type == "udp_multicast_send" || config.type == "udp_multicast_recv") {
+        const auto role = config.type == "udp_multicast_send" ? UdpMulticastEndpoint::Role::Send
+                                                              : UdpMulticastEndpoint::Role::Receive;
+        return std::make_unique<UdpMulticastEndpoint>(
+            role, config.ip, config.port, config.multicast_interface,
+            static_cast<uint8_t>(std::min<uint32_t>(config.multicast_ttl, 255)), config.multicast_loopback,
+            config.recv_batch, config.recv_slot_bytes);
+    }
+    else if (config.type == "unix_server") {
+        return std::make_unique<UnixServerEndpoint>(
+            config.unix_path, parseUnixSocketType(config.unix_mode),
+            TcpServerEndpoint::parsePolicy(config.slow_client_policy), config.send_queue_bytes,
+            static_cast<int>(config.listen_backlog));
+    }
+    else if (config.type == "unix_client") {
+        return std::make_unique<UnixClientEndpoint>(config.unix_path, parseUnixSocketType(config.unix_mode),
+                                                    config.reconnect_min_ms, config.reconnect_max_ms);
     }
     
     throw std::runtime_error("Unknown endpoint type: " + config.type);
 }
 
-ProtocolChannel::ProtocolChannel(const std::string& name,
-                               const EndpointConfig& node1_config,
-                               const EndpointConfig& node2_config,
-                               ThreadPool& thread_pool): name_(name), thread_pool_(thread_pool),
-    forwarding_task_active_{{ATOMIC_FLAG_INIT, ATOMIC_FLAG_INIT}} {
+ProtocolChannel::ProtocolChannel(const ChannelConfig& config, ThreadPool& thread_pool)
+    : name_(config.name), input_type_(config.input.type), output_type_(config.output.type),
+      thread_pool_(thread_pool) {
     
     CH_LOG_INFO(name_, "Creating channel %s", name_.c_str());
-    CH_LOG_INFO(name_, "Input: %s, Output: %s", node1_config.type.c_str(), node2_config.type.c_str());
+    CH_LOG_INFO(name_, "Input: %s, Output: %s", config.input.type.c_str(), config.output.type.c_str());
     
     try {
-        node1_ = createEndpoint(node1_config);
-        node2_ = createEndpoint(node2_config);
+        node1_ = createEndpoint(config.input);
+        node2_ = createEndpoint(config.output);
+        node1_->setSocketOptions(config.input.socket);
+        node2_->setSocketOptions(config.output.socket);
     } catch (const std::exception& e) {
         CH_LOG_ERROR(name_, "Endpoint creation failed: %s", e.what());
         throw;
@@ -69,121 +140,612 @@ ProtocolChannel::ProtocolChannel(const std::string& name,
     
     node1_->setErrorCallback(make_error_callback("NODE1"));
     node2_->setErrorCallback(make_error_callback("NODE2"));
+
+    // 任一端为数据报端点时使用记录模式，保持消息边界
+    framed_ = node1_->isDatagram() || node2_->isDatagram();
+    if (framed_) {
+        CH_LOG_INFO(name_, "Datagram endpoint detected, using framed buffers");
+    }
+
+    // 两端均为TCP：socket之间通过 splice() 经管道直接转发，数据不进入用户空间
+    if (node1_->supportsSplice() && node2_->supportsSplice() && createSplicePipes()) {
+        splice_ = true;
+        log_binary_ = false;
+        CH_LOG_INFO(name_, "TCP splice fast path enabled, binary logging disabled");
+    }
+
+    // 流控水位：高水位需为单次读取留出余量，保证暂停前的最后一次写入不会被丢弃
+    const size_t capacity = directions_[0].buffer.capacity();
+    flow_control_ = config.flow_control;
+    high_watermark_ = config.high_watermark ? config.high_watermark : capacity * 3 / 4;
+    low_watermark_ = config.low_watermark ? config.low_watermark : capacity / 4;
+    if (high_watermark_ > capacity - kMaxReadSize) {
+        high_watermark_ = capacity - kMaxReadSize;
+    }
+    if (low_watermark_ >= high_watermark_) {
+        low_watermark_ = high_watermark_ / 2;
+    }
+    if (flow_control_) {
+        CH_LOG_INFO(name_, "Flow control enabled: high watermark %zu bytes, low watermark %zu bytes",
+                    high_watermark_, low_watermark_);
+    }
+
+    // 输出合并：字节阈值不超过高水位，保证流控暂停读取后窗口仍能按阈值触发
+    if (config.coalesce_mode == "throughput") {
+        coalesce_ = true;
+        coalesce_bytes_ = config.coalesce_bytes ? config.coalesce_bytes : kDefaultCoalesceBytes;
+        coalesce_usec_ = config.coalesce_usec ? config.coalesce_usec : kDefaultCoalesceUsec;
+        if (coalesce_bytes_ > high_watermark_) {
+            coalesce_bytes_ = high_watermark_;
+        }
+        CH_LOG_INFO(name_, "Output coalescing enabled: %zu bytes or %u us",
+                    coalesce_bytes_, coalesce_usec_);
+    } else if (config.coalesce_mode != "latency") {
+        throw std::runtime_error("Unknown coalesce mode: " + config.coalesce_mode);
+    }
     
     // 设置数据转发
     setupForwarding();
+
+    if (log_binary_ && !config.capture_dir.empty()) {
+        setupCapture(config);
+    }
+}
+
+// 二进制数据写入抓包文件（每个方向的收到/转发各一个接口），创建失败时退回十六进制/文本日志
+void ProtocolChannel::setupCapture(const ChannelConfig& config) {
+    capture_ = std::make_unique<PacketCapture>(config.capture_dir, name_,
+                                               config.capture_segment_bytes, config.capture_segments);
+    for (auto& dir : directions_) {
+        dir.capture_recv_if = capture_->addInterface(dir.recv_label, kLinkTypeReceived);
+        dir.capture_sent_if = capture_->addInterface(dir.label, kLinkTypeForwarded);
+    }
+    if (!capture_->open()) {
+        CH_LOG_ERROR(name_, "Packet capture disabled: %s", capture_->lastError().c_str());
+        capture_.reset();
+        return;
+    }
+    CH_LOG_INFO(name_, "Packet capture enabled in %s", config.capture_dir.c_str());
 }
 
 void ProtocolChannel::setupForwarding() {
+    Direction& forward = directions_[0];
+    forward.source = node1_.get();
+    forward.target = node2_.get();
+    forward.recv_label = "[NODE1 RECV]";
+    forward.label = "[NODE1->NODE2]";
+
+    Direction& backward = directions_[1];
+    backward.source = node2_.get();
+    backward.target = node1_.get();
+    backward.recv_label = "[NODE2 RECV]";
+    backward.label = "[NODE2->NODE1]";
+
     // Node1 -> Node2 数据回调
     node1_->setDataCallback([this](const uint8_t* data, size_t len) {
-        LOG_BINARY(name_, "[NODE1 RECV]", data, len);
-        
-        if (!node1_to_node2_buffer_.push(data, len)) {
-            CH_LOG_WARNING(name_, "NODE1_TO_NODE2 buffer full, dropped %zu bytes", len);
-            return;
-        }
-        
-        // 提交转发任务（如果尚未提交）
-        if (!forwarding_task_active_[0].test_and_set(std::memory_order_acq_rel)) {
-            thread_pool_.enqueue([this] {
-                forwardDataTask(node1_to_node2_buffer_, *node2_, "[NODE1->NODE2]", 0);
-            });
-        }
+        onSourceData(directions_[0], data, len);
     });
     
     // Node2 -> Node1 数据回调
     node2_->setDataCallback([this](const uint8_t* data, size_t len) {
-        LOG_BINARY(name_, "[NODE2 RECV]", data, len);
-        
-        if (!node2_to_node1_buffer_.push(data, len)) {
-            CH_LOG_WARNING(name_, "NODE2_TO_NODE1 buffer full, dropped %zu bytes", len);
-            return;
-        }
-        
-        if (!forwarding_task_active_[1].test_and_set(std::memory_order_acq_rel)) {
-            thread_pool_.enqueue([this] {
-                forwardDataTask(node2_to_node1_buffer_, *node1_, "[NODE2->NODE1]", 1);
-            });
+        onSourceData(directions_[1], data, len);
+    });
+
+    // 批量接收（UDP端点）：整批写入缓冲区后调度一次转发
+    node1_->setBatchCallback([this](const iovec* msgs, size_t count) {
+        onSourceBatch(directions_[0], msgs, count);
+    });
+    node2_->setBatchCallback([this](const iovec* msgs, size_t count) {
+        onSourceBatch(directions_[1], msgs, count);
+    });
+
+    if (splice_) {
+        node1_->setSpliceCallback([this](int fd) { return spliceForward(directions_[0], fd); });
+        node2_->setSpliceCallback([this](int fd) { return spliceForward(directions_[1], fd); });
+    }
+}
+
+void ProtocolChannel::onSourceData(Direction& dir, const uint8_t* data, size_t len) {
+    if (pushSourceData(dir, data, len)) {
+        markOldest(dir);
+    }
+    afterSourceData(dir);
+}
+
+void ProtocolChannel::onSourceBatch(Direction& dir, const iovec* msgs, size_t count) {
+    // 整批写入后只做一次水位检查和任务调度
+    bool pushed = false;
+    for (size_t i = 0; i < count; ++i) {
+        pushed |= pushSourceData(dir, static_cast<const uint8_t*>(msgs[i].iov_base), msgs[i].iov_len);
+    }
+    if (pushed) {
+        markOldest(dir);
+    }
+    afterSourceData(dir);
+}
+
+bool ProtocolChannel::pushSourceData(Direction& dir, const uint8_t* data, size_t len) {
+    if (log_binary_) {
+        if (capture_) {
+            capture_->write(dir.capture_recv_if, data, len);
+        } else {
+            LOG_BINARY(name_, dir.recv_label, data, len);
+        }
+    }
+    dir.metrics.bytes_in.add(len);
+    dir.metrics.packets_in.add();
+    
+    const bool pushed = framed_ ? dir.buffer.pushRecord(data, len) : dir.buffer.push(data, len);
+    if (!pushed) {
+        dir.metrics.dropped_packets.add();
+        dir.metrics.dropped_bytes.add(len);
+        CH_LOG_WARNING(name_, "%s buffer full, dropped %zu bytes", dir.label.c_str(), len);
+    }
+    return pushed;
+}
+
+void ProtocolChannel::markOldest(Direction& dir) {
+    if (dir.oldest_ns.load(std::memory_order_relaxed) == 0) {
+        // 记录当前待转发数据中最早一批的接收时间
+        int64_t expected = 0;
+        dir.oldest_ns.compare_exchange_strong(expected, nowNs(), std::memory_order_relaxed);
+    }
+}
+
+void ProtocolChannel::afterSourceData(Direction& dir) {
+    const size_t depth = dir.buffer.size();
+    dir.metrics.depth_high.update(depth);
+
+    // 超过高水位：停止读取源端点，由TCP窗口/串口缓冲区向发送方反压
+    if (flow_control_ && !dir.read_paused.load(std::memory_order_acquire) &&
+        depth >= high_watermark_) {
+        dir.read_paused.store(true, std::memory_order_release);
+        dir.source->pauseReading();
+        CH_LOG_INFO(name_, "%s buffer reached high watermark, pause reading", dir.label.c_str());
+    }
+
+    // 吞吐优先：未达到字节阈值时等待合并窗口到期
+    if (coalesce_ && depth < coalesce_bytes_) {
+        openCoalesceWindow(dir);
+        return;
+    }
+    
+    // 提交转发任务（如果尚未提交）
+    scheduleForward(dir);
+}
+
+void ProtocolChannel::openCoalesceWindow(Direction& dir) {
+    // 只有打开窗口的一方启动定时器，窗口内后续数据不再产生系统调用
+    if (dir.window_open.exchange(true, std::memory_order_acq_rel)) return;
+
+    itimerspec spec{};
+    spec.it_value.tv_sec = coalesce_usec_ / 1000000;
+    spec.it_value.tv_nsec = static_cast<long>(coalesce_usec_ % 1000000) * 1000;
+    if (timerfd_settime(dir.timer_fd, 0, &spec, nullptr) < 0) {
+        CH_LOG_ERROR(name_, "%s timerfd settime failed: %s", dir.label.c_str(), strerror(errno));
+        scheduleForward(dir);
+    }
+}
+
+bool ProtocolChannel::startCoalesceTimers() {
+    timer_loop_ = Reactor::getInstance().nextLoop();
+    for (auto& dir : directions_) {
+        dir.timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (dir.timer_fd < 0) {
+            CH_LOG_ERROR(name_, "Timerfd creation failed: %s", strerror(errno));
+            return false;
+        }
+
+        Direction* d = &dir;
+        const bool added = timer_loop_->add(dir.timer_fd, EPOLLIN, [this, d](uint32_t) {
+            uint64_t expirations;
+            ssize_t n = ::read(d->timer_fd, &expirations, sizeof(expirations));
+            (void)n;
+            scheduleForward(*d);
+        });
+        if (!added) {
+            CH_LOG_ERROR(name_, "Epoll_ctl failed: %s", strerror(errno));
+            ::close(dir.timer_fd);
+            dir.timer_fd = -1;
+            return false;
+        }
+    }
+    return true;
+}
+
+void ProtocolChannel::stopCoalesceTimers() {
+    if (!timer_loop_) return;
+
+    // 在事件循环线程中注销，返回后不会再有定时器回调
+    timer_loop_->runSync([this] {
+        for (auto& dir : directions_) {
+            if (dir.timer_fd >= 0) {
+                timer_loop_->remove(dir.timer_fd);
+            }
+        }
+    });
+    for (auto& dir : directions_) {
+        if (dir.timer_fd >= 0) {
+            ::close(dir.timer_fd);
+            dir.timer_fd = -1;
+        }
+        dir.window_open.store(false, std::memory_order_release);
+    }
+    timer_loop_ = nullptr;
+}
+
+void ProtocolChannel::scheduleForward(Direction& dir) {
+    // 目标端点输出阻塞时由可写回调重新调度
+    if (dir.waiting_writable.load(std::memory_order_acquire)) return;
+
+    if (!dir.task_active.test_and_set(std::memory_order_acq_rel)) {
+        tasks_inflight_.fetch_add(1, std::memory_order_relaxed);
+        thread_pool_.enqueue([this, &dir] {
+            forwardDataTask(dir);
+            // 最后一次访问通道对象，之后通道可以被销毁
+            tasks_inflight_.fetch_sub(1, std::memory_order_release);
+        });
+    }
+}
+
+void ProtocolChannel::logForwarded(Direction& dir, const iovec* iov, int iovcnt, size_t sent) {
+    if (!log_binary_) return;
+    for (int i = 0; i < iovcnt && sent > 0; ++i) {
+        const size_t n = std::min(sent, iov[i].iov_len);
+        if (capture_) {
+            capture_->write(dir.capture_sent_if, static_cast<const uint8_t*>(iov[i].iov_base), n);
+        } else {
+            LOG_BINARY_TEXT(name_, dir.label, static_cast<const uint8_t*>(iov[i].iov_base), n);
+        }
+        sent -= n;
+    }
+}
+
+bool ProtocolChannel::createSplicePipes() {
+    for (auto& dir : directions_) {
+        if (pipe2(dir.pipe_fds, O_NONBLOCK | O_CLOEXEC) < 0) {
+            CH_LOG_ERROR(name_, "Pipe creation failed: %s", strerror(errno));
+            closeSplicePipes();
+            return false;
+        }
+        // 扩大管道容量以减少系统调用次数（失败时使用默认容量）
+        fcntl(dir.pipe_fds[1], F_SETPIPE_SZ, kSplicePipeSize);
+        const int capacity = fcntl(dir.pipe_fds[1], F_GETPIPE_SZ);
+        dir.pipe_capacity = capacity > 0 ? static_cast<size_t>(capacity) : 65536;
+    }
+    return true;
+}
+
+void ProtocolChannel::closeSplicePipes() {
+    for (auto& dir : directions_) {
+        for (int& fd : dir.pipe_fds) {
+            if (fd >= 0) {
+                ::close(fd);
+                fd = -1;
+            }
+        }
+        dir.pipe_bytes = 0;
+    }
+}
+
+// 在源端点的事件循环线程中调用
+Endpoint::SpliceResult ProtocolChannel::spliceForward(Direction& dir, int fd) {
+    // 缓冲区中仍有普通路径的数据时不使用 splice，保证数据顺序
+    if (!splice_.load(std::memory_order_relaxed) || !dir.buffer.empty() || !dir.target->canSpliceTo()) {
+        return Endpoint::SpliceResult::NotHandled;
+    }
+
+    ssize_t n = splice(fd, nullptr, dir.pipe_fds[1], nullptr, dir.pipe_capacity,
+                       SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    if (n == 0) {
+        return Endpoint::SpliceResult::Closed;
+    }
+    if (n < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return Endpoint::SpliceResult::Handled;
+        }
+        if (errno == ECONNRESET || errno == ENOTCONN || errno == EPIPE) {
+            return Endpoint::SpliceResult::Closed;
+        }
+        CH_LOG_ERROR(name_, "%s splice failed: %s, fall back to buffered forwarding",
+                     dir.label.c_str(), strerror(errno));
+        splice_.store(false, std::memory_order_relaxed);
+        return Endpoint::SpliceResult::NotHandled;
+    }
+
+    dir.metrics.bytes_in.add(n);
+    dir.metrics.packets_in.add();
+    dir.pipe_bytes = n;
+    if (!drainPipe(dir)) {
+        // 目标输出阻塞：暂停读取源端点，目标可写后继续写出管道中的数据
+        dir.source->pauseReading();
+        waitSpliceWritable(dir);
+    }
+    return Endpoint::SpliceResult::Handled;
+}
+
+bool ProtocolChannel::drainPipe(Direction& dir) {
+    while (dir.pipe_bytes > 0) {
+        ssize_t n = dir.target->spliceFrom(dir.pipe_fds[0], dir.pipe_bytes);
+        if (n > 0) {
+            dir.pipe_bytes -= n;
+            dir.metrics.bytes_out.add(n);
+            dir.metrics.packets_out.add();
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return false;
+        }
+
+        // 目标不可写（连接断开或客户端数量变化）：丢弃管道中的数据
+        CH_LOG_WARNING(name_, "%s splice target unavailable, dropped %zu bytes",
+                       dir.label.c_str(), dir.pipe_bytes);
+        dir.metrics.dropped_packets.add();
+        dir.metrics.dropped_bytes.add(dir.pipe_bytes);
+        discardPipe(dir);
+    }
+    return true;
+}
+
+void ProtocolChannel::discardPipe(Direction& dir) {
+    uint8_t scratch[4096];
+    while (dir.pipe_bytes > 0) {
+        ssize_t n = ::read(dir.pipe_fds[0], scratch, std::min(sizeof(scratch), dir.pipe_bytes));
+        if (n <= 0) break;
+        dir.pipe_bytes -= n;
+    }
+    dir.pipe_bytes = 0;
+}
+
+void ProtocolChannel::waitSpliceWritable(Direction& dir) {
+    dir.target->notifyWhenWritable([this, &dir] {
+        if (drainPipe(dir)) {
+            dir.source->resumeReading();
+        } else {
+            waitSpliceWritable(dir);
         }
     });
 }
 
-void ProtocolChannel::forwardDataTask(RingBuffer& source, Endpoint& target, 
-                                    const std::string& direction, int index) {
+bool ProtocolChannel::forwardStream(Direction& dir, size_t& forwarded) {
+    iovec spans[2];
+    int count;
+
+    // 处理当前所有可用数据：直接从环形缓冲区发送（回绕时为两段），避免中间拷贝
+    while ((count = dir.buffer.peek(spans, kForwardBatchSize)) > 0) {
+        const size_t len = spans[0].iov_len + (count > 1 ? spans[1].iov_len : 0);
+
+        // 只确认目标实际接受的部分，其余留在缓冲区中等待目标可写
+        const size_t sent = dir.target->writev(spans, count);
+        logForwarded(dir, spans, count, sent);
+        dir.buffer.commit(sent);
+        if (sent > 0) {
+            dir.metrics.bytes_out.add(sent);
+            dir.metrics.packets_out.add();
+            forwarded += sent;
+        }
+
+        if (sent < len) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ProtocolChannel::forwardRecords(Direction& dir, size_t& forwarded) {
+    RingRecord records[kMaxRecordBatch];
+    size_t count;
+
+    while ((count = dir.buffer.peekRecords(records, kMaxRecordBatch, kForwardBatchSize)) > 0) {
+        if (dir.target->isDatagram()) {
+            // 数据报目标：每条记录一个数据报，整批提交
+            mmsghdr msgs[kMaxRecordBatch];
+            for (size_t i = 0; i < count; ++i) {
+                msgs[i] = mmsghdr{};
+                msgs[i].msg_hdr.msg_iov = records[i].spans;
+                msgs[i].msg_hdr.msg_iovlen = records[i].count;
+            }
+
+            const size_t accepted = dir.target->writeDatagrams(msgs, count);
+            size_t bytes = 0;
+            for (size_t i = 0; i < accepted; ++i) {
+                logForwarded(dir, records[i].spans, records[i].count, records[i].size);
+                bytes += records[i].size;
+            }
+            dir.buffer.commitRecords(records, accepted);
+            if (accepted > 0) {
+                dir.metrics.bytes_out.add(bytes);
+                dir.metrics.packets_out.add(accepted);
+                forwarded += bytes;
+            }
+
+            if (accepted < count) {
+                return true;
+            }
+            continue;
+        }
+
+        // 流式目标：按顺序拼接记录，record_offset 为首条记录已发送的字节数
+        iovec iov[kMaxRecordBatch * 2];
+        int iovcnt = 0;
+        size_t len = 0;
+        size_t skip = dir.record_offset;
+        for (size_t i = 0; i < count; ++i) {
+            for (int j = 0; j < records[i].count; ++j) {
+                iovec span = records[i].spans[j];
+                if (skip >= span.iov_len) {
+                    skip -= span.iov_len;
+                    continue;
+                }
+                span.iov_base = static_cast<uint8_t*>(span.iov_base) + skip;
+                span.iov_len -= skip;
+                skip = 0;
+                iov[iovcnt++] = span;
+                len += span.iov_len;
+            }
+        }
+
+        const size_t sent = len > 0 ? dir.target->writev(iov, iovcnt) : 0;
+        logForwarded(dir, iov, iovcnt, sent);
+
+        // 换算为完整发送的记录数，剩余部分记入 record_offset
+        size_t consumed = 0;
+        size_t remaining = dir.record_offset + sent;
+        while (consumed < count && remaining >= records[consumed].size) {
+            remaining -= records[consumed].size;
+            ++consumed;
+        }
+        dir.record_offset = remaining;
+        dir.buffer.commitRecords(records, consumed);
+        if (sent > 0) {
+            dir.metrics.bytes_out.add(sent);
+            dir.metrics.packets_out.add();
+            forwarded += sent;
+        }
+
+        if (sent < len) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ProtocolChannel::forwardDataTask(Direction& dir) {
+    bool blocked = false;
+    // 本次转发覆盖当前窗口内的全部数据，之后到达的数据开启新窗口
+    dir.window_open.store(false, std::memory_order_release);
+    // 需要多次写入时加塞，避免各次写入的尾部产生未满的报文段
+    const bool corked = coalesce_ && dir.buffer.size() > kForwardBatchSize;
+    // 取走最早数据的接收时间，转发后计入延迟直方图
+    const int64_t since = dir.oldest_ns.exchange(0, std::memory_order_relaxed);
+    size_t forwarded = 0;
     try {
-        uint8_t buffer[4096];
-        size_t total_forwarded = 0;
-        size_t len;
-        
-        // 处理当前所有可用数据
-        while ((len = source.pop(buffer, sizeof(buffer)))) {
-            LOG_BINARY_TEXT(name_, direction, buffer, len);
-            target.write(buffer, len);
-            total_forwarded += len;
-        }
-        
-        // if (total_forwarded > 0) {
-        //     CH_LOG_DEBUG(name_, "%s forwarded %zu bytes", direction.c_str(), total_forwarded);
-        // }
+        if (corked) dir.target->setCorked(true);
+        blocked = framed_ ? forwardRecords(dir, forwarded) : forwardStream(dir, forwarded);
     } 
     catch (const std::runtime_error& e) {
-        CH_LOG_ERROR(name_, "%s forwarding error: %s", direction.c_str(), e.what());
+        CH_LOG_ERROR(name_, "%s forwarding error: %s", dir.label.c_str(), e.what());
     } 
     catch (const std::exception& e) {
-        CH_LOG_ERROR(name_, "%s unexpected error: %s", direction.c_str(), e.what());
+        CH_LOG_ERROR(name_, "%s unexpected error: %s", dir.label.c_str(), e.what());
+    }
+    if (corked) dir.target->setCorked(false);
+
+    if (since != 0) {
+        if (forwarded > 0) {
+            dir.metrics.latency.record(static_cast<uint64_t>(nowNs() - since));
+        }
+        if (blocked) {
+            // 剩余数据不晚于该时间到达，留给下一次转发计算
+            dir.oldest_ns.store(since, std::memory_order_relaxed);
+        }
+    }
+
+    // 降到低水位：恢复读取源端点（在源端点事件循环线程中执行，与暂停操作串行）
+    if (dir.read_paused.load(std::memory_order_acquire) && dir.buffer.size() <= low_watermark_) {
+        bool expected = true;
+        if (dir.read_paused.compare_exchange_strong(expected, false, std::memory_order_acq_rel)) {
+            dir.source->resumeReading();
+            CH_LOG_INFO(name_, "%s buffer drained to low watermark, resume reading", dir.label.c_str());
+        }
+    }
+
+    if (blocked) {
+        // 目标输出阻塞：等待可写后重新调度，期间新数据只入缓冲区
+        dir.waiting_writable.store(true, std::memory_order_release);
+        dir.task_active.clear(std::memory_order_release);
+        dir.target->notifyWhenWritable([this, &dir] {
+            dir.waiting_writable.store(false, std::memory_order_release);
+            scheduleForward(dir);
+        });
+        return;
     }
     
     // 标记任务完成
-    forwarding_task_active_[index].clear(std::memory_order_release);
+    dir.task_active.clear(std::memory_order_release);
     
-    // 检查是否有新数据到达，需要重新提交任务
-    if (!source.empty()) {
-        if (forwarding_task_active_[index].test_and_set(std::memory_order_acq_rel)) {
-            // 已经有任务在运行（可能是新数据触发的）
-            return;
+    // 检查是否有新数据到达，需要重新提交任务（吞吐优先模式下不足阈值时等待窗口到期）
+    if (running_ && !dir.buffer.empty()) {
+        if (coalesce_ && dir.buffer.size() < coalesce_bytes_) {
+            openCoalesceWindow(dir);
+        } else {
+            scheduleForward(dir);
         }
-        thread_pool_.enqueue([this, index, &source, &target, direction] {
-            forwardDataTask(source, target, direction, index);
-        });
     }
 }
 
+ChannelSnapshot ProtocolChannel::snapshot() const {
+    static const char* const kDirectionNames[] = {"node1_to_node2", "node2_to_node1"};
+
+    ChannelSnapshot snap;
+    snap.channel = name_;
+    for (size_t i = 0; i < directions_.size(); ++i) {
+        const Direction& dir = directions_[i];
+        DirectionSnapshot d;
+        d.direction = kDirectionNames[i];
+        d.bytes_in = dir.metrics.bytes_in.value();
+        d.packets_in = dir.metrics.packets_in.value();
+        d.bytes_out = dir.metrics.bytes_out.value();
+        d.packets_out = dir.metrics.packets_out.value();
+        d.dropped_packets = dir.metrics.dropped_packets.value();
+        d.dropped_bytes = dir.metrics.dropped_bytes.value();
+        d.depth = dir.buffer.size();
+        d.depth_high = dir.metrics.depth_high.value();
+        d.latency = dir.metrics.latency.snapshot();
+        snap.directions.push_back(std::move(d));
+    }
+    snap.endpoints.push_back({"node1", input_type_, node1_->writeErrors(), node1_->reconnects(),
+                              node1_->receiveDrops()});
+    snap.endpoints.push_back({"node2", output_type_, node2_->writeErrors(), node2_->reconnects(),
+                              node2_->receiveDrops()});
+    return snap;
+}
+
 ProtocolChannel::~ProtocolChannel() {
     stop();
+    closeSplicePipes();
 }
 
 void ProtocolChannel::start() {
+    if (coalesce_ && !startCoalesceTimers()) {
+        // 定时器不可用时退化为延迟优先模式
+        stopCoalesceTimers();
+        coalesce_ = false;
+    }
     running_ = true;
     node1_->open();
     node2_->open();
+    MetricsRegistry::getInstance().add(this);
     CH_LOG_INFO(name_, "---------------Channel started---------------");
 }
 
 void ProtocolChannel::stop() {
     if (!running_) return;
     running_ = false;
+    MetricsRegistry::getInstance().remove(this);
     
     // 关闭缓冲区
-    node1_to_node2_buffer_.shutdown();
-    node2_to_node1_buffer_.shutdown();
+    for (auto& dir : directions_) {
+        dir.buffer.shutdown();
+    }
+    
+    // 占用任务标志：等待正在执行的转发任务结束（缓冲区已关闭，任务会立即返回），之后不会再提交新任务
+    // 需在关闭端点之前完成，避免任务仍在向正在关闭的端点写入
+    for (auto& dir : directions_) {
+        while (dir.task_active.test_and_set(std::memory_order_acquire)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
     
-    // 关闭端点
+    // 关闭端点（返回后不会再有数据回调或可写回调）
     node1_->close();
     node2_->close();
-    
-    // 等待活动任务完成（最多50ms）
-    constexpr int max_wait = 5;
-    int wait_count = 0;
-    while (true) {
-        bool active0 = forwarding_task_active_[0].test_and_set(std::memory_order_acquire);
-        if (!active0) forwarding_task_active_[0].clear(std::memory_order_release);
-        bool active1 = forwarding_task_active_[1].test_and_set(std::memory_order_acquire);
-        if (!active1) forwarding_task_active_[1].clear(std::memory_order_release);
-        if (!(active0 || active1)) break;
-        if (++wait_count >= max_wait) break;
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    stopCoalesceTimers();
+
+    // 任务在释放标志后仍会访问通道，等待其完全退出
+    while (tasks_inflight_.load(std::memory_order_acquire) > 0) {
+        std::this_thread::yield();
     }
     
     CH_LOG_INFO(name_, "Channel stopped");
-}
\ No newline at end of file
+}
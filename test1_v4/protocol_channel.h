@@ -6,33 +6,96 @@
 #include <memory>
 #include <string>
 #include <atomic>
+#include <array>
 #include "shared_structs.h"
-class ProtocolChannel {
+#include "metrics.h"
+#include "packet_capture.h"
+class ProtocolChannel : public MetricsSource {
 public:
-    ProtocolChannel(const std::string& name,
-                   const EndpointConfig& node1_config,
-                   const EndpointConfig& node2_config,
-                   ThreadPool& thread_pool);
-    
+    ProtocolChannel(const ChannelConfig& config, ThreadPool& thread_pool);
+
     ~ProtocolChannel();
     void start();
     void stop();
     const std::string& getName() const { return name_; }
+    ChannelSnapshot snapshot() const override;
 
 private:
+    // 单个转发方向的状态
+    struct Direction {
+        Endpoint* source = nullptr;
+        Endpoint* target = nullptr;
+        std::string recv_label;   // 如 "[NODE1 RECV]"
+        std::string label;        // 如 "[NODE1->NODE2]"
+        uint32_t capture_recv_if = 0;   // 抓包接口：收到的数据 / 已转发的数据
+        uint32_t capture_sent_if = 0;
+        // 单生产者（源端点接收线程）/单消费者（转发任务），使用无锁SPSC环形缓冲区
+        RingBuffer buffer{1024 * 1024}; // 1MB buffer
+        // 使用原子标志跟踪转发任务状态
+        std::atomic_flag task_active = ATOMIC_FLAG_INIT;
+        std::atomic<bool> waiting_writable{false}; // 目标端点输出阻塞，等待可写
+        std::atomic<bool> read_paused{false};      // 源端点因高水位被暂停读取
+        size_t record_offset = 0;                  // 记录模式：首条记录已发送到流式目标的字节数
+        int timer_fd = -1;                         // 合并窗口定时器（仅吞吐优先模式）
+        std::atomic<bool> window_open{false};      // 合并窗口已打开（定时器已启动）
+        std::atomic<int64_t> oldest_ns{0};         // 尚未转发的最早数据的接收时间（0 表示无）
+        DirectionMetrics metrics;
+        // splice 快速路径：源socket -> 管道 -> 目标socket
+        int pipe_fds[2] = {-1, -1};
+        size_t pipe_capacity = 0;
+        size_t pipe_bytes = 0;                     // 管道中尚未写出的字节数（写出期间源端点暂停读取）
+    };
+
     std::unique_ptr<Endpoint> createEndpoint(const EndpointConfig& config);
     void setupForwarding();
+    void onSourceData(Direction& dir, const uint8_t* data, size_t len);
+    void onSourceBatch(Direction& dir, const iovec* msgs, size_t count);
+    bool pushSourceData(Direction& dir, const uint8_t* data, size_t len);   // 返回 false 表示缓冲区满已丢弃
+    void markOldest(Direction& dir);
+    void afterSourceData(Direction& dir);   // 水位检查与转发调度
+    void scheduleForward(Direction& dir);
     // 数据转发任务实现
-    void forwardDataTask(RingBuffer& source, Endpoint& target, 
-                         const std::string& direction, int index);
+    void forwardDataTask(Direction& dir);
+    // 返回 true 表示目标输出阻塞
+    // forwarded 累加本次交给目标端点的字节数
+    bool forwardStream(Direction& dir, size_t& forwarded);
+    bool forwardRecords(Direction& dir, size_t& forwarded);
+    void logForwarded(Direction& dir, const iovec* iov, int iovcnt, size_t sent);
+    void setupCapture(const ChannelConfig& config);
+    // 吞吐优先模式：数据不足字节阈值时打开合并窗口，到期后再转发
+    void openCoalesceWindow(Direction& dir);
+    bool startCoalesceTimers();
+    void stopCoalesceTimers();
+    // splice 快速路径（两端均为TCP时启用）
+    bool createSplicePipes();
+    void closeSplicePipes();
+    Endpoint::SpliceResult spliceForward(Direction& dir, int fd);
+    bool drainPipe(Direction& dir);             // 返回 false 表示目标输出阻塞
+    void discardPipe(Direction& dir);
+    void waitSpliceWritable(Direction& dir);
 
     std::string name_;
+    std::string input_type_;
+    std::string output_type_;
     std::unique_ptr<Endpoint> node1_;
     std::unique_ptr<Endpoint> node2_;
-    RingBuffer node1_to_node2_buffer_{1024 * 1024}; // 1MB buffer
-    RingBuffer node2_to_node1_buffer_{1024 * 1024}; // 1MB buffer
+    std::array<Direction, 2> directions_; // [0]: node1->node2, [1]: node2->node1
     ThreadPool& thread_pool_;
     std::atomic<bool> running_{false};
-     // 使用原子标志跟踪转发任务状态
-    std::array<std::atomic_flag, 2> forwarding_task_active_;
-};
\ No newline at end of file
+    std::atomic<int> tasks_inflight_{0};   // 已提交但尚未完全退出的转发任务数
+    bool framed_ = false;   // 记录模式（任一端为UDP时启用）
+    std::atomic<bool> splice_{false};   // splice 快速路径（两端均为TCP时启用）
+    bool log_binary_ = true;            // 记录收发数据内容（splice 模式下关闭）
+    std::unique_ptr<PacketCapture> capture_;   // 配置了抓包目录时代替二进制日志
+
+    // 流控水位（字节）
+    bool flow_control_ = false;
+    size_t high_watermark_ = 0;
+    size_t low_watermark_ = 0;
+
+    // 输出合并（吞吐优先模式）
+    bool coalesce_ = false;
+    size_t coalesce_bytes_ = 0;
+    uint32_t coalesce_usec_ = 0;
+    EventLoop* timer_loop_ = nullptr;   // 合并窗口定时器所在的事件循环
+};
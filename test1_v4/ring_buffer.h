@@ -1,89 +1,261 @@
 // ring_buffer.h
 #pragma once
-#include <vector>
-#include <mutex>
 #include <atomic>
+#include <memory>
 #include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <sys/uio.h>
 
+// 缓存行大小（避免生产者/消费者索引伪共享）
+constexpr size_t kCacheLineSize = 64;
+
+// 记录模式下 peekRecords() 返回的单条记录（负载回绕时为两段）
+struct RingRecord {
+    iovec spans[2];
+    int count;          // 段数（空记录为0）
+    size_t size;        // 负载字节数
+    size_t footprint;   // 在缓冲区中占用的字节数（含长度头和对齐填充）
+};
+
+// 单生产者/单消费者无锁字节环形缓冲区
+// 生产者：源端点的接收线程；消费者：线程池中的转发任务（同一时刻只有一个）
+// 两种使用方式（同一缓冲区只能使用其中一种）：
+// - 字节流：push / pop / peek / commit
+// - 记录（保持消息边界，用于UDP）：pushRecord / peekRecords / commitRecords
+//   每条记录 = 4字节长度头 + 负载，按4字节对齐，全部存放在同一块连续内存中，无逐条堆分配
 class RingBuffer {
 public:
+    static constexpr size_t kRecordHeaderSize = sizeof(uint32_t);
+
     explicit RingBuffer(size_t capacity)
-        : buffer_(capacity), capacity_(capacity), 
-          read_pos_(0), write_pos_(0), count_(0),
-          shutdown_(false) {}
+        : capacity_(roundUpPow2(capacity)), mask_(capacity_ - 1),
+          buffer_(new uint8_t[capacity_]) {}
+
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
 
-    // 非阻塞写入
+    // 非阻塞写入（仅生产者调用）
     bool push(const uint8_t* data, size_t size) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        
-        if (shutdown_ || size > capacity_ - count_) {
-            return false; // 已关闭或空间不足
+        if (shutdown_.load(std::memory_order_relaxed)) {
+            return false; // 已关闭
         }
 
-        // 分两部分写入（处理回绕）
-        size_t first_part = std::min(size, capacity_ - write_pos_);
-        std::copy(data, data + first_part, buffer_.begin() + write_pos_);
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (size > capacity_ - (head - cached_tail_)) {
+            // 缓存的读位置不够用时才重新读取消费者索引
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (size > capacity_ - (head - cached_tail_)) {
+                return false; // 空间不足
+            }
+        }
 
+        // 分两部分写入（处理回绕）
+        const size_t offset = head & mask_;
+        const size_t first_part = std::min(size, capacity_ - offset);
+        std::memcpy(buffer_.get() + offset, data, first_part);
         if (size > first_part) {
-            size_t second_part = size - first_part;
-            std::copy(data + first_part, data + size, buffer_.begin());
-            write_pos_ = second_part;
-        } else {
-            write_pos_ += first_part;
-            if (write_pos_ >= capacity_) write_pos_ -= capacity_;
+            std::memcpy(buffer_.get(), data + first_part, size - first_part);
         }
 
-        count_ += size;
+        head_.store(head + size, std::memory_order_release);
         return true;
     }
 
-    // 非阻塞读取
+    // 非阻塞读取（仅消费者调用）
     size_t pop(uint8_t* data, size_t max_size) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        
-        if (shutdown_ || count_ == 0) {
-            return 0; // 已关闭或无数据
+        if (shutdown_.load(std::memory_order_relaxed)) {
+            return 0; // 已关闭
         }
 
-        size_t to_read = std::min(count_, max_size);
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (cached_head_ == tail) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (cached_head_ == tail) {
+                return 0; // 无数据
+            }
+        }
 
-        // 分两部分读取（处理回绕）
-        size_t first_part = std::min(to_read, capacity_ - read_pos_);
-        std::copy(buffer_.begin() + read_pos_, 
-                 buffer_.begin() + read_pos_ + first_part, 
-                 data);
+        const size_t to_read = std::min(cached_head_ - tail, max_size);
 
+        // 分两部分读取（处理回绕）
+        const size_t offset = tail & mask_;
+        const size_t first_part = std::min(to_read, capacity_ - offset);
+        std::memcpy(data, buffer_.get() + offset, first_part);
         if (to_read > first_part) {
-            size_t second_part = to_read - first_part;
-            std::copy(buffer_.begin(), buffer_.begin() + second_part, data + first_part);
-            read_pos_ = second_part;
-        } else {
-            read_pos_ += first_part;
-            if (read_pos_ >= capacity_) read_pos_ -= capacity_;
+            std::memcpy(data + first_part, buffer_.get(), to_read - first_part);
         }
 
-        count_ -= to_read;
+        tail_.store(tail + to_read, std::memory_order_release);
         return to_read;
     }
 
-    // 检查是否为空
+    // 零拷贝读取：把可读区域以最多两段连续内存的形式返回（仅消费者调用）
+    // 返回段数（0表示无数据），数据在 commit() 之前保持有效
+    int peek(iovec (&spans)[2], size_t max_size = SIZE_MAX) {
+        if (shutdown_.load(std::memory_order_relaxed)) {
+            return 0; // 已关闭
+        }
+
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (cached_head_ == tail) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (cached_head_ == tail) {
+                return 0; // 无数据
+            }
+        }
+
+        const size_t readable = std::min(cached_head_ - tail, max_size);
+        const size_t offset = tail & mask_;
+        const size_t first_part = std::min(readable, capacity_ - offset);
+        spans[0].iov_base = buffer_.get() + offset;
+        spans[0].iov_len = first_part;
+        if (readable > first_part) {
+            spans[1].iov_base = buffer_.get();
+            spans[1].iov_len = readable - first_part;
+            return 2;
+        }
+        return 1;
+    }
+
+    // 确认已消费 peek() 返回区域中的前 n 个字节（仅消费者调用）
+    void commit(size_t n) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        tail_.store(tail + n, std::memory_order_release);
+    }
+
+    // 写入一条记录（仅生产者调用），空间不足时整条丢弃
+    bool pushRecord(const uint8_t* data, size_t size) {
+        iovec iov{const_cast<uint8_t*>(data), size};
+        return pushRecord(&iov, 1, size);
+    }
+
+    // 写入一条由多段组成的记录（size 为各段长度之和），空间不足时整条丢弃
+    bool pushRecord(const iovec* iov, int iovcnt, size_t size) {
+        if (shutdown_.load(std::memory_order_relaxed)) {
+            return false; // 已关闭
+        }
+
+        const size_t footprint = recordFootprint(size);
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (footprint > capacity_ - (head - cached_tail_)) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (footprint > capacity_ - (head - cached_tail_)) {
+                return false; // 空间不足
+            }
+        }
+
+        // 写位置始终4字节对齐，长度头不会跨越回绕点
+        const uint32_t length = static_cast<uint32_t>(size);
+        std::memcpy(buffer_.get() + (head & mask_), &length, kRecordHeaderSize);
+
+        size_t pos = head + kRecordHeaderSize;
+        for (int i = 0; i < iovcnt; ++i) {
+            const uint8_t* data = static_cast<const uint8_t*>(iov[i].iov_base);
+            const size_t len = iov[i].iov_len;
+            const size_t offset = pos & mask_;
+            const size_t first_part = std::min(len, capacity_ - offset);
+            std::memcpy(buffer_.get() + offset, data, first_part);
+            if (len > first_part) {
+                std::memcpy(buffer_.get(), data + first_part, len - first_part);
+            }
+            pos += len;
+        }
+
+        head_.store(head + footprint, std::memory_order_release);
+        return true;
+    }
+
+    // 零拷贝读取多条记录（仅消费者调用），数据在 commitRecords() 之前保持有效
+    // 最多返回 max_records 条；负载累计超过 max_bytes 时停止（至少返回一条）
+    size_t peekRecords(RingRecord* records, size_t max_records, size_t max_bytes = SIZE_MAX) {
+        if (shutdown_.load(std::memory_order_relaxed)) {
+            return 0; // 已关闭
+        }
+
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        if (cached_head_ == pos) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+        }
+
+        size_t count = 0;
+        size_t bytes = 0;
+        while (count < max_records && pos != cached_head_) {
+            uint32_t length;
+            std::memcpy(&length, buffer_.get() + (pos & mask_), kRecordHeaderSize);
+            if (count > 0 && bytes + length > max_bytes) break;
+
+            RingRecord& record = records[count++];
+            record.size = length;
+            record.footprint = recordFootprint(length);
+            record.count = 0;
+
+            const size_t offset = (pos + kRecordHeaderSize) & mask_;
+            const size_t first_part = std::min<size_t>(length, capacity_ - offset);
+            if (first_part > 0) {
+                record.spans[record.count].iov_base = buffer_.get() + offset;
+                record.spans[record.count++].iov_len = first_part;
+            }
+            if (length > first_part) {
+                record.spans[record.count].iov_base = buffer_.get();
+                record.spans[record.count++].iov_len = length - first_part;
+            }
+
+            bytes += length;
+            pos += record.footprint;
+        }
+        return count;
+    }
+
+    // 确认已消费 peekRecords() 返回的前 n 条记录（仅消费者调用）
+    void commitRecords(const RingRecord* records, size_t n) {
+        size_t footprint = 0;
+        for (size_t i = 0; i < n; ++i) {
+            footprint += records[i].footprint;
+        }
+        commit(footprint);
+    }
+
+    // 检查是否为空（任意线程可调用，结果为瞬时快照）
     bool empty() const {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return count_ == 0;
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        return head_.load(std::memory_order_acquire) == tail;
     }
 
+    // 当前缓存字节数（瞬时快照）
+    size_t size() const {
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        return head_.load(std::memory_order_acquire) - tail;
+    }
+
+    size_t capacity() const { return capacity_; }
+
     // 关闭缓冲区
     void shutdown() {
-        std::lock_guard<std::mutex> lock(mutex_);
-        shutdown_ = true;
+        shutdown_.store(true, std::memory_order_relaxed);
     }
 
 private:
-    std::vector<uint8_t> buffer_;
-    size_t capacity_;
-    size_t read_pos_;
-    size_t write_pos_;
-    size_t count_;
-    mutable std::mutex mutex_;
-    bool shutdown_ = false;
-};
\ No newline at end of file
+    static size_t recordFootprint(size_t size) {
+        return (kRecordHeaderSize + size + kRecordHeaderSize - 1) & ~(kRecordHeaderSize - 1);
+    }
+
+    static size_t roundUpPow2(size_t n) {
+        size_t v = 1;
+        while (v < n) v <<= 1;
+        return v;
+    }
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<uint8_t[]> buffer_;
+    std::atomic<bool> shutdown_{false};
+
+    // 生产者独占：写索引 + 缓存的读索引
+    alignas(kCacheLineSize) std::atomic<size_t> head_{0};
+    size_t cached_tail_ = 0;
+
+    // 消费者独占：读索引 + 缓存的写索引
+    alignas(kCacheLineSize) std::atomic<size_t> tail_{0};
+    size_t cached_head_ = 0;
+};
@@ -5,9 +5,20 @@
 #include <stdexcept>
 #include <asm/termbits.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
+#include <sys/timerfd.h>
+#include <linux/serial.h>
+#include <algorithm>
+#include <fstream>
 
-SerialEndpoint::SerialEndpoint(const std::string& device, int baudrate)
-    : _device(device), _baudrate(baudrate) {}
+// 单帧上限不超过通道单次读取的上限
+static constexpr size_t kMaxFrameBytes = 64 * 1024;
+// 每次读取的上限：高波特率下一次唤醒可能已积攒多个驱动缓冲区的数据，一次读完减少系统调用
+static constexpr size_t kSerialReadBytes = 4096;
+
+SerialEndpoint::SerialEndpoint(const std::string& device, int baudrate, const SerialFraming& framing,
+                               const SerialLine& line)
+    : _device(device), _baudrate(baudrate), _framing(framing), _line(line) {}
 
 SerialEndpoint::~SerialEndpoint() {
     close();
@@ -30,45 +41,52 @@ bool SerialEndpoint::open() {
         return false;
     }
     
-    // 创建epoll实例
-    _epollFd = epoll_create1(0);
-    if (_epollFd < 0) {
-        logError("Epoll creation failed: " + std::string(strerror(errno)));
-        ::close(_serialFd);
-        _serialFd = -1;
-        return false;
-    }
-    
-    // 添加串口到epoll
-    epoll_event event{};
-    event.events = EPOLLIN;
-    event.data.fd = _serialFd;
-    if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, _serialFd, &event) < 0) {
+    // 绑定事件循环并注册串口
+    attachLoop();
+    if (!addFd(_serialFd, EPOLLIN)) {
         logError("Epoll_ctl failed: " + std::string(strerror(errno)));
-        ::close(_epollFd);
+        detachLoop();
         ::close(_serialFd);
-        _epollFd = -1;
         _serialFd = -1;
         return false;
     }
+
+    if (_framing.enabled()) {
+        _frameMaxBytes = std::min(_framing.maxBytes > 0 ? _framing.maxBytes : kDefaultFrameMaxBytes, kMaxFrameBytes);
+        _frame.clear();
+        _frame.reserve(_frameMaxBytes);
+    }
+    if (_framing.gapChars > 0 && _baudrate > 0) {
+        // 按配置的字符数换算，不附加协议特定的下限（Modbus RTU 高波特率下的 1750 微秒可直接配置对应的字符数）
+        _gapNs = static_cast<uint64_t>(_framing.gapChars * _line.bitsPerChar() * 1e9 / _baudrate);
+
+        // 流控暂停时定时器也暂停，恢复后再输出积攒的帧
+        _gapTimerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (_gapTimerFd < 0 || !addFd(_gapTimerFd, EPOLLIN)) {
+            logError("Frame gap timer failed: " + std::string(strerror(errno)));
+            close();
+            return false;
+        }
+        logMessage("Serial framing: gap " + std::to_string(_gapNs / 1000) + " us");
+    }
     
     setState(State::CONNECTED);
-    startThread();
     return true;
 }
 
 void SerialEndpoint::close() {
-    stopThread();
-    
-    if (_epollFd >= 0) {
-        ::close(_epollFd);
-        _epollFd = -1;
-    }
+    detachLoop();
     
     if (_serialFd >= 0) {
+        restoreLowLatency();
         ::close(_serialFd);
         _serialFd = -1;
     }
+    if (_gapTimerFd >= 0) {
+        ::close(_gapTimerFd);
+        _gapTimerFd = -1;
+    }
+    _frame.clear();   // 未结束的帧丢弃
     
     setState(State::DISCONNECTED);
 }
@@ -78,11 +96,33 @@ void SerialEndpoint::write(const uint8_t* data, size_t len) {
     
     std::lock_guard<std::mutex> lock(_mutex);
     if (::write(_serialFd, data, len) < 0) {
-        logError("Serial write failed: " + std::string(strerror(errno)));
+        logWriteError("Serial write failed: " + std::string(strerror(errno)));
         setState(State::ERROR);
     }
 }
 
+size_t SerialEndpoint::writev(const iovec* iov, int iovcnt) {
+    const size_t total = totalLength(iov, iovcnt);
+    if (!isConnected()) return total;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    ssize_t written = ::writev(_serialFd, iov, iovcnt);
+    if (written >= 0) {
+        return static_cast<size_t>(written);
+    }
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        return 0; // 串口发送缓冲区已满（低波特率），等待可写后重试
+    }
+
+    logWriteError("Serial write failed: " + std::string(strerror(errno)));
+    setState(State::ERROR);
+    return total;
+}
+
+int SerialEndpoint::outputFd() const {
+    return isConnected() ? _serialFd : -1;
+}
+
 bool SerialEndpoint::configureSerialPort() {
     termios2 tty{};
     if (ioctl(_serialFd, TCGETS2, &tty) != 0) {
@@ -96,64 +136,185 @@ bool SerialEndpoint::configureSerialPort() {
     tty.c_ispeed = _baudrate;
     tty.c_ospeed = _baudrate;
     
-    // 8位数据位，无校验，1位停止位
-    tty.c_cflag &= ~CSIZE;
-    tty.c_cflag |= CS8;
-    tty.c_cflag &= ~PARENB;
-    tty.c_cflag &= ~CSTOPB;
+    // 数据位、校验位、停止位
+    static const tcflag_t kCharSize[] = {CS5, CS6, CS7, CS8};
+    tty.c_cflag &= ~(CSIZE | PARENB | PARODD | CSTOPB);
+    tty.c_cflag |= kCharSize[std::min(std::max(_line.dataBits, 5), 8) - 5];
+    if (_line.parity != 'N') tty.c_cflag |= PARENB;
+    if (_line.parity == 'O') tty.c_cflag |= PARODD;
+    if (_line.stopBits == 2) tty.c_cflag |= CSTOPB;
     
-    // 禁用硬件流控
-    tty.c_cflag &= ~CRTSCTS;
+    // 硬件流控
+    if (_line.rtsCts) {
+        tty.c_cflag |= CRTSCTS;
+    } else {
+        tty.c_cflag &= ~CRTSCTS;
+    }
     
     // 开启接收
     tty.c_cflag |= CREAD | CLOCAL;
     
-    // 禁用软件流控
-    tty.c_iflag &= ~(IXON | IXOFF | IXANY);
+    // 原始输入：禁用软件流控及 CR/NL 转换、去除第8位、BREAK 处理，数据原样交付
+    tty.c_iflag &= ~(IXON | IXOFF | IXANY | ICRNL | INLCR | IGNCR | ISTRIP | BRKINT | PARMRK | IGNBRK);
+    // 有校验时丢弃校验错误的字节
+    if (_line.parity != 'N') {
+        tty.c_iflag |= INPCK | IGNPAR;
+    } else {
+        tty.c_iflag &= ~(INPCK | IGNPAR);
+    }
     
     // 原始输入模式
     tty.c_lflag = 0;
     tty.c_oflag = 0;
     
-    // 特殊字符处理
+    // 特殊字符处理（非阻塞读取时不生效，低延迟模式下清零以防其他进程以阻塞方式共用该设备）
     tty.c_cc[VMIN] = 0;
-    tty.c_cc[VTIME] = 10; // 1秒超时
+    tty.c_cc[VTIME] = _line.lowLatency ? 0 : 10; // 1秒超时
     
     if (ioctl(_serialFd, TCSETS2, &tty) != 0) {
         logError("Set serial config failed: " + std::string(strerror(errno)));
         return false;
     }
+
+    if (_line.lowLatency) enableLowLatency();
     
     return true;
 }
 
-void SerialEndpoint::run() {
-    epoll_event events[2];
-    while (isRunning()) {
-        int numEvents = epoll_wait(_epollFd, events, 2, 100);
-        if (numEvents < 0) {
-            if (errno != EINTR) {
-                logError("Epoll_wait error: " + std::string(strerror(errno)));
-            }
-            continue;
+// 低延迟模式只是优化，驱动不支持时（pty、部分USB转串口驱动）记录日志后继续运行
+// 修改前的设置保存下来，关闭时恢复（驱动设置在设备关闭后仍然保留，会影响之后使用该设备的程序）
+void SerialEndpoint::enableLowLatency() {
+    serial_struct serial{};
+    if (ioctl(_serialFd, TIOCGSERIAL, &serial) == 0) {
+        const bool wasLowLatency = (serial.flags & ASYNC_LOW_LATENCY) != 0;
+        serial.flags |= ASYNC_LOW_LATENCY;
+        if (ioctl(_serialFd, TIOCSSERIAL, &serial) != 0) {
+            logMessage("ASYNC_LOW_LATENCY not set: " + std::string(strerror(errno)));
+        } else {
+            _restoreLowLatencyFlag = !wasLowLatency;
         }
-        
-        for (int i = 0; i < numEvents; ++i) {
-            if (events[i].events & EPOLLIN) {
-                handleSerialData();
+    } else {
+        logMessage("ASYNC_LOW_LATENCY not supported: " + std::string(strerror(errno)));
+    }
+
+    // FTDI 等USB转串口适配器的批量上报间隔（默认16毫秒），需要写权限
+    const size_t slash = _device.find_last_of('/');
+    const std::string name = slash == std::string::npos ? _device : _device.substr(slash + 1);
+    const std::string latencyTimer = "/sys/class/tty/" + name + "/device/latency_timer";
+    std::ifstream probe(latencyTimer);
+    std::string original;
+    if (!(probe >> original)) return;
+    std::ofstream timer(latencyTimer);
+    if (!(timer << 1 << std::flush)) {
+        logMessage("Cannot set " + latencyTimer + ": " + std::string(strerror(errno)));
+    } else if (original != "1") {
+        _latencyTimerPath = latencyTimer;
+        _savedLatencyTimer = original;
+    }
+}
+
+void SerialEndpoint::restoreLowLatency() {
+    if (_restoreLowLatencyFlag) {
+        serial_struct serial{};
+        if (ioctl(_serialFd, TIOCGSERIAL, &serial) == 0) {
+            serial.flags &= ~ASYNC_LOW_LATENCY;
+            if (ioctl(_serialFd, TIOCSSERIAL, &serial) != 0) {
+                logMessage("ASYNC_LOW_LATENCY not restored: " + std::string(strerror(errno)));
             }
         }
+        _restoreLowLatencyFlag = false;
+    }
+
+    if (!_latencyTimerPath.empty()) {
+        std::ofstream timer(_latencyTimerPath);
+        if (!(timer << _savedLatencyTimer << std::flush)) {
+            logMessage("Cannot restore " + _latencyTimerPath + ": " + std::string(strerror(errno)));
+        }
+        _latencyTimerPath.clear();
+    }
+}
+
+void SerialEndpoint::handleEvent(int fd, uint32_t events) {
+    if (fd == _gapTimerFd) {
+        handleGapTimer();
+        return;
+    }
+    if (fd != _serialFd) return;
+
+    if (events & EPOLLIN) {
+        handleSerialData();
+    } else if (events & (EPOLLERR | EPOLLHUP)) {
+        // 设备异常（如USB串口拔出），停止监听避免事件循环空转
+        logError("Serial device error, stop polling: " + _device);
+        removeFd(_serialFd);
     }
 }
 
 void SerialEndpoint::handleSerialData() {
-    uint8_t buffer[256];
+    uint8_t buffer[kSerialReadBytes];
     ssize_t bytesRead = read(_serialFd, buffer, sizeof(buffer));
     
     if (bytesRead > 0) {
-        processData(buffer, bytesRead);
+        if (_framing.enabled()) {
+            appendFrame(buffer, bytesRead);
+            armGapTimer();
+        } else {
+            processData(buffer, bytesRead);
+        }
     } else if (bytesRead < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
         logError("Serial read error: " + std::string(strerror(errno)));
         setState(State::ERROR);
     }
+}
+
+void SerialEndpoint::appendFrame(const uint8_t* data, size_t len) {
+    while (len > 0) {
+        size_t n = std::min(len, _frameMaxBytes - _frame.size());
+        bool complete = _frame.size() + n == _frameMaxBytes;
+        if (_framing.delimiter >= 0) {
+            const void* end = memchr(data, _framing.delimiter, n);
+            if (end != nullptr) {
+                n = static_cast<const uint8_t*>(end) - data + 1;
+                complete = true;
+            }
+        }
+
+        _frame.insert(_frame.end(), data, data + n);
+        if (complete) flushFrame();
+        data += n;
+        len -= n;
+    }
+}
+
+void SerialEndpoint::flushFrame() {
+    if (_frame.empty()) return;
+    processData(_frame.data(), _frame.size());
+    _frame.clear();
+}
+
+// 每次收到数据后重新计时（单次定时，相对时间）；帧已输出时停止计时
+void SerialEndpoint::armGapTimer() {
+    if (_gapTimerFd < 0) return;
+
+    itimerspec spec{};
+    if (!_frame.empty()) {
+        spec.it_value.tv_sec = static_cast<time_t>(_gapNs / 1000000000);
+        spec.it_value.tv_nsec = static_cast<long>(_gapNs % 1000000000);
+    }
+    timerfd_settime(_gapTimerFd, 0, &spec, nullptr);
+}
+
+void SerialEndpoint::handleGapTimer() {
+    uint64_t expirations;
+    if (::read(_gapTimerFd, &expirations, sizeof(expirations)) < 0) return;
+
+    // 同一轮事件中串口可能已有新数据：先读取，有数据说明线路未静默，继续计时
+    uint8_t buffer[kSerialReadBytes];
+    ssize_t bytesRead = _readPaused ? 0 : read(_serialFd, buffer, sizeof(buffer));
+    if (bytesRead > 0) {
+        appendFrame(buffer, bytesRead);
+        armGapTimer();
+        return;
+    }
+    flushFrame();
 }
\ No newline at end of file
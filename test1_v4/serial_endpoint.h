@@ -1,23 +1,83 @@
 #pragma once
 #include "endpoint.h"
 #include <sys/epoll.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// 线路参数（默认 8N1、无硬件流控）
+// lowLatency：请求驱动立即交付收到的数据（ASYNC_LOW_LATENCY；USB转串口适配器同时把
+// latency_timer 调为1毫秒，否则适配器最多积攒16毫秒才上报一次），代价是更多的中断和唤醒
+struct SerialLine {
+    int dataBits = 8;        // 数据位 5-8
+    char parity = 'N';       // 'N' 无校验 / 'E' 偶校验 / 'O' 奇校验
+    int stopBits = 1;        // 停止位 1 或 2
+    bool rtsCts = false;     // RTS/CTS 硬件流控
+    bool lowLatency = false;
+
+    // 每个字符的线路位数：起始位 + 数据位 + 校验位 + 停止位
+    int bitsPerChar() const { return 1 + dataBits + (parity == 'N' ? 0 : 1) + stopBits; }
+};
+
+// 解析配置中的校验方式（"none" / "even" / "odd"），未知名称抛出异常
+inline char parseSerialParity(const std::string& parity) {
+    if (parity.empty() || parity == "none") return 'N';
+    if (parity == "even") return 'E';
+    if (parity == "odd") return 'O';
+    throw std::runtime_error("Unknown serial parity: " + parity);
+}
+
+// 分帧：把设备的一条报文合并为一次输出（未启用时每次读取到的数据立即转发）
+// 帧在以下任一条件满足时结束：线路静默 gapChars 个字符时间、收到 delimiter 字节、达到 maxBytes
+struct SerialFraming {
+    double gapChars = 0;     // 静默间隔（字符时间，如 Modbus RTU 的 3.5），0 表示不按间隔分帧
+    size_t maxBytes = 0;     // 单帧上限（0 表示默认值）
+    int delimiter = -1;      // 帧结束字节（0-255，包含在帧内），-1 表示无
+
+    bool enabled() const { return gapChars > 0 || delimiter >= 0; }
+};
 
 class SerialEndpoint : public Endpoint {
 public:
-    SerialEndpoint(const std::string& device, int baudrate);
+    static constexpr size_t kDefaultFrameMaxBytes = 4096;
+
+    SerialEndpoint(const std::string& device, int baudrate, const SerialFraming& framing = SerialFraming(),
+                   const SerialLine& line = SerialLine());
     ~SerialEndpoint() override;
     
     bool open() override;
     void close() override;
     void write(const uint8_t* data, size_t len) override;
+    size_t writev(const iovec* iov, int iovcnt) override;
 
 private:
-    void run() override;
+    void handleEvent(int fd, uint32_t events) override;
+    int outputFd() const override;
     bool configureSerialPort();
+    void enableLowLatency();
+    void restoreLowLatency();
     void handleSerialData();
+    // 分帧模式：把读到的数据追加到当前帧，遇到分隔符或达到上限时输出
+    void appendFrame(const uint8_t* data, size_t len);
+    void flushFrame();
+    void armGapTimer();
+    void handleGapTimer();
 
     const std::string _device;
     const int _baudrate;
+    const SerialFraming _framing;
+    const SerialLine _line;
     int _serialFd = -1;
-    int _epollFd = -1;
+
+    // 低延迟模式修改过的驱动设置，关闭时恢复原值
+    bool _restoreLowLatencyFlag = false;     // 打开前未设置 ASYNC_LOW_LATENCY
+    std::string _latencyTimerPath;           // 已修改的 latency_timer 路径（空表示未修改）
+    std::string _savedLatencyTimer;
+
+    // 帧间隔定时器：间隔通常不足1毫秒（115200bps 下 3.5 字符约 0.3ms），低于事件循环时间轮的精度，
+    // 因此使用独立的 timerfd（以下成员仅在事件循环线程访问）
+    int _gapTimerFd = -1;
+    uint64_t _gapNs = 0;
+    size_t _frameMaxBytes = 0;
+    std::vector<uint8_t> _frame;
 };
\ No newline at end of file
@@ -2,8 +2,10 @@
 #include <string>
 #include <vector>
 #include <cstdint>
+#include "socket_options.h"
 struct EndpointConfig {
-    std::string type; // "tcp_server", "tcp_client", "udp_server", "udp_client", "serial"
+    std::string type; // "tcp_server", "tcp_client", "udp_server", "udp_client", "serial", "shm",
+                      // "unix_server", "unix_client", "udp_multicast_send", "udp_multicast_recv"
     
     // 通用字段
     uint16_t port = 0;
@@ -13,13 +15,89 @@ struct EndpointConfig {
     std::string serial_port;
     uint32_t baud_rate = 0;
 
+    // 串口线路参数：数据位（5-8，0 表示默认8）、校验 "none"（默认）/ "even" / "odd"、
+    // 停止位（1/2，0 表示默认1）、RTS/CTS 硬件流控及低延迟模式（驱动立即交付收到的数据）
+    uint32_t serial_data_bits = 0;
+    std::string serial_parity;
+    uint32_t serial_stop_bits = 0;
+    bool serial_rtscts = false;
+    bool serial_low_latency = false;
+
+    // 串口分帧：线路静默多少个字符时间视为一帧结束（如 Modbus RTU 的 3.5，0 表示不按间隔分帧）、
+    // 单帧上限（字节，0 表示默认值）及帧结束字节（0-255，-1 表示无）
+    double frame_gap_chars = 0;
+    uint32_t frame_max_bytes = 0;
+    int32_t frame_delimiter = -1;
+
+    // TCP服务端：客户端发送队列上限（字节，0 表示默认值）及慢客户端处理策略
+    // 策略："disconnect"（默认，断开慢客户端）/ "drop_oldest"（丢弃最早的数据）/ "block"（对源端点施加反压）
+    uint32_t send_queue_bytes = 0;
+    std::string slow_client_policy;
+
+    // TCP服务端：监听分片数（>1 时用 SO_REUSEPORT 在多个事件循环上接受连接）及监听队列长度，0 表示默认值
+    uint32_t accept_shards = 0;
+    uint32_t listen_backlog = 0;
+
+    // 共享内存端点：段名称（/dev/shm/<shm_name>）及每个方向环形队列的大小（字节，0 表示默认值）
+    std::string shm_name;
+    uint32_t shm_capacity = 0;
+
+    // Unix域socket端点：socket路径（'@' 开头为抽象命名空间）及模式 "stream"（默认）/ "seqpacket"
+    std::string unix_path;
+    std::string unix_mode;
+
+    // UDP组播端点：ip/port 为组播组地址与端口；本地接口（IPv4地址或接口名，空表示由路由决定）、
+    // TTL（0 表示默认值1）及是否回送给本机的订阅者
+    std::string multicast_interface;
+    uint32_t multicast_ttl = 0;
+    bool multicast_loopback = false;
+
+    // 套接字调优参数（配置文件中的 socket 块），在端点创建socket时设置
+    SocketOptions socket;
+
+    // UDP端点：每次 recvmmsg 批量接收的数据报数、单个数据报的最大长度（字节），0 表示默认值
+    uint32_t recv_batch = 0;
+    uint32_t recv_slot_bytes = 0;
+
+    // UDP服务端：客户端空闲超过该时间（秒）即移出广播列表，0 表示默认值
+    uint32_t peer_expiry_sec = 0;
+
+    // TCP客户端：重连退避的最小/最大间隔（毫秒），0 表示默认值
+    uint32_t reconnect_min_ms = 0;
+    uint32_t reconnect_max_ms = 0;
+
     // 添加比较运算符
     bool operator==(const EndpointConfig& other) const {
         return type == other.type &&
                port == other.port &&
                ip == other.ip &&
                serial_port == other.serial_port &&
-               baud_rate == other.baud_rate;
+               baud_rate == other.baud_rate &&
+               serial_data_bits == other.serial_data_bits &&
+               serial_parity == other.serial_parity &&
+               serial_stop_bits == other.serial_stop_bits &&
+               serial_rtscts == other.serial_rtscts &&
+               serial_low_latency == other.serial_low_latency &&
+               frame_gap_chars == other.frame_gap_chars &&
+               frame_max_bytes == other.frame_max_bytes &&
+               frame_delimiter == other.frame_delimiter &&
+               send_queue_bytes == other.send_queue_bytes &&
+               slow_client_policy == other.slow_client_policy &&
+               recv_batch == other.recv_batch &&
+               recv_slot_bytes == other.recv_slot_bytes &&
+               peer_expiry_sec == other.peer_expiry_sec &&
+               reconnect_min_ms == other.reconnect_min_ms &&
+               reconnect_max_ms == other.reconnect_max_ms &&
+               accept_shards == other.accept_shards &&
+               listen_backlog == other.listen_backlog &&
+               shm_name == other.shm_name &&
+               shm_capacity == other.shm_capacity &&
+               unix_path == other.unix_path &&
+               unix_mode == other.unix_mode &&
+               multicast_interface == other.multicast_interface &&
+               multicast_ttl == other.multicast_ttl &&
+               multicast_loopback == other.multicast_loopback &&
+               socket == other.socket;
     }
     
     bool operator!=(const EndpointConfig& other) const {
@@ -32,11 +110,36 @@ struct ChannelConfig {
     EndpointConfig input;
     EndpointConfig output;
 
+    // 流控：方向缓冲区超过高水位时暂停读取源端点，降到低水位后恢复（水位单位字节，0 表示默认值）
+    bool flow_control = false;
+    uint32_t high_watermark = 0;
+    uint32_t low_watermark = 0;
+
+    // 输出合并："latency"（默认，有数据立即转发）或 "throughput"（累计到字节阈值或超过时间窗口后再转发）
+    std::string coalesce_mode = "latency";
+    uint32_t coalesce_bytes = 0;   // 合并字节阈值，0 表示默认值
+    uint32_t coalesce_usec = 0;    // 合并时间窗口（微秒），0 表示默认值
+
+    // 抓包：收发的数据写入 <capture_dir>/<通道名>.<n>.pcapng（代替十六进制/文本日志，可用 capture_decode 还原），
+    // 空表示不抓包；单个文件大小（字节）及循环使用的文件数，0 表示默认值
+    std::string capture_dir;
+    uint32_t capture_segment_bytes = 0;
+    uint32_t capture_segments = 0;
+
     // 添加比较运算符
     bool operator==(const ChannelConfig& other) const {
         return name == other.name &&
                input == other.input &&
-               output == other.output;
+               output == other.output &&
+               flow_control == other.flow_control &&
+               high_watermark == other.high_watermark &&
+               low_watermark == other.low_watermark &&
+               coalesce_mode == other.coalesce_mode &&
+               coalesce_bytes == other.coalesce_bytes &&
+               coalesce_usec == other.coalesce_usec &&
+               capture_dir == other.capture_dir &&
+               capture_segment_bytes == other.capture_segment_bytes &&
+               capture_segments == other.capture_segments;
     }
     
     bool operator!=(const ChannelConfig& other) const {
@@ -0,0 +1,211 @@
+// shm_client.h
+#pragma once
+#include "shm_ring.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <string>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+// 共享内存客户端：同机进程连接转换器的 shm 端点（只依赖 shm_ring.h 和本文件）
+// 数据路径只读写共享内存，仅当对端正在等待时才发起一次唤醒系统调用
+// 发送与接收可以分别在两个线程中进行，但同一方向同一时刻只能有一个线程
+//
+//   ShmClient client;
+//   if (client.attach("converter_ch1")) {
+//       client.write(data, len);
+//       client.poll([](const uint8_t* msg, size_t n) { ... });   // 零拷贝
+//   }
+class ShmClient {
+public:
+    ShmClient() = default;
+    ~ShmClient() { detach(); }
+
+    ShmClient(const ShmClient&) = delete;
+    ShmClient& operator=(const ShmClient&) = delete;
+
+    // 连接 /dev/shm/<name>；已有其他存活客户端时失败（errno=EBUSY）
+    bool attach(const std::string& name) {
+        detach();
+
+        int fd = shm_open(("/" + name).c_str(), O_RDWR | O_CLOEXEC, 0);
+        if (fd < 0) return false;
+
+        struct stat st{};
+        if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < shmHeaderSize()) {
+            ::close(fd);
+            errno = EPROTO;
+            return false;
+        }
+        const size_t size = static_cast<size_t>(st.st_size);
+        void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (base == MAP_FAILED) return false;
+
+        auto* header = static_cast<ShmSegmentHeader*>(base);
+        if (header->magic != kShmMagic || header->version != kShmVersion ||
+            size < shmSegmentSize(header->capacity) || header->closed.load(std::memory_order_acquire)) {
+            munmap(base, size);
+            errno = EPROTO;
+            return false;
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        // 占用客户端位置：上一个客户端异常退出时接管
+        const int32_t self = static_cast<int32_t>(getpid());
+        int32_t owner = 0;
+        if (!header->client_pid.compare_exchange_strong(owner, self, std::memory_order_acq_rel)) {
+            const bool ownerAlive = kill(owner, 0) == 0 || errno != ESRCH;
+            if (ownerAlive || !header->client_pid.compare_exchange_strong(owner, self, std::memory_order_acq_rel)) {
+                munmap(base, size);
+                errno = EBUSY;
+                return false;
+            }
+        }
+
+        notify_fd_ = ::open(shmNotifyPath(name).c_str(), O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+        if (notify_fd_ < 0) {
+            const int err = errno;
+            header->client_pid.store(0, std::memory_order_release);
+            munmap(base, size);
+            errno = err;
+            return false;
+        }
+
+        header_ = header;
+        map_size_ = size;
+        uint8_t* data = static_cast<uint8_t*>(base) + shmHeaderSize();
+        rx_ = ShmRing(&header->rings[0], data, header->capacity);
+        tx_ = ShmRing(&header->rings[1], data + header->capacity, header->capacity);
+        tx_.sync();
+        rx_.sync();
+        // 丢弃上一个客户端未读完的数据
+        if (rx_.discardAll()) notifyServer();
+        return true;
+    }
+
+    void detach() {
+        if (!header_) return;
+
+        int32_t self = static_cast<int32_t>(getpid());
+        header_->client_pid.compare_exchange_strong(self, 0, std::memory_order_acq_rel);
+        notifyServer();   // 转换器可能在等待输出空间
+        ::close(notify_fd_);
+        notify_fd_ = -1;
+        munmap(header_, map_size_);
+        header_ = nullptr;
+        map_size_ = 0;
+    }
+
+    bool attached() const { return header_ != nullptr; }
+    // 转换器已关闭端点（需要重新 attach）
+    bool closed() const { return !header_ || header_->closed.load(std::memory_order_acquire) != 0; }
+
+    // 发送一条消息；环满时最多等待 timeoutMs 毫秒（-1 一直等待，0 不等待）
+    // 失败时 errno：EMSGSIZE 消息过大，EPIPE 端点已关闭，EAGAIN 超时
+    bool write(const void* data, size_t len, int timeoutMs = -1) {
+        iovec iov{const_cast<void*>(data), len};
+        return writev(&iov, 1, timeoutMs);
+    }
+
+    bool writev(const iovec* iov, int iovcnt, int timeoutMs = -1) {
+        size_t len = 0;
+        for (int i = 0; i < iovcnt; ++i) len += iov[i].iov_len;
+        if (len > kShmMaxMessage) {
+            errno = EMSGSIZE;
+            return false;
+        }
+
+        const auto deadline = deadlineAfter(timeoutMs);
+        while (!tx_.push(iov, iovcnt, len)) {
+            if (closed()) {
+                errno = EPIPE;
+                return false;
+            }
+            if (!tx_.prepareWaitSpace(len)) continue;
+
+            const int wait = remainingMs(deadline, timeoutMs);
+            if (wait == 0) {
+                errno = EAGAIN;
+                return false;
+            }
+            shmFutexWait(&header_->rings[1].space_waiting, 1, wait);
+        }
+        if (tx_.consumerNeedsWake()) notifyServer();
+        return true;
+    }
+
+    // 零拷贝接收：对每条已到达的消息调用 handler(const uint8_t* data, size_t len)，返回处理的消息数
+    // 消息内存只在 handler 内有效
+    template <typename F>
+    size_t poll(F&& handler, size_t maxMessages = SIZE_MAX) {
+        size_t count = 0;
+        size_t len;
+        while (count < maxMessages) {
+            const uint8_t* msg = rx_.next(len);
+            if (!msg) break;
+            handler(msg, len);
+            ++count;
+        }
+        if (count > 0 && rx_.release()) notifyServer();
+        return count;
+    }
+
+    // 等待消息到达，超时或端点已关闭返回 false
+    bool wait(int timeoutMs = -1) {
+        const auto deadline = deadlineAfter(timeoutMs);
+        while (true) {
+            if (!rx_.prepareWaitData()) return true;
+            if (closed()) return false;
+
+            const int wait = remainingMs(deadline, timeoutMs);
+            if (wait == 0) return false;
+            shmFutexWait(&header_->rings[0].data_waiting, 1, wait);
+        }
+    }
+
+    // 拷贝接收一条消息，返回消息长度（超过 capacity 的部分被截断），超时或已关闭返回 -1
+    ssize_t read(void* buffer, size_t capacity, int timeoutMs = -1) {
+        ssize_t result = -1;
+        while (result < 0) {
+            poll([&](const uint8_t* msg, size_t len) {
+                std::memcpy(buffer, msg, std::min(len, capacity));
+                result = static_cast<ssize_t>(len);
+            }, 1);
+            if (result < 0 && !wait(timeoutMs)) return -1;
+        }
+        return result;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void notifyServer() {
+        const char byte = 1;
+        ssize_t n = ::write(notify_fd_, &byte, 1);   // FIFO已满说明转换器已有待处理的通知
+        (void)n;
+    }
+
+    static Clock::time_point deadlineAfter(int timeoutMs) {
+        return timeoutMs > 0 ? Clock::now() + std::chrono::milliseconds(timeoutMs) : Clock::time_point{};
+    }
+
+    // 剩余等待时间：-1 表示无限等待，0 表示已超时
+    static int remainingMs(Clock::time_point deadline, int timeoutMs) {
+        if (timeoutMs < 0) return -1;
+        if (timeoutMs == 0) return 0;
+        const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+        return left > 0 ? static_cast<int>(left) : 0;
+    }
+
+    ShmSegmentHeader* header_ = nullptr;
+    size_t map_size_ = 0;
+    int notify_fd_ = -1;
+    ShmRing rx_;   // 转换器 -> 客户端
+    ShmRing tx_;   // 客户端 -> 转换器
+};
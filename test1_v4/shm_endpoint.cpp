@@ -0,0 +1,276 @@
+#include "shm_endpoint.h"
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cstring>
+#include <algorithm>
+#include <new>
+
+// 环容量下限：保证最大消息加上环尾跳过的空间总能放下
+static constexpr size_t kMinCapacity = 4 * kShmMaxMessage;
+// 每次交给通道的入站消息总字节数上限（与通道单次读取的余量一致）
+static constexpr size_t kMaxInboundBytes = kShmMaxMessage;
+static constexpr size_t kMaxInboundBatch = 64;
+
+static size_t roundUpPow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+ShmEndpoint::ShmEndpoint(const std::string& name, size_t capacity)
+    : _name(name),
+      _capacity(roundUpPow2(std::max(capacity > 0 ? capacity : kShmDefaultCapacity, kMinCapacity))) {}
+
+ShmEndpoint::~ShmEndpoint() {
+    close();
+}
+
+bool ShmEndpoint::open() {
+    if (isRunning()) return true;
+
+    if (_name.empty() || _name.find('/') != std::string::npos) {
+        logError("Invalid shared memory name: " + _name);
+        return false;
+    }
+
+    // 创建共享内存段（先清理上次异常退出遗留的同名段）
+    const std::string shmName = "/" + _name;
+    shm_unlink(shmName.c_str());
+    int fd = shm_open(shmName.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0660);
+    if (fd < 0) {
+        logError("Shm_open failed: " + std::string(strerror(errno)));
+        return false;
+    }
+
+    const size_t size = shmSegmentSize(_capacity);
+    void* base = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(size)) == 0) {
+        base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    const int err = errno;
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        logError("Shared memory mapping failed: " + std::string(strerror(err)));
+        shm_unlink(shmName.c_str());
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _mapSize = size;
+        _header = new (base) ShmSegmentHeader();
+        _header->version = kShmVersion;
+        _header->capacity = _capacity;
+        uint8_t* data = static_cast<uint8_t*>(base) + shmHeaderSize();
+        _outbound = ShmRing(&_header->rings[0], data, _capacity);
+        _inbound = ShmRing(&_header->rings[1], data + _capacity, _capacity);
+        _inbound.prepareWaitData();   // 客户端第一次写入即通知
+        std::atomic_thread_fence(std::memory_order_release);
+        _header->magic = kShmMagic;
+    }
+
+    // 通知FIFO：以读写方式打开，没有客户端时也不会产生挂断事件
+    const std::string notifyPath = shmNotifyPath(_name);
+    ::unlink(notifyPath.c_str());
+    if (mkfifo(notifyPath.c_str(), 0660) < 0 ||
+        (_notifyFd = ::open(notifyPath.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC)) < 0) {
+        logError("Notify fifo creation failed: " + std::string(strerror(errno)));
+        std::lock_guard<std::mutex> lock(_mutex);
+        unmap();
+        return false;
+    }
+
+    // 通知FIFO同时承载入站数据和输出空间两种通知，不受流控暂停影响（暂停时只是不读取环）
+    attachLoop();
+    if (!addFd(_notifyFd, EPOLLIN, false)) {
+        logError("Epoll_ctl failed: " + std::string(strerror(errno)));
+        detachLoop();
+        std::lock_guard<std::mutex> lock(_mutex);
+        unmap();
+        return false;
+    }
+
+    setState(State::CONNECTED);
+    logMessage("Shared memory endpoint ready: /dev/shm/" + _name + " (" +
+               std::to_string(_capacity) + " bytes per ring)");
+    return true;
+}
+
+void ShmEndpoint::close() {
+    detachLoop();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_header) {
+        // 通知客户端：清除等待标记后再唤醒，正准备等待的客户端不会错过
+        _header->closed.store(1, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        _header->rings[0].data_waiting.store(0, std::memory_order_relaxed);
+        _header->rings[1].space_waiting.store(0, std::memory_order_relaxed);
+        shmFutexWake(&_header->rings[0].data_waiting);
+        shmFutexWake(&_header->rings[1].space_waiting);
+        logMessage("Shared memory endpoint closed: /dev/shm/" + _name);
+    }
+    unmap();
+    _spaceCallback = nullptr;
+    setState(State::DISCONNECTED);
+}
+
+void ShmEndpoint::unmap() {
+    if (_notifyFd >= 0) {
+        ::close(_notifyFd);
+        _notifyFd = -1;
+        ::unlink(shmNotifyPath(_name).c_str());
+    }
+    if (_header) {
+        munmap(_header, _mapSize);
+        _header = nullptr;
+        _mapSize = 0;
+        shm_unlink(("/" + _name).c_str());
+    }
+}
+
+bool ShmEndpoint::clientAttached() {
+    return _header && _header->client_pid.load(std::memory_order_acquire) != 0;
+}
+
+// 输出环已满时确认客户端是否还在（异常退出的客户端不会清除 client_pid）
+bool ShmEndpoint::clientAlive() {
+    const int32_t pid = _header->client_pid.load(std::memory_order_acquire);
+    if (pid == 0) return false;
+    if (kill(pid, 0) == 0 || errno != ESRCH) return true;
+
+    int32_t expected = pid;
+    if (_header->client_pid.compare_exchange_strong(expected, 0, std::memory_order_acq_rel)) {
+        logMessage("Shared memory client (pid " + std::to_string(pid) + ") exited, detached");
+    }
+    return false;
+}
+
+void ShmEndpoint::wakeClient() {
+    if (_outbound.consumerNeedsWake()) {
+        shmFutexWake(&_header->rings[0].data_waiting);
+    }
+}
+
+void ShmEndpoint::write(const uint8_t* data, size_t len) {
+    iovec iov{const_cast<uint8_t*>(data), len};
+    writev(&iov, 1);
+}
+
+// 一次写入为一条消息
+size_t ShmEndpoint::writev(const iovec* iov, int iovcnt) {
+    const size_t total = totalLength(iov, iovcnt);
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!clientAttached()) return total; // 无客户端时丢弃
+
+    if (total > kShmMaxMessage) {
+        logWriteError("Message of " + std::to_string(total) + " bytes exceeds shared memory limit");
+        return total;
+    }
+    if (!_outbound.push(iov, iovcnt, total)) {
+        // 环已满：等待客户端读取；客户端已退出则丢弃
+        return clientAlive() ? 0 : total;
+    }
+    wakeClient();
+    return total;
+}
+
+size_t ShmEndpoint::writeDatagrams(mmsghdr* msgs, size_t count) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!clientAttached()) return count;
+
+    size_t accepted = 0;
+    for (; accepted < count; ++accepted) {
+        const msghdr& hdr = msgs[accepted].msg_hdr;
+        const int iovcnt = static_cast<int>(hdr.msg_iovlen);
+        const size_t len = totalLength(hdr.msg_iov, iovcnt);
+        if (len > kShmMaxMessage) {
+            logWriteError("Message of " + std::to_string(len) + " bytes exceeds shared memory limit");
+            continue;
+        }
+        if (!_outbound.push(hdr.msg_iov, iovcnt, len)) {
+            if (!clientAlive()) accepted = count;
+            break;
+        }
+    }
+    // 整批写入后只检查一次客户端是否在等待
+    if (accepted > 0) wakeClient();
+    return accepted;
+}
+
+void ShmEndpoint::notifyWhenWritable(std::function<void()> cb) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        // 置位等待标记后仍放不下最大消息：等待客户端释放空间后经FIFO唤醒
+        if (clientAttached() && _outbound.prepareWaitSpace(kShmMaxMessage)) {
+            _spaceCallback = std::move(cb);
+            return;
+        }
+    }
+    runInLoop(std::move(cb)); // 已有空间或客户端已断开，立即回调
+}
+
+void ShmEndpoint::resumeReading() {
+    Endpoint::resumeReading();
+    runInLoop([this] { drainInbound(); });
+}
+
+void ShmEndpoint::handleEvent(int fd, uint32_t events) {
+    if (fd != _notifyFd || !(events & EPOLLIN)) return;
+
+    // FIFO只用于唤醒，内容无意义
+    char buffer[256];
+    while (::read(_notifyFd, buffer, sizeof(buffer)) > 0) {}
+
+    notifySpace();
+    drainInbound();
+}
+
+void ShmEndpoint::notifySpace() {
+    std::function<void()> cb;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_spaceCallback) return;
+        if (clientAttached() && _outbound.prepareWaitSpace(kShmMaxMessage)) return; // 仍然没有空间
+        cb = std::move(_spaceCallback);
+        _spaceCallback = nullptr;
+    }
+    cb();
+}
+
+// 读取客户端写入的消息，按批交给通道；读空后置位等待标记，客户端下次写入时经FIFO唤醒
+void ShmEndpoint::drainInbound() {
+    iovec batch[kMaxInboundBatch];
+    while (!_readPaused) {
+        size_t count = 0;
+        size_t budget = kMaxInboundBytes;
+        size_t len;
+        while (count < kMaxInboundBatch) {
+            const uint8_t* msg = _inbound.next(len, budget);
+            if (!msg) break;
+            batch[count].iov_base = const_cast<uint8_t*>(msg);
+            batch[count].iov_len = len;
+            ++count;
+            budget -= std::min(budget, ShmRing::recordFootprint(len));
+        }
+
+        if (count == 0) {
+            if (_inbound.next(len) != nullptr) {
+                // 超过上限的消息（客户端未经 shm_client.h 写入）：丢弃
+                logReceiveDrop("Dropped " + std::to_string(len) + " byte message exceeding shared memory limit", 1);
+                if (_inbound.release()) shmFutexWake(&_header->rings[1].space_waiting);
+                continue;
+            }
+            if (_inbound.prepareWaitData()) return;
+            continue; // 置位标记期间有新数据到达
+        }
+
+        processBatch(batch, count);
+        if (_inbound.release()) {
+            shmFutexWake(&_header->rings[1].space_waiting);
+        }
+    }
+}
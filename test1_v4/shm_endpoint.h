@@ -0,0 +1,44 @@
+// shm_endpoint.h
+#pragma once
+#include "endpoint.h"
+#include "shm_ring.h"
+#include <sys/epoll.h>
+
+// 共享内存端点：在 /dev/shm 下创建一对环形队列，同机进程通过 shm_client.h 连接，
+// 数据收发不经过内核协议栈；每条消息保持边界（按数据报端点处理），同一时刻只允许一个客户端
+class ShmEndpoint : public Endpoint {
+public:
+    // name：段名称（/dev/shm/<name>）；capacity：每个方向的环大小（字节，0 表示默认值，向上取2的幂）
+    explicit ShmEndpoint(const std::string& name, size_t capacity = 0);
+    ~ShmEndpoint() override;
+
+    bool open() override;
+    void close() override;
+    void write(const uint8_t* data, size_t len) override;
+    size_t writev(const iovec* iov, int iovcnt) override;
+    bool isDatagram() const override { return true; }
+    size_t writeDatagrams(mmsghdr* msgs, size_t count) override;
+    // 输出环已满时等待客户端读取（客户端释放空间后通过通知FIFO唤醒）
+    void notifyWhenWritable(std::function<void()> cb) override;
+    // 恢复读取时环中可能已有数据，但客户端只在转换器等待时才发通知，需主动读取一次
+    void resumeReading() override;
+
+private:
+    void handleEvent(int fd, uint32_t events) override;
+    void drainInbound();
+    void notifySpace();
+    // 以下函数需持有 _mutex
+    bool clientAttached();
+    bool clientAlive();
+    void wakeClient();
+    void unmap();
+
+    const std::string _name;
+    const size_t _capacity;
+    int _notifyFd = -1;
+    ShmSegmentHeader* _header = nullptr;
+    size_t _mapSize = 0;
+    ShmRing _outbound;   // 转换器 -> 客户端，本端为生产者（持有 _mutex 访问）
+    ShmRing _inbound;    // 客户端 -> 转换器，本端为消费者（仅在事件循环线程访问）
+    std::function<void()> _spaceCallback;   // 等待输出空间的回调（持有 _mutex 访问）
+};
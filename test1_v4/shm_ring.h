@@ -0,0 +1,218 @@
+// shm_ring.h
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <climits>
+#include <string>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <time.h>
+
+// 共享内存环形队列：转换器与同机进程之间的数据通道（shm 端点与 shm_client.h 共用此布局）
+// 段文件 /dev/shm/<name>：段头 + 两个单生产者/单消费者环
+//   rings[0]：转换器 -> 客户端    rings[1]：客户端 -> 转换器
+// 每条消息 = 8字节记录头（4字节长度）+ 负载，按8字节对齐且不跨越环尾（放不下时写入跳过标记回到环首），
+// 消费者可直接引用消息内存，无需拷贝
+// 唤醒：消费者/生产者等待前置位等待标记，对端只有看到标记时才发起唤醒系统调用
+//   转换器一侧等待 FIFO /dev/shm/<name>.notify（可注册到 epoll），客户端一侧等待 futex
+
+constexpr uint32_t kShmMagic = 0x53484d52;   // "SHMR"
+constexpr uint32_t kShmVersion = 1;
+constexpr size_t kShmMaxMessage = 64 * 1024;
+constexpr size_t kShmDefaultCapacity = 1024 * 1024;
+constexpr size_t kShmAlign = 64;
+
+struct ShmRingControl {
+    alignas(kShmAlign) std::atomic<uint64_t> head;       // 生产者写位置
+    alignas(kShmAlign) std::atomic<uint64_t> tail;       // 消费者读位置
+    alignas(kShmAlign) std::atomic<uint32_t> data_waiting;    // 消费者等待数据
+    std::atomic<uint32_t> space_waiting;                      // 生产者等待空间
+};
+
+struct ShmSegmentHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t capacity;                  // 每个环的数据区大小（2的幂）
+    std::atomic<uint32_t> closed;       // 转换器已关闭端点
+    std::atomic<int32_t> client_pid;    // 已连接客户端的进程号，0 表示无客户端
+    ShmRingControl rings[2];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "shared memory atomics must be lock free");
+
+inline size_t shmHeaderSize() {
+    return (sizeof(ShmSegmentHeader) + kShmAlign - 1) & ~(kShmAlign - 1);
+}
+
+inline size_t shmSegmentSize(size_t capacity) {
+    return shmHeaderSize() + 2 * capacity;
+}
+
+// 段文件位于 /dev/shm/<name>，通知 FIFO 位于 /dev/shm/<name>.notify
+inline std::string shmNotifyPath(const std::string& name) {
+    return "/dev/shm/" + name + ".notify";
+}
+
+inline void shmFutexWait(std::atomic<uint32_t>* word, uint32_t expected, int timeoutMs) {
+    timespec ts{};
+    timespec* timeout = nullptr;
+    if (timeoutMs >= 0) {
+        ts.tv_sec = timeoutMs / 1000;
+        ts.tv_nsec = static_cast<long>(timeoutMs % 1000) * 1000000;
+        timeout = &ts;
+    }
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, expected, timeout, nullptr, 0);
+}
+
+inline void shmFutexWake(std::atomic<uint32_t>* word) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+// 单个环的操作视图：每个进程各自持有，缓存的对端索引只在本进程内使用
+class ShmRing {
+public:
+    static constexpr uint32_t kSkipMarker = UINT32_MAX;
+    static constexpr size_t kRecordHeaderSize = 8;
+
+    ShmRing() = default;
+    ShmRing(ShmRingControl* control, uint8_t* data, size_t capacity)
+        : control_(control), data_(data), capacity_(capacity), mask_(capacity - 1) {}
+
+    // ---- 生产者 ----
+
+    // 写入一条由多段组成的消息，空间不足返回 false
+    bool push(const iovec* iov, int iovcnt, size_t len) {
+        const uint64_t head = control_->head.load(std::memory_order_relaxed);
+        const size_t offset = head & mask_;
+        const size_t footprint = recordFootprint(len);
+        // 放不下时先用跳过标记填满环尾
+        const size_t skip = skipBytes(head, footprint);
+        if (!hasSpace(head, skip + footprint)) return false;
+
+        if (skip > 0) {
+            writeHeader(offset, kSkipMarker);
+        }
+        const size_t start = (head + skip) & mask_;
+        writeHeader(start, static_cast<uint32_t>(len));
+        uint8_t* dst = data_ + start + kRecordHeaderSize;
+        for (int i = 0; i < iovcnt; ++i) {
+            std::memcpy(dst, iov[i].iov_base, iov[i].iov_len);
+            dst += iov[i].iov_len;
+        }
+        control_->head.store(head + skip + footprint, std::memory_order_release);
+        return true;
+    }
+
+    // 写入后调用：消费者正在等待时返回 true，由调用方唤醒
+    bool consumerNeedsWake() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return control_->data_waiting.load(std::memory_order_relaxed) != 0 &&
+               control_->data_waiting.exchange(0, std::memory_order_relaxed) != 0;
+    }
+
+    // 等待空间前调用：置位等待标记后仍没有 len 字节的空间时返回 true（可以进入等待）
+    bool prepareWaitSpace(size_t len) {
+        control_->space_waiting.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const uint64_t head = control_->head.load(std::memory_order_relaxed);
+        const size_t footprint = recordFootprint(len);
+        cached_tail_ = control_->tail.load(std::memory_order_acquire);
+        if (capacity_ - (head - cached_tail_) >= skipBytes(head, footprint) + footprint) {
+            control_->space_waiting.store(0, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    // ---- 消费者 ----
+
+    // 依次读取消息（不释放），无消息或下一条消息超过 limit 字节时返回 nullptr（不消费该消息）
+    // 消息内存在 release() 之前有效
+    const uint8_t* next(size_t& len, size_t limit = SIZE_MAX) {
+        while (true) {
+            if (read_ == cached_head_) {
+                cached_head_ = control_->head.load(std::memory_order_acquire);
+                if (read_ == cached_head_) return nullptr;
+            }
+            const size_t offset = read_ & mask_;
+            uint32_t size;
+            std::memcpy(&size, data_ + offset, sizeof(size));
+            if (size == kSkipMarker) {
+                read_ += capacity_ - offset;
+                continue;
+            }
+            if (size > limit) return nullptr;
+            len = size;
+            read_ += recordFootprint(size);
+            return data_ + offset + kRecordHeaderSize;
+        }
+    }
+
+    // 释放 next() 已读取的消息，生产者正在等待空间时返回 true，由调用方唤醒
+    bool release() {
+        if (control_->tail.load(std::memory_order_relaxed) == read_) return false;
+        control_->tail.store(read_, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return control_->space_waiting.load(std::memory_order_relaxed) != 0 &&
+               control_->space_waiting.exchange(0, std::memory_order_relaxed) != 0;
+    }
+
+    // 等待数据前调用：置位等待标记后仍没有数据时返回 true（可以进入等待）
+    bool prepareWaitData() {
+        control_->data_waiting.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (control_->head.load(std::memory_order_acquire) != read_) {
+            control_->data_waiting.store(0, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    // 丢弃全部未读消息（新客户端连接时清理上一个客户端遗留的数据），返回值同 release()
+    bool discardAll() {
+        read_ = control_->head.load(std::memory_order_acquire);
+        cached_head_ = read_;
+        return release();
+    }
+
+    // 从当前共享索引重新同步本地游标（attach 时调用）
+    void sync() {
+        read_ = control_->tail.load(std::memory_order_acquire);
+        cached_head_ = read_;
+        cached_tail_ = read_;
+    }
+
+    ShmRingControl* control() const { return control_; }
+    static size_t recordFootprint(size_t len) {
+        return (kRecordHeaderSize + len + 7) & ~static_cast<size_t>(7);
+    }
+
+private:
+    size_t skipBytes(uint64_t head, size_t footprint) const {
+        const size_t offset = head & mask_;
+        return (capacity_ - offset < footprint) ? capacity_ - offset : 0;
+    }
+
+    bool hasSpace(uint64_t head, size_t need) {
+        if (capacity_ - (head - cached_tail_) >= need) return true;
+        cached_tail_ = control_->tail.load(std::memory_order_acquire);
+        return capacity_ - (head - cached_tail_) >= need;
+    }
+
+    void writeHeader(size_t offset, uint32_t size) {
+        std::memcpy(data_ + offset, &size, sizeof(size));
+    }
+
+    ShmRingControl* control_ = nullptr;
+    uint8_t* data_ = nullptr;
+    size_t capacity_ = 0;
+    size_t mask_ = 0;
+    uint64_t cached_tail_ = 0;   // 生产者缓存的读位置
+    uint64_t cached_head_ = 0;   // 消费者缓存的写位置
+    uint64_t read_ = 0;          // 消费者本地读游标（release 时发布）
+};
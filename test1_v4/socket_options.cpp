@@ -0,0 +1,93 @@
+#include "socket_options.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <cerrno>
+#include <cstring>
+
+static void appendError(std::string& errors, const std::string& error) {
+    if (!errors.empty()) errors += "; ";
+    errors += error;
+}
+
+static void setInt(int fd, int level, int name, int value, const char* label, std::string& errors) {
+    if (setsockopt(fd, level, name, &value, sizeof(value)) < 0) {
+        appendError(errors, std::string(label) + ": " + strerror(errno));
+    }
+}
+
+// 缓冲区大小：先尝试不受系统上限约束的 *FORCE 选项（需 CAP_NET_ADMIN），失败时退回普通选项
+// 内核记录的值为设置值的两倍（含簿记开销），读回后小于请求值说明被系统上限截断
+static void setBuffer(int fd, int forceName, int name, uint32_t bytes, const char* label,
+                      const char* sysctl, std::string& errors) {
+    int value = static_cast<int>(bytes);
+    if (setsockopt(fd, SOL_SOCKET, forceName, &value, sizeof(value)) == 0) return;
+    if (setsockopt(fd, SOL_SOCKET, name, &value, sizeof(value)) < 0) {
+        appendError(errors, std::string(label) + ": " + strerror(errno));
+        return;
+    }
+
+    int actual = 0;
+    socklen_t len = sizeof(actual);
+    if (getsockopt(fd, SOL_SOCKET, name, &actual, &len) == 0 && static_cast<uint32_t>(actual) / 2 < bytes) {
+        appendError(errors, std::string(label) + " capped at " + std::to_string(actual / 2) +
+                            " bytes by " + sysctl);
+    }
+}
+
+std::string applySocketOptions(int fd, const SocketOptions& options) {
+    std::string errors;
+    if (options.empty()) return errors;
+
+    int domain = 0;
+    int protocol = 0;
+    socklen_t len = sizeof(domain);
+    getsockopt(fd, SOL_SOCKET, SO_DOMAIN, &domain, &len);
+    len = sizeof(protocol);
+    getsockopt(fd, SOL_SOCKET, SO_PROTOCOL, &protocol, &len);
+    const bool tcp = protocol == IPPROTO_TCP;
+
+    if (options.rcvbuf > 0) {
+        setBuffer(fd, SO_RCVBUFFORCE, SO_RCVBUF, options.rcvbuf, "SO_RCVBUF", "net.core.rmem_max", errors);
+    }
+    if (options.sndbuf > 0) {
+        setBuffer(fd, SO_SNDBUFFORCE, SO_SNDBUF, options.sndbuf, "SO_SNDBUF", "net.core.wmem_max", errors);
+    }
+    if (options.busy_poll_usec > 0) {
+        setInt(fd, SOL_SOCKET, SO_BUSY_POLL, static_cast<int>(options.busy_poll_usec), "SO_BUSY_POLL", errors);
+    }
+    if (options.priority > 0) {
+        setInt(fd, SOL_SOCKET, SO_PRIORITY, static_cast<int>(options.priority), "SO_PRIORITY", errors);
+    }
+    if (options.ip_tos > 0 && domain == AF_INET) {
+        setInt(fd, IPPROTO_IP, IP_TOS, static_cast<int>(options.ip_tos), "IP_TOS", errors);
+    }
+    if (!tcp) return errors;
+
+    if (options.tcp_nodelay) {
+        setInt(fd, IPPROTO_TCP, TCP_NODELAY, 1, "TCP_NODELAY", errors);
+    }
+    if (options.tcp_quickack) {
+        setInt(fd, IPPROTO_TCP, TCP_QUICKACK, 1, "TCP_QUICKACK", errors);
+    }
+    if (options.tcp_user_timeout_ms > 0) {
+        setInt(fd, IPPROTO_TCP, TCP_USER_TIMEOUT, static_cast<int>(options.tcp_user_timeout_ms),
+               "TCP_USER_TIMEOUT", errors);
+    }
+    if (options.keepalive) {
+        setInt(fd, SOL_SOCKET, SO_KEEPALIVE, 1, "SO_KEEPALIVE", errors);
+        if (options.keepalive_idle_sec > 0) {
+            setInt(fd, IPPROTO_TCP, TCP_KEEPIDLE, static_cast<int>(options.keepalive_idle_sec),
+                   "TCP_KEEPIDLE", errors);
+        }
+        if (options.keepalive_interval_sec > 0) {
+            setInt(fd, IPPROTO_TCP, TCP_KEEPINTVL, static_cast<int>(options.keepalive_interval_sec),
+                   "TCP_KEEPINTVL", errors);
+        }
+        if (options.keepalive_count > 0) {
+            setInt(fd, IPPROTO_TCP, TCP_KEEPCNT, static_cast<int>(options.keepalive_count),
+                   "TCP_KEEPCNT", errors);
+        }
+    }
+    return errors;
+}
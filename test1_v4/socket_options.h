@@ -0,0 +1,45 @@
+// socket_options.h
+#pragma once
+#include <cstdint>
+#include <string>
+
+// 套接字调优参数：在端点创建socket时设置（0 / false 表示保持内核默认值）
+// 只设置适用于该socket的选项：TCP_* 与保活只用于TCP，IP_TOS 只用于IPv4
+// TCP服务端设置在监听socket上，接受的连接由内核继承（TCP_QUICKACK 除外，见 rearmQuickAck）
+struct SocketOptions {
+    uint32_t rcvbuf = 0;                  // SO_RCVBUF（字节，受 net.core.rmem_max 限制，有 CAP_NET_ADMIN 时不受限）
+    uint32_t sndbuf = 0;                  // SO_SNDBUF（字节，受 net.core.wmem_max 限制）
+    bool tcp_nodelay = false;             // TCP_NODELAY：关闭 Nagle 算法
+    bool tcp_quickack = false;            // TCP_QUICKACK：立即确认，不延迟ACK
+    uint32_t busy_poll_usec = 0;          // SO_BUSY_POLL：阻塞读取时忙轮询网卡队列的时间（微秒）
+    uint32_t priority = 0;                // SO_PRIORITY：发送队列优先级（0-6，更高需 CAP_NET_ADMIN）
+    uint32_t tcp_user_timeout_ms = 0;     // TCP_USER_TIMEOUT：已发送数据未确认多久后断开连接
+    uint32_t ip_tos = 0;                  // IP_TOS：服务类型/DSCP 字节
+    bool keepalive = false;               // SO_KEEPALIVE：TCP保活探测
+    uint32_t keepalive_idle_sec = 0;      // TCP_KEEPIDLE：空闲多久后开始探测
+    uint32_t keepalive_interval_sec = 0;  // TCP_KEEPINTVL：探测间隔
+    uint32_t keepalive_count = 0;         // TCP_KEEPCNT：探测失败多少次后断开
+
+    bool empty() const { return *this == SocketOptions{}; }
+
+    bool operator==(const SocketOptions& other) const {
+        return rcvbuf == other.rcvbuf &&
+               sndbuf == other.sndbuf &&
+               tcp_nodelay == other.tcp_nodelay &&
+               tcp_quickack == other.tcp_quickack &&
+               busy_poll_usec == other.busy_poll_usec &&
+               priority == other.priority &&
+               tcp_user_timeout_ms == other.tcp_user_timeout_ms &&
+               ip_tos == other.ip_tos &&
+               keepalive == other.keepalive &&
+               keepalive_idle_sec == other.keepalive_idle_sec &&
+               keepalive_interval_sec == other.keepalive_interval_sec &&
+               keepalive_count == other.keepalive_count;
+    }
+    bool operator!=(const SocketOptions& other) const {
+        return !(*this == other);
+    }
+};
+
+// 在 fd 上设置调优参数，返回失败或未完全生效的选项说明（全部成功时为空字符串）
+std::string applySocketOptions(int fd, const SocketOptions& options);
@@ -3,14 +3,19 @@
 #include <fcntl.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <cstring>
 #include <stdexcept>
 #include <system_error>
+#include <algorithm>
 
-TcpClientEndpoint::TcpClientEndpoint(const std::string& host, uint16_t port, int reconnect_interval)
-    : _host(host), _port(port), _reconnect_interval(reconnect_interval),
-      _last_reconnect_time(std::chrono::steady_clock::now()) {}
+TcpClientEndpoint::TcpClientEndpoint(const std::string& host, uint16_t port,
+                                     uint32_t reconnectMinMs, uint32_t reconnectMaxMs)
+    : _host(host), _port(port),
+      _reconnectMinMs(reconnectMinMs > 0 ? reconnectMinMs : kDefaultReconnectMinMs),
+      _reconnectMaxMs(std::max(reconnectMaxMs > 0 ? reconnectMaxMs : kDefaultReconnectMaxMs, _reconnectMinMs)),
+      _jitter(std::random_device{}()) {}
 
 TcpClientEndpoint::~TcpClientEndpoint() {
     close();
@@ -18,127 +23,131 @@ TcpClientEndpoint::~TcpClientEndpoint() {
 
 bool TcpClientEndpoint::open() {
     if (isRunning()) return true;
-    
+
+    attachLoop();
+    _reconnectTimer = 0;
+    _reconnectAttempts = 0;
     setState(State::CONNECTING);
-    startThread();
+    runInLoop([this] { startConnect(); });
     return true;
 }
 
 void TcpClientEndpoint::close() {
-    stopThread();
+    // 未触发的重连定时器随事件循环解绑失效
+    detachLoop();
     resetConnection();
     setState(State::DISCONNECTED);
 }
 
 void TcpClientEndpoint::resetConnection() {
-    // 从 epoll 中移除 socket 监控
-    if (_epollFd >= 0 && _socketFd >= 0) {
-        epoll_ctl(_epollFd, EPOLL_CTL_DEL, _socketFd, nullptr);
-    }
-    
-    if (_socketFd >= 0) {
-        ::close(_socketFd);
+    int fd;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        fd = _socketFd;
         _socketFd = -1;
+        _connecting = false;
+    }
+    // 从事件循环中移除 socket 监控
+    // removeFd 会直接调用等待该fd可写的回调（如 splice 续传会调用 spliceFrom 并加 _mutex），不能持锁调用；
+    // 此时 _socketFd 已置为 -1，spliceFrom 返回 ENOTCONN，管道中的数据被丢弃
+    if (fd >= 0) {
+        removeFd(fd);
+        ::close(fd);
     }
-    
-    _connecting = false;
 }
 
 void TcpClientEndpoint::write(const uint8_t* data, size_t len) {
-    if (!isConnected()) return;
-    
+    iovec iov{const_cast<uint8_t*>(data), len};
+    writev(&iov, 1);
+}
+
+size_t TcpClientEndpoint::writev(const iovec* iov, int iovcnt) {
+    const size_t total = totalLength(iov, iovcnt);
+    if (!isConnected()) return total; // 未连接时丢弃
+
+    msghdr msg{};
+    msg.msg_iov = const_cast<iovec*>(iov);
+    msg.msg_iovlen = iovcnt;
+
     std::lock_guard<std::mutex> lock(_mutex);
-    if (send(_socketFd, data, len, MSG_NOSIGNAL) < 0) {
-        logError("Send failed: " + std::string(strerror(errno)));
-        setState(State::ERROR);
-        handleDisconnectEvent();
+    if (_socketFd < 0) return total;
+
+    ssize_t sent = sendmsg(_socketFd, &msg, MSG_NOSIGNAL);
+    if (sent >= 0) {
+        return static_cast<size_t>(sent);
+    }
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        return 0; // 发送缓冲区已满，等待可写后重试
     }
+
+    logWriteError("Send failed: " + std::string(strerror(errno)));
+    setState(State::ERROR);
+    // 断开处理需在事件循环线程中进行
+    runInLoop([this] { handleDisconnectEvent(); });
+    return total;
+}
+
+void TcpClientEndpoint::setCorked(bool corked) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_socketFd < 0) return;
+
+    int opt = corked ? 1 : 0;
+    setsockopt(_socketFd, IPPROTO_TCP, TCP_CORK, &opt, sizeof(opt));
+}
+
+bool TcpClientEndpoint::canSpliceTo() {
+    return isConnected();
 }
 
-void TcpClientEndpoint::run() {
-    while (isRunning()) {
-        // 创建或重新创建 epoll 实例
-        if (_epollFd < 0) {
-            _epollFd = epoll_create1(0);
-            if (_epollFd < 0) {
-                logError("Epoll creation failed: " + std::string(strerror(errno)));
-                setState(State::ERROR);
-                std::this_thread::sleep_for(std::chrono::seconds(1));
-                continue;
-            }
-        }
-
-        // 处理重连逻辑
-        if (!isConnected() && !_connecting && !_reconnect_pending) {
-            auto now = std::chrono::steady_clock::now();
-            auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
-                now - _last_reconnect_time).count();
-            
-            if (elapsed >= _reconnect_interval) {
-                logMessage("Attempting to connect...");
-                setState(State::CONNECTING);
-                if (tryConnect()) {
-                    _connecting = true;
-                } else {
-                    // 连接失败，等待下一次重连
-                    _last_reconnect_time = now;
-                    _reconnect_pending = true;
-                }
-            }
-        }
-
-        // 事件循环 - 仅在有有效 epoll 描述符时执行
-        if (_epollFd >= 0) {
-            epoll_event events[2];
-            int numEvents = epoll_wait(_epollFd, events, 2, 100); // 100ms超时
-            
-            if (numEvents < 0) {
-                if (errno == EBADF) {
-                    // epoll 描述符无效，重置连接
-                    logError("Epoll_wait encountered bad file descriptor. Resetting connection.");
-                    resetConnection();
-                    continue;
-                } else if (errno != EINTR) {
-                    logError("Epoll_wait error: " + std::string(strerror(errno)));
-                }
-                continue;
-            }
-
-            for (int i = 0; i < numEvents; ++i) {
-                // 处理连接事件
-                if (events[i].events & EPOLLOUT && _connecting) {
-                    handleConnectEvent();
-                }
-                // 处理断开事件
-                else if (events[i].events & (EPOLLHUP | EPOLLERR | EPOLLRDHUP)) {
-                    handleDisconnectEvent();
-                }
-                // 处理数据事件
-                else if (events[i].events & EPOLLIN) {
-                    handleSocketData();
-                }
-            }
-        }
-
-        // 处理重连等待状态
-        if (_reconnect_pending) {
-            auto now = std::chrono::steady_clock::now();
-            auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
-                now - _last_reconnect_time).count();
-            
-            if (elapsed >= _reconnect_interval) {
-                _reconnect_pending = false;
-            } else {
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            }
-        }
+ssize_t TcpClientEndpoint::spliceFrom(int pipeFd, size_t len) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!isConnected() || _socketFd < 0) {
+        errno = ENOTCONN;
+        return -1;
     }
-    
-    // 线程退出前清理资源
-    resetConnection();
-    if (_epollFd >= 0) {
-        ::close(_epollFd);
-        _epollFd = -1;
+
+    ssize_t n = splice(pipeFd, nullptr, _socketFd, nullptr, len, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    if (n < 0 && errno != EAGAIN) {
+        const int err = errno;
+        logWriteError("Splice failed: " + std::string(strerror(err)));
+        runInLoop([this] { handleDisconnectEvent(); });
+        errno = err;
+    }
+    return n;
+}
+
+int TcpClientEndpoint::outputFd() const {
+    return isConnected() ? _socketFd : -1;
+}
+
+void TcpClientEndpoint::handleEvent(int fd, uint32_t events) {
+    if (fd != _socketFd) return;
+
+    // 处理连接事件
+    if (events & EPOLLOUT && _connecting) {
+        handleConnectEvent();
+    }
+    // 处理断开事件
+    else if (events & (EPOLLHUP | EPOLLERR | EPOLLRDHUP)) {
+        handleDisconnectEvent();
+    }
+    // 处理数据事件
+    else if (events & EPOLLIN) {
+        handleSocketData();
+    }
+}
+
+void TcpClientEndpoint::startConnect() {
+    if (isConnected() || _connecting) return;
+
+    logMessage("Attempting to connect...");
+    setState(State::CONNECTING);
+    if (tryConnect()) {
+        _connecting = true;
+    } else {
+        // 连接失败，等待下一次重连
+        resetConnection();
+        scheduleReconnect();
     }
 }
 
@@ -147,34 +156,33 @@ bool TcpClientEndpoint::tryConnect() {
         resetConnection(); // 确保之前的连接已关闭
     }
 
-    _socketFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
-    if (_socketFd < 0) {
-        logError("Socket creation failed: " + std::string(strerror(errno)));
+    sockaddr_storage serverAddr{};
+    const socklen_t addrLen = serverAddress(serverAddr);
+    if (addrLen == 0) {
+        logError("Invalid address: " + serverName());
         return false;
     }
 
-    sockaddr_in serverAddr{};
-    serverAddr.sin_family = AF_INET;
-    serverAddr.sin_port = htons(_port);
-    
-    if (inet_pton(AF_INET, _host.c_str(), &serverAddr.sin_addr) <= 0) {
-        logError("Invalid address: " + _host);
+    int fd = socket(serverAddr.ss_family, socketType() | SOCK_NONBLOCK, 0);
+    if (fd < 0) {
+        logError("Socket creation failed: " + std::string(strerror(errno)));
         return false;
     }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _socketFd = fd;
+    }
+    tuneSocket(fd);
 
     // 非阻塞连接
-    int result = connect(_socketFd, (sockaddr*)&serverAddr, sizeof(serverAddr));
+    int result = connect(_socketFd, (sockaddr*)&serverAddr, addrLen);
     if (result < 0 && errno != EINPROGRESS) {
         logError("Connect failed: " + std::string(strerror(errno)));
         return false;
     }
 
     // 监控连接状态
-    epoll_event event{};
-    event.events = EPOLLOUT | EPOLLERR | EPOLLHUP;
-    event.data.fd = _socketFd;
-    
-    if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, _socketFd, &event) < 0) {
+    if (!addFd(_socketFd, EPOLLOUT | EPOLLERR | EPOLLHUP)) {
         logError("Epoll_ctl failed: " + std::string(strerror(errno)));
         return false;
     }
@@ -182,6 +190,18 @@ bool TcpClientEndpoint::tryConnect() {
     return true;
 }
 
+socklen_t TcpClientEndpoint::serverAddress(sockaddr_storage& addr) const {
+    auto& in = reinterpret_cast<sockaddr_in&>(addr);
+    in.sin_family = AF_INET;
+    in.sin_port = htons(_port);
+    if (inet_pton(AF_INET, _host.c_str(), &in.sin_addr) <= 0) return 0;
+    return sizeof(in);
+}
+
+std::string TcpClientEndpoint::serverName() const {
+    return _host + ":" + std::to_string(_port);
+}
+
 void TcpClientEndpoint::handleConnectEvent() {
     int error = 0;
     socklen_t len = sizeof(error);
@@ -197,35 +217,66 @@ void TcpClientEndpoint::handleConnectEvent() {
         return;
     }
 
-    // 连接成功，更新epoll监控事件
-    epoll_event event{};
-    event.events = EPOLLIN | EPOLLRDHUP | EPOLLERR | EPOLLHUP;
-    event.data.fd = _socketFd;
-    
-    if (epoll_ctl(_epollFd, EPOLL_CTL_MOD, _socketFd, &event) < 0) {
+    // 连接成功，更新监控事件
+    if (!modifyFd(_socketFd, EPOLLIN | EPOLLRDHUP | EPOLLERR | EPOLLHUP)) {
         logError("Epoll_ctl modify failed: " + std::string(strerror(errno)));
         handleDisconnectEvent();
         return;
     }
 
     _connecting = false;
+    _reconnectAttempts = 0;
     setState(State::CONNECTED);
-    logMessage("Connected to " + _host + ":" + std::to_string(_port));
+    logMessage("Connected to " + serverName());
 }
 
 void TcpClientEndpoint::handleDisconnectEvent() {
+    if (_socketFd < 0) return; // 已处理过（如发送失败与HUP事件同时到达）
+
     logMessage("Connection closed");
     resetConnection();
     setState(State::DISCONNECTED);
-    _last_reconnect_time = std::chrono::steady_clock::now();
-    _reconnect_pending = true; // 进入重连等待状态
+    scheduleReconnect(); // 进入重连等待状态
+}
+
+void TcpClientEndpoint::scheduleReconnect() {
+    _reconnects.add();
+    cancelTimer(_reconnectTimer);
+    _reconnectTimer = runAfter(nextBackoffMs(), [this] {
+        _reconnectTimer = 0;
+        startConnect();
+    });
+}
+
+// 指数退避 + 抖动：取 [间隔/2, 间隔] 内的随机值，避免大量端点同时重连
+uint64_t TcpClientEndpoint::nextBackoffMs() {
+    uint64_t interval = _reconnectMinMs;
+    for (uint32_t i = 0; i < _reconnectAttempts && interval < _reconnectMaxMs; ++i) {
+        interval *= 2;
+    }
+    interval = std::min<uint64_t>(interval, _reconnectMaxMs);
+    ++_reconnectAttempts;
+
+    const uint64_t half = interval / 2;
+    return half + _jitter() % (interval - half + 1);
 }
 
 void TcpClientEndpoint::handleSocketData() {
+    switch (trySplice(_socketFd)) {
+        case SpliceResult::Handled:
+            return;
+        case SpliceResult::Closed:
+            handleDisconnectEvent();
+            return;
+        case SpliceResult::NotHandled:
+            break;
+    }
+
     uint8_t buffer[4096];
     ssize_t bytesRead = recv(_socketFd, buffer, sizeof(buffer), 0);
     
     if (bytesRead > 0) {
+        rearmQuickAck(_socketFd);
         processData(buffer, bytesRead);
     } else if (bytesRead == 0) {
         // 对端关闭连接
@@ -234,4 +285,4 @@ void TcpClientEndpoint::handleSocketData() {
         logError("Receive error: " + std::string(strerror(errno)));
         handleDisconnectEvent();
     }
-}
\ No newline at end of file
+}
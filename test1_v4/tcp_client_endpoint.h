@@ -1,33 +1,58 @@
 #pragma once
 #include "endpoint.h"
 #include <sys/epoll.h>
-#include <chrono>
-#include <thread>
 #include <atomic>
+#include <random>
 
 class TcpClientEndpoint : public Endpoint {
 public:
-    TcpClientEndpoint(const std::string& host, uint16_t port, int reconnect_interval = 1);
+    static constexpr uint32_t kDefaultReconnectMinMs = 100;
+    static constexpr uint32_t kDefaultReconnectMaxMs = 30000;
+
+    // 重连退避：首次间隔 reconnectMinMs，每次失败翻倍直到 reconnectMaxMs，并加入随机抖动（0 表示默认值）
+    TcpClientEndpoint(const std::string& host, uint16_t port,
+                      uint32_t reconnectMinMs = 0, uint32_t reconnectMaxMs = 0);
     ~TcpClientEndpoint() override;
     
     bool open() override;
     void close() override;
     void write(const uint8_t* data, size_t len) override;
+    size_t writev(const iovec* iov, int iovcnt) override;
+    void setCorked(bool corked) override;
+    bool supportsSplice() const override { return true; }
+    bool canSpliceTo() override;
+    ssize_t spliceFrom(int pipeFd, size_t len) override;
+
+protected:
+    // 服务器地址（返回地址长度，地址无效时返回0）与socket类型，派生类可改用其他地址族
+    virtual socklen_t serverAddress(sockaddr_storage& addr) const;
+    virtual int socketType() const { return SOCK_STREAM; }
+    // 服务器的可读名称（用于日志）
+    virtual std::string serverName() const;
+    // socket可读时在事件循环线程中调用
+    virtual void handleSocketData();
+    void handleDisconnectEvent();
+
+    int _socketFd = -1;
 
 private:
-    void run() override;
+    void handleEvent(int fd, uint32_t events) override;
+    int outputFd() const override;
+    void startConnect();
     bool tryConnect();
-    void handleSocketData();
     void resetConnection();
     void handleConnectEvent();
-    void handleDisconnectEvent();
+    void scheduleReconnect();
+    uint64_t nextBackoffMs();
 
     const std::string _host;
     const uint16_t _port;
-    const int _reconnect_interval; // 重连间隔（秒）
-    int _socketFd = -1;
-    int _epollFd = -1;
-    std::chrono::steady_clock::time_point _last_reconnect_time;
+    const uint32_t _reconnectMinMs;
+    const uint32_t _reconnectMaxMs;
+
+    // 重连定时器由所属事件循环的时间轮驱动，空闲断开时不产生任何唤醒（仅在事件循环线程访问）
+    EventLoop::TimerId _reconnectTimer = 0;
+    uint32_t _reconnectAttempts = 0;    // 连续失败次数，连接成功后清零
+    std::minstd_rand _jitter;
     std::atomic<bool> _connecting{false}; // 使用原子操作确保线程安全
-    std::atomic<bool> _reconnect_pending{false}; // 标记重连等待状态
-};
\ No newline at end of file
+};
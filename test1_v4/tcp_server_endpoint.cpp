@@ -3,29 +3,102 @@
 #include <fcntl.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <cstring>
 #include <stdexcept>
+#include <algorithm>
+#include <vector>
 
-TcpServerEndpoint::TcpServerEndpoint(uint16_t port) : _port(port) {}
+// 客户端fd的常驻事件；发送队列非空时额外关注 EPOLLOUT
+static constexpr uint32_t kClientEvents = EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR;
+// 每次续写最多合并的队列块数
+static constexpr int kMaxFlushIov = 64;
+// 每次监听socket可读时最多接受的连接数，避免连接风暴期间长时间占用事件循环
+static constexpr int kMaxAcceptPerEvent = 64;
+
+TcpServerEndpoint::TcpServerEndpoint(uint16_t port, SlowClientPolicy policy, size_t maxQueueBytes,
+                                     size_t acceptShards, int listenBacklog)
+    : _listenBacklog(listenBacklog > 0 ? listenBacklog : SOMAXCONN),
+      _port(port), _policy(policy),
+      _maxQueueBytes(maxQueueBytes > 0 ? maxQueueBytes : kDefaultSendQueueBytes),
+      _acceptShards(acceptShards > 0 ? acceptShards : 1),
+      _reusePort(_acceptShards > 1) {}
 
 TcpServerEndpoint::~TcpServerEndpoint() {
     close();
 }
 
+TcpServerEndpoint::SlowClientPolicy TcpServerEndpoint::parsePolicy(const std::string& name) {
+    if (name.empty() || name == "disconnect") return SlowClientPolicy::Disconnect;
+    if (name == "drop_oldest") return SlowClientPolicy::DropOldest;
+    if (name == "block") return SlowClientPolicy::Block;
+    throw std::runtime_error("Unknown slow client policy: " + name);
+}
+
 bool TcpServerEndpoint::open() {
     if (isRunning()) return true;
 
+    _serverFd = createListenSocket();
+    if (_serverFd < 0) return false;
+
+    // 绑定事件循环并注册服务器socket
+    attachLoop();
+    if (!addFd(_serverFd, EPOLLIN, false)) {
+        logError("Epoll_ctl failed: " + std::string(strerror(errno)));
+        detachLoop();
+        ::close(_serverFd);
+        _serverFd = -1;
+        return false;
+    }
+
+    setState(State::CONNECTED);
+
+    if (_acceptShards > 1) {
+        if (_shards.empty()) {
+            for (size_t i = 1; i < _acceptShards; ++i) {
+                auto shard = std::make_unique<TcpServerEndpoint>(_port, _policy, _maxQueueBytes, 1, _listenBacklog);
+                shard->_reusePort = true;
+                shard->setSocketOptions(_socketOptions);
+                shard->setDataCallback([this](const uint8_t* data, size_t len) { deliver(data, len); });
+                shard->setLogCallback([this](const std::string& msg) { logMessage(msg); });
+                shard->setErrorCallback([this](const std::string& error) { logError(error); });
+                _shards.push_back(std::move(shard));
+            }
+        }
+        // 每个分片在 open() 时按轮询绑定到下一个事件循环
+        for (auto& shard : _shards) {
+            if (!shard->open()) {
+                logError("Accept shard failed to open on port " + std::to_string(_port));
+                close();
+                return false;
+            }
+        }
+        logMessage("TCP server listening on port " + std::to_string(_port) + " with " +
+                   std::to_string(_acceptShards) + " accept shards");
+    }
+    return true;
+}
+
+int TcpServerEndpoint::createListenSocket() {
     // 创建服务器socket
-    _serverFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
-    if (_serverFd < 0) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (fd < 0) {
         logError("Socket creation failed: " + std::string(strerror(errno)));
-        return false;
+        return -1;
     }
 
     // 设置端口复用
     int opt = 1;
-    setsockopt(_serverFd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    // 分片模式：各分片的监听socket绑定同一端口，由内核按连接散列分配
+    if (_reusePort && setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+        logError("Setsockopt SO_REUSEPORT failed: " + std::string(strerror(errno)));
+        ::close(fd);
+        return -1;
+    }
+    // 调优参数在 listen 之前设置（接收缓冲区影响窗口缩放协商），接受的连接继承这些设置
+    tuneSocket(fd);
 
     // 绑定端口
     sockaddr_in address{};
@@ -33,155 +106,465 @@ bool TcpServerEndpoint::open() {
     address.sin_addr.s_addr = INADDR_ANY;
     address.sin_port = htons(_port);
 
-    if (bind(_serverFd, (sockaddr*)&address, sizeof(address)) < 0) {
+    if (bind(fd, (sockaddr*)&address, sizeof(address)) < 0) {
         logError("Bind failed: " + std::string(strerror(errno)));
-        ::close(_serverFd);
-        _serverFd = -1;
-        return false;
+        ::close(fd);
+        return -1;
     }
 
     // 开始监听
-    if (listen(_serverFd, 5) < 0) {
+    if (listen(fd, _listenBacklog) < 0) {
         logError("Listen failed: " + std::string(strerror(errno)));
-        ::close(_serverFd);
-        _serverFd = -1;
-        return false;
-    }
-
-    // 创建epoll实例
-    _epollFd = epoll_create1(0);
-    if (_epollFd < 0) {
-        logError("Epoll creation failed: " + std::string(strerror(errno)));
-        ::close(_serverFd);
-        _serverFd = -1;
-        return false;
-    }
-
-    // 添加服务器socket到epoll
-    epoll_event event{};
-    event.events = EPOLLIN;
-    event.data.fd = _serverFd;
-    if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, _serverFd, &event) < 0) {
-        logError("Epoll_ctl failed: " + std::string(strerror(errno)));
-        ::close(_epollFd);
-        ::close(_serverFd);
-        _epollFd = -1;
-        _serverFd = -1;
-        return false;
+        ::close(fd);
+        return -1;
     }
+    return fd;
+}
 
-    setState(State::CONNECTED);
-    startThread();
-    return true;
+std::string TcpServerEndpoint::peerName(int clientFd, const sockaddr_storage& addr) const {
+    (void)clientFd;
+    const auto& in = reinterpret_cast<const sockaddr_in&>(addr);
+    char ip[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &in.sin_addr, ip, sizeof(ip));
+    return std::string(ip) + ":" + std::to_string(ntohs(in.sin_port));
 }
 
 void TcpServerEndpoint::close() {
-    stopThread();
-    
-    if (_epollFd >= 0) {
-        ::close(_epollFd);
-        _epollFd = -1;
+    for (auto& shard : _shards) {
+        shard->close();
     }
+    _blockedShard.store(nullptr, std::memory_order_relaxed);
+    detachLoop();
     
     if (_serverFd >= 0) {
         ::close(_serverFd);
         _serverFd = -1;
     }
     
+    std::lock_guard<std::mutex> lock(_mutex);
     for (auto& client : _clients) {
         ::close(client.first);
     }
     _clients.clear();
+    _blockedFd.store(-1, std::memory_order_relaxed);
     
     setState(State::DISCONNECTED);
 }
 
 void TcpServerEndpoint::write(const uint8_t* data, size_t len) {
+    iovec iov{const_cast<uint8_t*>(data), len};
+    writev(&iov, 1);
+}
+
+size_t TcpServerEndpoint::writev(const iovec* iov, int iovcnt) {
+    const size_t total = totalLength(iov, iovcnt);
+    size_t accepted = total;
+    std::vector<iovec> truncated;
+    if (_policy == SlowClientPolicy::Block) {
+        // 只接受所有分片的所有客户端队列都能容纳的部分，其余数据留在通道缓冲区等待可写
+        // （通道对同一目标串行调用 writev，计算与发送之间队列只会变短）
+        TcpServerEndpoint* limitShard = this;
+        accepted = blockLimit(total);
+        for (auto& shard : _shards) {
+            const size_t room = shard->blockLimit(total);
+            if (room < accepted) {
+                accepted = room;
+                limitShard = shard.get();
+            }
+        }
+        _blockedShard.store(accepted < total ? limitShard : nullptr, std::memory_order_relaxed);
+        // 保持消息边界的socket只能整条接受
+        if (accepted == 0 || (accepted < total && isDatagram())) return 0;
+
+        if (accepted < total) {
+            size_t left = accepted;
+            for (int i = 0; i < iovcnt && left > 0; ++i) {
+                const size_t n = std::min(left, iov[i].iov_len);
+                truncated.push_back(iovec{iov[i].iov_base, n});
+                left -= n;
+            }
+            iov = truncated.data();
+            iovcnt = static_cast<int>(truncated.size());
+        }
+    }
+
+    broadcast(iov, iovcnt, accepted);
+    for (auto& shard : _shards) {
+        shard->broadcast(iov, iovcnt, accepted);
+    }
+    return accepted;
+}
+
+size_t TcpServerEndpoint::blockLimit(size_t total) {
     std::lock_guard<std::mutex> lock(_mutex);
-    for (auto& client : _clients) {
-        if (send(client.first, data, len, MSG_NOSIGNAL) < 0) {
-            logError("Send failed to client: " + std::to_string(client.first));
+    size_t accepted = total;
+    int limitFd = -1;
+    for (const auto& client : _clients) {
+        if (client.second.closing) continue;
+        const size_t room = _maxQueueBytes - std::min(client.second.queued, _maxQueueBytes);
+        if (room < accepted) {
+            accepted = room;
+            limitFd = client.first;
         }
     }
+    _blockedFd.store(accepted < total ? limitFd : -1, std::memory_order_relaxed);
+    return accepted;
 }
-void TcpServerEndpoint::run() {
-    constexpr int MAX_EVENTS = 10;
-    epoll_event events[MAX_EVENTS];
-    
-    while (isRunning()) {
-        int numEvents = epoll_wait(_epollFd, events, MAX_EVENTS, 100);
-        if (numEvents < 0) {
-            if (errno != EINTR) {
-                logError("Epoll_wait error: " + std::string(strerror(errno)));
+
+void TcpServerEndpoint::broadcast(const iovec* iov, int iovcnt, size_t len) {
+    std::vector<int> slowClients;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto& client : _clients) {
+            if (client.second.closing) continue;
+            if (!sendToClient(client.first, client.second, iov, iovcnt, len)) {
+                client.second.closing = true;
+                client.second.queue.clear();
+                client.second.queued = 0;
+                slowClients.push_back(client.first);
             }
+        }
+    }
+
+    // 断开需在事件循环线程中进行（期间fd可能已被关闭并复用，以 closing 标记确认）
+    for (int fd : slowClients) {
+        runInLoop([this, fd] {
+            bool closing = false;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                auto it = _clients.find(fd);
+                closing = (it != _clients.end() && it->second.closing);
+            }
+            if (closing) closeClient(fd);
+        });
+    }
+}
+
+// 队列为空时直接发送，未发出的部分（或队列非空时的全部数据）进入客户端队列
+// 返回 false 表示该客户端应被断开
+bool TcpServerEndpoint::sendToClient(int clientFd, Client& client, const iovec* iov, int iovcnt, size_t len) {
+    size_t sent = 0;
+    if (client.queue.empty()) {
+        msghdr msg{};
+        msg.msg_iov = const_cast<iovec*>(iov);
+        msg.msg_iovlen = iovcnt;
+        ssize_t n = sendmsg(clientFd, &msg, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                logWriteError("Send failed to client " + clientName(clientFd, client) + ": " +
+                              std::string(strerror(errno)));
+                return false;
+            }
+            n = 0;
+        }
+        sent = static_cast<size_t>(n);
+    }
+
+    if (sent == len) return true;
+    return enqueue(clientFd, client, iov, iovcnt, sent, len);
+}
+
+bool TcpServerEndpoint::enqueue(int clientFd, Client& client, const iovec* iov, int iovcnt,
+                                size_t skip, size_t len) {
+    const size_t remaining = len - skip;
+    if (client.queued + remaining > _maxQueueBytes) {
+        if (_policy == SlowClientPolicy::Disconnect) {
+            logError("Client " + clientName(clientFd, client) + " send queue full (" +
+                     std::to_string(client.queued) + " bytes), disconnecting slow client");
+            return false;
+        }
+        if (_policy == SlowClientPolicy::DropOldest) {
+            if (!client.dropping) {
+                client.dropping = true;
+                logError("Client " + clientName(clientFd, client) + " send queue full (" +
+                         std::to_string(client.queued) + " bytes), dropping oldest data");
+            }
+            // 保留已部分发送的队首块，避免截断正在发送的数据
+            const size_t keep = client.offset > 0 ? 1 : 0;
+            while (client.queued + remaining > _maxQueueBytes && client.queue.size() > keep) {
+                auto victim = client.queue.begin() + keep;
+                client.queued -= victim->size();
+                client.queue.erase(victim);
+            }
+            if (client.queued + remaining > _maxQueueBytes) {
+                return true; // 新数据本身超过上限，直接丢弃
+            }
+        }
+        // Block 策略在 writev 中已按队列剩余空间限制了接受的数据量
+    }
+
+    std::string chunk;
+    chunk.reserve(remaining);
+    for (int i = 0; i < iovcnt; ++i) {
+        const size_t n = iov[i].iov_len;
+        if (skip >= n) {
+            skip -= n;
             continue;
         }
+        chunk.append(static_cast<const char*>(iov[i].iov_base) + skip, n - skip);
+        skip = 0;
+    }
+
+    const bool wasEmpty = client.queue.empty();
+    client.queued += chunk.size();
+    client.queue.push_back(std::move(chunk));
+    if (wasEmpty) {
+        // 开始关注可写事件，由事件循环续写
+        modifyFd(clientFd, kClientEvents | EPOLLOUT);
+    }
+    return true;
+}
+
+// 在事件循环线程中续写队列，返回 false 表示该客户端应被断开
+bool TcpServerEndpoint::flushQueue(int clientFd, Client& client) {
+    // 保持消息边界的socket每个队列块（一条消息）单独发送，流式socket合并发送
+    const bool perMessage = isDatagram();
+    const int maxIov = perMessage ? 1 : kMaxFlushIov;
+    const int rounds = perMessage ? kMaxFlushIov : 1;
+
+    for (int round = 0; round < rounds && !client.queue.empty(); ++round) {
+        iovec iov[kMaxFlushIov];
+        int iovcnt = 0;
+        size_t offset = client.offset;
+        for (auto it = client.queue.begin(); it != client.queue.end() && iovcnt < maxIov; ++it) {
+            iov[iovcnt].iov_base = const_cast<char*>(it->data()) + offset;
+            iov[iovcnt].iov_len = it->size() - offset;
+            ++iovcnt;
+            offset = 0;
+        }
+
+        msghdr msg{};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = iovcnt;
+        ssize_t n = sendmsg(clientFd, &msg, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return true;
+            logWriteError("Send failed to client " + clientName(clientFd, client) + ": " +
+                          std::string(strerror(errno)));
+            return false;
+        }
 
-        for (int i = 0; i < numEvents; ++i) {
-            if (events[i].data.fd == _serverFd) {
-                handleNewConnection();
-            } else {
-                // 检查连接是否断开
-                if (events[i].events & (EPOLLHUP | EPOLLERR | EPOLLRDHUP)) {
-                    closeClient(events[i].data.fd);
-                } else if (events[i].events & EPOLLIN) {
-                    handleClientData(events[i].data.fd);
-                }
+        size_t sent = static_cast<size_t>(n);
+        client.queued -= sent;
+        while (sent > 0) {
+            const size_t avail = client.queue.front().size() - client.offset;
+            if (sent < avail) {
+                client.offset += sent;
+                break;
             }
+            sent -= avail;
+            client.queue.pop_front();
+            client.offset = 0;
         }
     }
+
+    if (client.queue.empty()) {
+        client.dropping = false;
+        modifyFd(clientFd, kClientEvents);
+    }
+    return true;
 }
 
-void TcpServerEndpoint::handleNewConnection() {
-    sockaddr_in clientAddr{};
-    socklen_t addrLen = sizeof(clientAddr);
-    int clientFd = accept4(_serverFd, (sockaddr*)&clientAddr, &addrLen, SOCK_NONBLOCK);
-    
-    if (clientFd < 0) {
-        logError("Accept failed: " + std::string(strerror(errno)));
+std::string TcpServerEndpoint::clientName(int clientFd, const Client& client) const {
+    return client.peer + " (fd " + std::to_string(clientFd) + ")";
+}
+
+void TcpServerEndpoint::setCorked(bool corked) {
+    for (auto& shard : _shards) {
+        shard->setCorked(corked);
+    }
+
+    int opt = corked ? 1 : 0;
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto& client : _clients) {
+        setsockopt(client.first, IPPROTO_TCP, TCP_CORK, &opt, sizeof(opt));
+    }
+}
+
+// Block 策略下由限制写入的分片在自己的事件循环中等待其慢客户端可写
+void TcpServerEndpoint::notifyWhenWritable(std::function<void()> cb) {
+    TcpServerEndpoint* shard = _blockedShard.load(std::memory_order_relaxed);
+    if (shard != nullptr && shard != this) {
+        shard->notifyWhenWritable(std::move(cb));
+        return;
+    }
+    Endpoint::notifyWhenWritable(std::move(cb));
+}
+
+void TcpServerEndpoint::pauseReading() {
+    Endpoint::pauseReading();
+    for (auto& shard : _shards) {
+        shard->pauseReading();
+    }
+}
+
+void TcpServerEndpoint::resumeReading() {
+    Endpoint::resumeReading();
+    for (auto& shard : _shards) {
+        shard->resumeReading();
+    }
+}
+
+uint64_t TcpServerEndpoint::writeErrors() const {
+    uint64_t errors = Endpoint::writeErrors();
+    for (const auto& shard : _shards) {
+        errors += shard->writeErrors();
+    }
+    return errors;
+}
+
+// 仅在事件循环线程中调用（_clients 只在该线程中增删）；多个客户端时无单一输出fd
+int TcpServerEndpoint::outputFd() const {
+    // Block 策略下等待限制写入的慢客户端
+    const int blockedFd = _blockedFd.load(std::memory_order_relaxed);
+    if (blockedFd >= 0) return blockedFd;
+    return _clients.size() == 1 ? _clients.begin()->first : -1;
+}
+
+// 仅有一个客户端且其发送队列为空时可作为 splice 目标（多个客户端需要逐个复制数据）
+bool TcpServerEndpoint::canSpliceTo() {
+    if (!_shards.empty()) return false;   // 分片模式下客户端分布在多个事件循环中
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _clients.size() == 1 && _clients.begin()->second.queue.empty() &&
+           !_clients.begin()->second.closing;
+}
+
+ssize_t TcpServerEndpoint::spliceFrom(int pipeFd, size_t len) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_clients.size() != 1) {
+        errno = ENOTCONN;
+        return -1;
+    }
+
+    const int clientFd = _clients.begin()->first;
+    if (!_clients.begin()->second.queue.empty()) {
+        // 队列中还有先到的数据，等待续写完成后再继续 splice
+        errno = EAGAIN;
+        return -1;
+    }
+    ssize_t n = splice(pipeFd, nullptr, clientFd, nullptr, len, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    if (n < 0 && errno != EAGAIN) {
+        const int err = errno;
+        logWriteError("Splice failed to client: " + std::to_string(clientFd));
+        errno = err;
+    }
+    return n;
+}
+
+void TcpServerEndpoint::handleEvent(int fd, uint32_t events) {
+    if (fd == _serverFd) {
+        handleNewConnection();
         return;
     }
 
-    // 添加到epoll监控
-    epoll_event event{};
-    event.events = EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR;
-    event.data.fd = clientFd;
-    if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, clientFd, &event) < 0) {
-        logError("Epoll_ctl add client failed: " + std::string(strerror(errno)));
-        ::close(clientFd);
+    // 检查连接是否断开
+    if (events & (EPOLLHUP | EPOLLERR | EPOLLRDHUP)) {
+        closeClient(fd);
         return;
     }
 
-    _clients[clientFd] = clientAddr;
-    logMessage("New client connected: " + std::string(inet_ntoa(clientAddr.sin_addr)) + 
-               ":" + std::to_string(ntohs(clientAddr.sin_port)));
+    if (events & EPOLLOUT) {
+        bool ok = true;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto it = _clients.find(fd);
+            if (it != _clients.end() && !it->second.closing) {
+                ok = flushQueue(fd, it->second);
+            }
+        }
+        if (!ok) {
+            closeClient(fd);
+            return;
+        }
+    }
+
+    if (events & EPOLLIN) {
+        handleClientData(fd);
+    }
+}
+
+void TcpServerEndpoint::handleNewConnection() {
+    // 一次唤醒接受多个连接，剩余的由下一次唤醒（水平触发）处理
+    for (int i = 0; i < kMaxAcceptPerEvent; ++i) {
+        sockaddr_storage clientAddr{};
+        socklen_t addrLen = sizeof(clientAddr);
+        int clientFd = accept4(_serverFd, (sockaddr*)&clientAddr, &addrLen, SOCK_NONBLOCK);
+
+        if (clientFd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                logError("Accept failed: " + std::string(strerror(errno)));
+            }
+            return;
+        }
+
+        // 添加到事件循环监控
+        if (!addFd(clientFd, kClientEvents)) {
+            logError("Epoll_ctl add client failed: " + std::string(strerror(errno)));
+            ::close(clientFd);
+            continue;
+        }
+
+        const std::string peer = peerName(clientFd, clientAddr);
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _clients[clientFd].peer = peer;
+        }
+        logMessage("New client connected: " + peer);
+    }
 }
 
 
 void TcpServerEndpoint::handleClientData(int clientFd) {
+    switch (trySplice(clientFd)) {
+        case SpliceResult::Handled:
+            return;
+        case SpliceResult::Closed:
+            closeClient(clientFd);
+            return;
+        case SpliceResult::NotHandled:
+            break;
+    }
+
     uint8_t buffer[4096];
     ssize_t bytesRead = recv(clientFd, buffer, sizeof(buffer), 0);
     
     if (bytesRead > 0) {
-        processData(buffer, bytesRead);
+        rearmQuickAck(clientFd);
+        deliver(buffer, bytesRead);
     } else {
         // 处理断开连接
         closeClient(clientFd);
     }
 }
 
+// 分片模式下各分片线程并发接收，交给通道前串行化
+void TcpServerEndpoint::deliver(const uint8_t* data, size_t len) {
+    if (_acceptShards > 1) {
+        std::lock_guard<std::mutex> lock(_ingressMutex);
+        processData(data, len);
+    } else {
+        processData(data, len);
+    }
+}
+
+// 在事件循环线程中调用
 void TcpServerEndpoint::closeClient(int clientFd) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    auto it = _clients.find(clientFd);
-    if (it != _clients.end()) {
-        logMessage("Client disconnected: " + 
-                   std::string(inet_ntoa(it->second.sin_addr)) + 
-                   ":" + std::to_string(ntohs(it->second.sin_port)));
-        
-        if (_epollFd >= 0) {
-            epoll_ctl(_epollFd, EPOLL_CTL_DEL, clientFd, nullptr);
-        }
-        ::close(clientFd);
+    std::string peer;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _clients.find(clientFd);
+        if (it == _clients.end()) return;
+
+        peer = it->second.peer;
+        if (_blockedFd.load(std::memory_order_relaxed) == clientFd) {
+            _blockedFd.store(-1, std::memory_order_relaxed);
+        }
         _clients.erase(it);
     }
+
+    logMessage("Client disconnected: " + peer);
+    // removeFd 会直接调用等待该fd可写的回调（如 splice 续传会调用 spliceFrom 并加 _mutex），不能持锁调用
+    removeFd(clientFd);
+    ::close(clientFd);
 }
\ No newline at end of file
@@ -3,25 +3,98 @@
 #include "endpoint.h"
 #include <sys/epoll.h>
 #include <unordered_map>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
 #include <netinet/in.h>  // 添加此头文件
 
 class TcpServerEndpoint : public Endpoint {  // 修正类名
 public:
-    explicit TcpServerEndpoint(uint16_t port);
+    // 慢客户端处理策略（客户端发送队列超过上限时）
+    enum class SlowClientPolicy {
+        Disconnect,   // 断开该客户端，其他客户端不受影响
+        DropOldest,   // 丢弃该客户端队列中最早的数据块
+        Block         // 暂停接受新数据，由通道对源端点施加反压（所有客户端一起等待）
+    };
+    static constexpr size_t kDefaultSendQueueBytes = 1024 * 1024;
+
+    // acceptShards > 1 时启用分片模式：在同一端口上用 SO_REUSEPORT 打开多个监听socket，
+    // 每个分片绑定到各自的事件循环，由内核把新连接分散到各分片；listenBacklog 为 0 时使用 SOMAXCONN
+    explicit TcpServerEndpoint(uint16_t port,
+                               SlowClientPolicy policy = SlowClientPolicy::Disconnect,
+                               size_t maxQueueBytes = kDefaultSendQueueBytes,
+                               size_t acceptShards = 1, int listenBacklog = 0);
     ~TcpServerEndpoint() override;
+
+    // 解析配置中的策略名称（"disconnect" / "drop_oldest" / "block"），未知名称抛出异常
+    static SlowClientPolicy parsePolicy(const std::string& name);
     
     bool open() override;
     void close() override;
     void write(const uint8_t* data, size_t len) override;
+    size_t writev(const iovec* iov, int iovcnt) override;
+    void setCorked(bool corked) override;
+    // 分片模式下多个事件循环线程同时接收数据，不能作为 splice 源
+    bool supportsSplice() const override { return _acceptShards <= 1; }
+    bool canSpliceTo() override;
+    ssize_t spliceFrom(int pipeFd, size_t len) override;
+    void notifyWhenWritable(std::function<void()> cb) override;
+    void pauseReading() override;
+    void resumeReading() override;
+    uint64_t writeErrors() const override;
+
+protected:
+    // 创建监听socket（已 bind/listen，非阻塞），失败返回-1；派生类可改用其他地址族
+    virtual int createListenSocket();
+    // 客户端地址的可读名称（用于日志）
+    virtual std::string peerName(int clientFd, const sockaddr_storage& addr) const;
+    // 客户端socket可读时在事件循环线程中调用
+    virtual void handleClientData(int clientFd);
+    void closeClient(int clientFd);
+
+    const int _listenBacklog;
 
 private:
-    void run() override;
+    // 客户端连接：内核发送缓冲区满时，未发出的数据进入该客户端自己的队列，
+    // 由事件循环在 EPOLLOUT 时续写，慢客户端不会拖慢其他客户端
+    struct Client {
+        std::string peer;                // 客户端地址（日志用）
+        std::deque<std::string> queue;   // 待发送数据块
+        size_t offset = 0;               // 队首块已发送的字节数
+        size_t queued = 0;               // 队列中未发送的总字节数
+        bool dropping = false;           // DropOldest 策略下正在丢弃数据（仅记录一次日志）
+        bool closing = false;            // 已决定断开，等待事件循环线程关闭
+    };
+
+    void handleEvent(int fd, uint32_t events) override;
+    int outputFd() const override;
     void handleNewConnection();
-    void handleClientData(int clientFd);
-    void closeClient(int clientFd);
+    void deliver(const uint8_t* data, size_t len);
+
+    // 向本分片的全部客户端发送 len 字节
+    void broadcast(const iovec* iov, int iovcnt, size_t len);
+    // Block 策略：本分片所有客户端队列都能容纳的字节数（不超过 total），并记录限制写入的客户端
+    size_t blockLimit(size_t total);
+
+    // 以下函数需持有 _mutex
+    bool sendToClient(int clientFd, Client& client, const iovec* iov, int iovcnt, size_t len);
+    bool enqueue(int clientFd, Client& client, const iovec* iov, int iovcnt, size_t skip, size_t len);
+    bool flushQueue(int clientFd, Client& client);
+    std::string clientName(int clientFd, const Client& client) const;
 
     const uint16_t _port;
+    const SlowClientPolicy _policy;
+    const size_t _maxQueueBytes;
+    const size_t _acceptShards;
     int _serverFd = -1;
-    int _epollFd = -1;
-    std::unordered_map<int, struct sockaddr_in> _clients;
-};
\ No newline at end of file
+    std::unordered_map<int, Client> _clients;
+    std::atomic<int> _blockedFd{-1};   // Block 策略下限制写入的客户端，供 notifyWhenWritable 等待
+
+    // 分片模式：本对象是第一个分片，其余分片在 open() 时创建并在对象析构前保留（close 时只关闭）
+    // 各分片的客户端数据经 _ingressMutex 串行交给通道，保持通道缓冲区单生产者
+    bool _reusePort = false;
+    std::vector<std::unique_ptr<TcpServerEndpoint>> _shards;
+    std::mutex _ingressMutex;
+    std::atomic<TcpServerEndpoint*> _blockedShard{nullptr};   // Block 策略下限制写入的分片
+};
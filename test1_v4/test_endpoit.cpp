@@ -11,7 +11,12 @@
 #include "tcp_client_endpoint.h"
 #include "udp_server_endpoint.h"
 #include "udp_client_endpoint.h"
+#include "udp_multicast_endpoint.h"
 #include "serial_endpoint.h"
+#include "shm_endpoint.h"
+#include "unix_server_endpoint.h"
+#include "unix_client_endpoint.h"
+#include "unix_socket.h"
 
 // 接收数据回调函数
 void dataCallback(const uint8_t* data, size_t len) {
@@ -60,7 +65,12 @@ int main(int argc, char* argv[]) {
                   << "  tcp_client <ip> <port>\n"
                   << "  udp_server <port>\n"
                   << "  udp_client <ip> <port>\n"
-                  << "  serial <device> <baud>\n"
+                  << "  serial <device> <baud> [frame_gap_chars]\n"
+                  << "  udp_multicast_send <group> <port>\n"
+                  << "  udp_multicast_recv <group> <port>\n"
+                  << "  shm <name>\n"
+                  << "  unix_server <path> [stream|seqpacket]\n"
+                  << "  unix_client <path> [stream|seqpacket]\n"
                   << "Options:\n"
                   << "  -n <interval_ms> : Send data periodically every interval_ms milliseconds\n";
         return 1;
@@ -78,8 +88,22 @@ int main(int argc, char* argv[]) {
             endpoint = std::make_unique<UdpServerEndpoint>(std::stoi(argv[2]));
         } else if (type == "udp_client" && argc == 4) {
             endpoint = std::make_unique<UdpClientEndpoint>(argv[2], std::stoi(argv[3]));
-        } else if (type == "serial" && argc == 4) {
-            endpoint = std::make_unique<SerialEndpoint>(argv[2], std::stoi(argv[3]));
+        } else if (type == "serial" && (argc == 4 || argc == 5)) {
+            SerialFraming framing;
+            if (argc == 5) framing.gapChars = std::stod(argv[4]);
+            endpoint = std::make_unique<SerialEndpoint>(argv[2], std::stoi(argv[3]), framing);
+        } else if (type == "udp_multicast_send" && argc == 4) {
+            endpoint = std::make_unique<UdpMulticastEndpoint>(UdpMulticastEndpoint::Role::Send, argv[2],
+                                                              std::stoi(argv[3]), "", 0, true);
+        } else if (type == "udp_multicast_recv" && argc == 4) {
+            endpoint = std::make_unique<UdpMulticastEndpoint>(UdpMulticastEndpoint::Role::Receive, argv[2],
+                                                              std::stoi(argv[3]));
+        } else if (type == "shm" && argc == 3) {
+            endpoint = std::make_unique<ShmEndpoint>(argv[2]);
+        } else if (type == "unix_server" && (argc == 3 || argc == 4)) {
+            endpoint = std::make_unique<UnixServerEndpoint>(argv[2], parseUnixSocketType(argc == 4 ? argv[3] : ""));
+        } else if (type == "unix_client" && (argc == 3 || argc == 4)) {
+            endpoint = std::make_unique<UnixClientEndpoint>(argv[2], parseUnixSocketType(argc == 4 ? argv[3] : ""));
         } else {
             std::cerr << "Invalid arguments\n";
             return 1;
@@ -1,62 +1,338 @@
 #pragma once
 #include <vector>
+#include <deque>
 #include <thread>
-#include <queue>
 #include <mutex>
-#include <condition_variable>
 #include <functional>
 #include <atomic>
 #include <memory>
+#include <climits>
+#include <cstdint>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 
+// Chase-Lev 工作窃取双端队列
+// 所有者线程在底部 push/pop（无竞争快速路径），其他线程从顶部 steal
+// 内存序参照 Lê et al., "Correct and Efficient Work-Stealing for Weak Memory Models"
+template <typename T>
+class WorkStealingDeque {
+public:
+    explicit WorkStealingDeque(size_t capacity = 256)
+        : array_(new Array(capacity)) {}
+
+    ~WorkStealingDeque() {
+        delete array_.load(std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    // 仅所有者线程调用
+    void push(T item) {
+        const int64_t b = bottom_.load(std::memory_order_relaxed);
+        const int64_t t = top_.load(std::memory_order_acquire);
+        Array* a = array_.load(std::memory_order_relaxed);
+        if (b - t > static_cast<int64_t>(a->capacity) - 1) {
+            // 扩容；旧数组可能仍被窃取线程读取，延迟到析构时释放
+            Array* bigger = a->grow(b, t);
+            retired_.emplace_back(a);
+            array_.store(bigger, std::memory_order_release);
+            a = bigger;
+        }
+        a->put(b, item);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+
+    // 仅所有者线程调用，空时返回 nullptr
+    T pop() {
+        const int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        Array* a = array_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_relaxed);
+
+        T item = nullptr;
+        if (t <= b) {
+            item = a->get(b);
+            if (t == b) {
+                // 最后一个元素，与窃取者竞争
+                if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                  std::memory_order_relaxed)) {
+                    item = nullptr;
+                }
+                bottom_.store(b + 1, std::memory_order_relaxed);
+            }
+        } else {
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    // 任意线程调用，空或竞争失败时返回 nullptr
+    T steal() {
+        int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t b = bottom_.load(std::memory_order_acquire);
+
+        T item = nullptr;
+        if (t < b) {
+            Array* a = array_.load(std::memory_order_acquire);
+            item = a->get(t);
+            if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                              std::memory_order_relaxed)) {
+                return nullptr;
+            }
+        }
+        return item;
+    }
+
+    bool empty() const {
+        const int64_t b = bottom_.load(std::memory_order_relaxed);
+        const int64_t t = top_.load(std::memory_order_relaxed);
+        return b <= t;
+    }
+
+private:
+    struct Array {
+        explicit Array(size_t cap)
+            : capacity(cap), mask(cap - 1), slots(new std::atomic<T>[cap]) {}
+
+        T get(int64_t i) const { return slots[i & mask].load(std::memory_order_relaxed); }
+        void put(int64_t i, T v) { slots[i & mask].store(v, std::memory_order_relaxed); }
+
+        Array* grow(int64_t bottom, int64_t top) const {
+            Array* a = new Array(capacity * 2);
+            for (int64_t i = top; i < bottom; ++i) {
+                a->put(i, get(i));
+            }
+            return a;
+        }
+
+        const size_t capacity; // 必须为2的幂
+        const size_t mask;
+        std::unique_ptr<std::atomic<T>[]> slots;
+    };
+
+    alignas(64) std::atomic<int64_t> top_{0};
+    alignas(64) std::atomic<int64_t> bottom_{0};
+    std::atomic<Array*> array_;
+    std::vector<std::unique_ptr<Array>> retired_;
+};
+
+// 有界多生产者/多消费者队列（Vyukov），用于接收非工作线程提交的任务
+template <typename T>
+class MpmcQueue {
+public:
+    explicit MpmcQueue(size_t capacity)
+        : mask_(capacity - 1), cells_(new Cell[capacity]) {
+        for (size_t i = 0; i < capacity; ++i) {
+            cells_[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool push(T value) {
+        Cell* cell;
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            const size_t seq = cell->seq.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false; // 已满
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = value;
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& value) {
+        Cell* cell;
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            const size_t seq = cell->seq.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false; // 为空
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        value = cell->data;
+        cell->seq.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> seq;
+        T data;
+    };
+
+    const size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(64) std::atomic<size_t> enqueue_pos_{0};
+    alignas(64) std::atomic<size_t> dequeue_pos_{0};
+};
+
+// 工作窃取线程池
+// - 工作线程内提交的任务进入本线程的双端队列（无锁快速路径）
+// - 外部线程（如事件循环）提交的任务进入无锁注入队列，满时退化到加锁的溢出队列
+// - 空闲线程先窃取其他线程的任务，仍无任务时通过 futex 休眠
 class ThreadPool {
 public:
     explicit ThreadPool(size_t num_threads = std::thread::hardware_concurrency())
-        : running_(true) {
+        : injector_(kInjectorCapacity), running_(true) {
+        if (num_threads == 0) num_threads = 1;
         for (size_t i = 0; i < num_threads; ++i) {
-            workers_.emplace_back([this] {
-                while (running_) {
-                    std::function<void()> task;
-                    {
-                        std::unique_lock<std::mutex> lock(queue_mutex_);
-                        condition_.wait(lock, [this] {
-                            return !tasks_.empty() || !running_;
-                        });
-                        
-                        if (!running_ && tasks_.empty()) return;
-                        
-                        task = std::move(tasks_.front());
-                        tasks_.pop();
-                    }
-                    task();
-                }
+            workers_.emplace_back(new Worker);
+        }
+        for (size_t i = 0; i < num_threads; ++i) {
+            workers_[i]->thread = std::thread([this, i] {
+                workerLoop(i);
             });
         }
     }
-    
+
     ~ThreadPool() {
-        {
-            std::lock_guard<std::mutex> lock(queue_mutex_);
-            running_ = false;
-        }
-        condition_.notify_all();
+        running_.store(false);
+        epoch_.fetch_add(1, std::memory_order_release);
+        futexWake(INT_MAX);
         for (auto& worker : workers_) {
-            if (worker.joinable()) worker.join();
+            if (worker->thread.joinable()) worker->thread.join();
         }
     }
-    
+
     template<typename F>
     void enqueue(F&& f) {
-        {
-            std::lock_guard<std::mutex> lock(queue_mutex_);
-            tasks_.emplace(std::forward<F>(f));
+        Task* task = new Task(std::forward<F>(f));
+
+        if (tls_pool_ == this) {
+            // 本地快速路径
+            workers_[tls_index_]->deque.push(task);
+        } else if (!injector_.push(task)) {
+            std::lock_guard<std::mutex> lock(overflow_mutex_);
+            overflow_.push_back(task);
+            overflow_size_.fetch_add(1, std::memory_order_relaxed);
         }
-        condition_.notify_one();
+        notify();
     }
 
 private:
-    std::vector<std::thread> workers_;
-    std::queue<std::function<void()>> tasks_;
-    std::mutex queue_mutex_;
-    std::condition_variable condition_;
+    using Task = std::function<void()>;
+    static constexpr size_t kInjectorCapacity = 4096;
+
+    struct Worker {
+        WorkStealingDeque<Task*> deque;
+        std::thread thread;
+    };
+
+    void workerLoop(size_t index) {
+        tls_pool_ = this;
+        tls_index_ = index;
+        uint64_t rng = index * 0x9E3779B97F4A7C15ull + 1;
+
+        while (true) {
+            Task* task = findTask(index, rng);
+            if (task) {
+                runTask(task);
+                continue;
+            }
+            if (!running_.load()) break;
+
+            // 准备休眠：先登记为休眠者，再复查一次队列，避免丢失唤醒
+            const uint32_t epoch = epoch_.load(std::memory_order_acquire);
+            sleepers_.fetch_add(1, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            task = findTask(index, rng);
+            if (task) {
+                sleepers_.fetch_sub(1, std::memory_order_relaxed);
+                runTask(task);
+                continue;
+            }
+            if (!running_.load()) {
+                sleepers_.fetch_sub(1, std::memory_order_relaxed);
+                break;
+            }
+            futexWait(epoch);
+            sleepers_.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        tls_pool_ = nullptr;
+    }
+
+    Task* findTask(size_t index, uint64_t& rng) {
+        // 1. 本地队列
+        if (Task* task = workers_[index]->deque.pop()) return task;
+
+        // 2. 注入队列 / 溢出队列
+        Task* task = nullptr;
+        if (injector_.pop(task)) return task;
+        if (overflow_size_.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(overflow_mutex_);
+            if (!overflow_.empty()) {
+                task = overflow_.front();
+                overflow_.pop_front();
+                overflow_size_.fetch_sub(1, std::memory_order_relaxed);
+                return task;
+            }
+        }
+
+        // 3. 从随机起点依次窃取其他线程的任务
+        const size_t n = workers_.size();
+        rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17;
+        const size_t start = rng % n;
+        for (size_t k = 0; k < n; ++k) {
+            const size_t victim = (start + k) % n;
+            if (victim == index) continue;
+            if (Task* stolen = workers_[victim]->deque.steal()) return stolen;
+        }
+        return nullptr;
+    }
+
+    static void runTask(Task* task) {
+        std::unique_ptr<Task> owned(task);
+        (*owned)();
+    }
+
+    void notify() {
+        // 与 workerLoop 中的登记/复查配对（Dekker式），仅在有休眠线程时才进行系统调用
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers_.load(std::memory_order_relaxed) > 0) {
+            epoch_.fetch_add(1, std::memory_order_release);
+            futexWake(1);
+        }
+    }
+
+    void futexWait(uint32_t expected) {
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch_), FUTEX_WAIT_PRIVATE,
+                expected, nullptr, nullptr, 0);
+    }
+
+    void futexWake(int count) {
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch_), FUTEX_WAKE_PRIVATE,
+                count, nullptr, nullptr, 0);
+    }
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    MpmcQueue<Task*> injector_;
+    std::mutex overflow_mutex_;
+    std::deque<Task*> overflow_;
+    std::atomic<size_t> overflow_size_{0};
+
+    alignas(64) std::atomic<uint32_t> epoch_{0};
+    alignas(64) std::atomic<uint32_t> sleepers_{0};
     std::atomic<bool> running_;
-};
\ No newline at end of file
+
+    static inline thread_local ThreadPool* tls_pool_ = nullptr;
+    static inline thread_local size_t tls_index_ = 0;
+};
@@ -0,0 +1,186 @@
+// timer_wheel.h
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+// 分层时间轮：4 层 × 64 槽，刻度 1 毫秒，单层覆盖 64^(层+1) 个刻度（最高层约 4.6 小时，更远的定时器逐层下沉）
+// 添加/取消为 O(1)；定时器节点放在对象池中复用，节点通过下标串成双向链表
+// 非线程安全，由所属事件循环线程访问
+class TimerWheel {
+public:
+    using Task = std::function<void()>;
+    using TimerId = uint64_t;   // 0 表示无效
+
+    explicit TimerWheel(uint64_t nowTick = 0) : current_(nowTick) {
+        for (auto& level : slots_) {
+            for (auto& head : level) head = kNil;
+        }
+    }
+
+    // 在 expireTick 到期时执行 task（已过期的时刻按下一个刻度处理）
+    TimerId add(uint64_t expireTick, Task task) {
+        const uint32_t index = allocNode();
+        Node& node = nodes_[index];
+        node.expire = expireTick > current_ ? expireTick : current_ + 1;
+        node.task = std::move(task);
+        node.active = true;
+        place(index);
+        ++count_;
+        return (static_cast<uint64_t>(node.gen) << 32) | (index + 1);
+    }
+
+    // 取消未到期的定时器，已执行或已取消的ID忽略
+    bool cancel(TimerId id) {
+        const uint32_t index = static_cast<uint32_t>(id & 0xffffffffu);
+        if (index == 0 || index > nodes_.size()) return false;
+        Node& node = nodes_[index - 1];
+        if (!node.active || node.gen != static_cast<uint32_t>(id >> 32)) return false;
+        unlink(index - 1);
+        freeNode(index - 1);
+        --count_;
+        return true;
+    }
+
+    // 推进到 nowTick，依次执行到期任务（任务中可以添加或取消定时器）
+    void advance(uint64_t nowTick) {
+        if (count_ == 0) {
+            if (nowTick > current_) current_ = nowTick;
+            return;
+        }
+        while (current_ < nowTick) {
+            // 跳过中间没有任何到期或下沉的刻度
+            const uint64_t next = nextTick();
+            if (next > current_ + 1) current_ = (next - 1 < nowTick) ? next - 1 : nowTick;
+            if (current_ >= nowTick) return;
+
+            ++current_;
+            // 从高层到低层，把进入本轮范围的槽位重新分配到低层
+            for (int level = kLevels - 1; level >= 1; --level) {
+                const uint64_t mask = (uint64_t{1} << (kSlotBits * level)) - 1;
+                if ((current_ & mask) == 0) cascade(level, (current_ >> (kSlotBits * level)) & kSlotMask);
+            }
+
+            uint32_t& head = slots_[0][current_ & kSlotMask];
+            while (head != kNil) {
+                const uint32_t index = head;
+                unlink(index);
+                Task task = std::move(nodes_[index].task);
+                freeNode(index);
+                --count_;
+                task();
+            }
+            if (count_ == 0) {
+                current_ = nowTick;
+                return;
+            }
+        }
+    }
+
+    // 下一次需要推进的刻度（到期或需要下沉高层槽位），没有定时器时返回 0
+    uint64_t nextTick() const {
+        if (count_ == 0) return 0;
+        uint64_t next = UINT64_MAX;
+        for (int level = 0; level < kLevels; ++level) {
+            const int shift = kSlotBits * level;
+            const uint64_t base = current_ >> shift;
+            for (uint64_t k = 1; k <= kSlots; ++k) {
+                if (slots_[level][(base + k) & kSlotMask] != kNil) {
+                    const uint64_t tick = (base + k) << shift;
+                    if (tick < next) next = tick;
+                    break;
+                }
+            }
+        }
+        return next;
+    }
+
+    uint64_t currentTick() const { return current_; }
+    size_t size() const { return count_; }
+
+private:
+    static constexpr int kLevels = 4;
+    static constexpr int kSlotBits = 6;
+    static constexpr uint64_t kSlots = uint64_t{1} << kSlotBits;
+    static constexpr uint64_t kSlotMask = kSlots - 1;
+    static constexpr uint64_t kMaxSpan = uint64_t{1} << (kSlotBits * kLevels);
+    static constexpr uint32_t kNil = UINT32_MAX;
+
+    struct Node {
+        uint64_t expire = 0;
+        Task task;
+        uint32_t prev = kNil;
+        uint32_t next = kNil;
+        uint32_t gen = 0;
+        uint8_t level = 0;
+        uint8_t slot = 0;
+        bool active = false;
+    };
+
+    uint32_t allocNode() {
+        if (free_ != kNil) {
+            const uint32_t index = free_;
+            free_ = nodes_[index].next;
+            return index;
+        }
+        nodes_.emplace_back();
+        return static_cast<uint32_t>(nodes_.size() - 1);
+    }
+
+    void freeNode(uint32_t index) {
+        Node& node = nodes_[index];
+        node.task = nullptr;
+        node.active = false;
+        ++node.gen;   // 使旧ID失效
+        node.prev = kNil;
+        node.next = free_;
+        free_ = index;
+    }
+
+    // 按距当前刻度的远近选择层级与槽位
+    void place(uint32_t index) {
+        Node& node = nodes_[index];
+        uint64_t expire = node.expire;
+        if (expire - current_ >= kMaxSpan) expire = current_ + kMaxSpan - 1;   // 超出范围先放最高层
+        const uint64_t delta = expire - current_;
+
+        int level = 0;
+        while (level < kLevels - 1 && delta >= (uint64_t{1} << (kSlotBits * (level + 1)))) ++level;
+        const uint32_t slot = static_cast<uint32_t>((expire >> (kSlotBits * level)) & kSlotMask);
+
+        node.level = static_cast<uint8_t>(level);
+        node.slot = static_cast<uint8_t>(slot);
+        node.prev = kNil;
+        node.next = slots_[level][slot];
+        if (node.next != kNil) nodes_[node.next].prev = index;
+        slots_[level][slot] = index;
+    }
+
+    void unlink(uint32_t index) {
+        Node& node = nodes_[index];
+        if (node.prev != kNil) {
+            nodes_[node.prev].next = node.next;
+        } else {
+            slots_[node.level][node.slot] = node.next;
+        }
+        if (node.next != kNil) nodes_[node.next].prev = node.prev;
+        node.prev = node.next = kNil;
+    }
+
+    void cascade(int level, uint64_t slot) {
+        uint32_t index = slots_[level][slot];
+        slots_[level][slot] = kNil;
+        while (index != kNil) {
+            const uint32_t next = nodes_[index].next;
+            place(index);
+            index = next;
+        }
+    }
+
+    uint64_t current_;   // 已处理到的刻度
+    uint32_t slots_[kLevels][kSlots];
+    std::vector<Node> nodes_;
+    uint32_t free_ = kNil;
+    size_t count_ = 0;
+};
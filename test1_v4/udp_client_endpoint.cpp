@@ -7,8 +7,9 @@
 #include <cstring>
 #include <stdexcept>
 
-UdpClientEndpoint::UdpClientEndpoint(const std::string& host, uint16_t port)
-    : _host(host), _port(port) {
+UdpClientEndpoint::UdpClientEndpoint(const std::string& host, uint16_t port,
+                                     size_t recvBatch, size_t recvSlotBytes)
+    : _host(host), _port(port), _recvBatch(recvBatch, recvSlotBytes) {
     memset(&_serverAddr, 0, sizeof(_serverAddr));
     _serverAddr.sin_family = AF_INET;
     _serverAddr.sin_port = htons(_port);
@@ -31,42 +32,25 @@ bool UdpClientEndpoint::open() {
         logError("Socket creation failed: " + std::string(strerror(errno)));
         return false;
     }
+    tuneSocket(_socketFd);
 
-    // 创建epoll实例
-    _epollFd = epoll_create1(0);
-    if (_epollFd < 0) {
-        logError("Epoll creation failed: " + std::string(strerror(errno)));
-        ::close(_socketFd);
-        _socketFd = -1;
-        return false;
-    }
-
-    // 添加socket到epoll
-    epoll_event event{};
-    event.events = EPOLLIN;
-    event.data.fd = _socketFd;
-    if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, _socketFd, &event) < 0) {
+    // 绑定事件循环并注册socket（边缘触发，每次唤醒读空socket）
+    attachLoop();
+    if (!addFd(_socketFd, EPOLLIN | EPOLLET)) {
         logError("Epoll_ctl failed: " + std::string(strerror(errno)));
-        ::close(_epollFd);
+        detachLoop();
         ::close(_socketFd);
-        _epollFd = -1;
         _socketFd = -1;
         return false;
     }
 
     setState(State::CONNECTED);
-    startThread();
     logMessage("UDP client connected to " + _host + ":" + std::to_string(_port));
     return true;
 }
 
 void UdpClientEndpoint::close() {
-    stopThread();
-    
-    if (_epollFd >= 0) {
-        ::close(_epollFd);
-        _epollFd = -1;
-    }
+    detachLoop();
     
     if (_socketFd >= 0) {
         ::close(_socketFd);
@@ -83,38 +67,86 @@ void UdpClientEndpoint::write(const uint8_t* data, size_t len) {
     std::lock_guard<std::mutex> lock(_mutex);
     if (sendto(_socketFd, data, len, 0, 
               (sockaddr*)&_serverAddr, sizeof(_serverAddr)) < 0) {
-        logError("Sendto failed: " + std::string(strerror(errno)));
+        logWriteError("Sendto failed: " + std::string(strerror(errno)));
     }
 }
 
-void UdpClientEndpoint::run() {
-    constexpr int MAX_EVENTS = 10;
-    epoll_event events[MAX_EVENTS];
-    
-    while (isRunning()) {
-        int numEvents = epoll_wait(_epollFd, events, MAX_EVENTS, 100);
-        if (numEvents < 0) {
-            if (errno != EINTR) {
-                logError("Epoll_wait error: " + std::string(strerror(errno)));
-            }
-            continue;
+size_t UdpClientEndpoint::writev(const iovec* iov, int iovcnt) {
+    const size_t total = totalLength(iov, iovcnt);
+    if (!isConnected()) return total;
+
+    msghdr msg{};
+    msg.msg_name = &_serverAddr;
+    msg.msg_namelen = sizeof(_serverAddr);
+    msg.msg_iov = const_cast<iovec*>(iov);
+    msg.msg_iovlen = iovcnt;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (sendmsg(_socketFd, &msg, 0) < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0; // 发送缓冲区已满，等待可写后重试
         }
+        logWriteError("Sendto failed: " + std::string(strerror(errno)));
+    }
+    return total;
+}
+
+// 批量发送：一次 sendmmsg 发送多个数据报
+size_t UdpClientEndpoint::writeDatagrams(mmsghdr* msgs, size_t count) {
+    if (!isConnected()) return count;
 
-        for (int i = 0; i < numEvents; ++i) {
-            if (events[i].data.fd == _socketFd) {
-                handleData();
+    for (size_t i = 0; i < count; ++i) {
+        msgs[i].msg_hdr.msg_name = &_serverAddr;
+        msgs[i].msg_hdr.msg_namelen = sizeof(_serverAddr);
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    size_t sent = 0;
+    while (sent < count) {
+        int n = sendmmsg(_socketFd, msgs + sent, count - sent, 0);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break; // 发送缓冲区已满，等待可写后重试
             }
+            logWriteError("Sendmmsg failed: " + std::string(strerror(errno)));
+            ++sent; // 丢弃出错的数据报
+            continue;
         }
+        sent += n;
+    }
+    return sent;
+}
+
+int UdpClientEndpoint::outputFd() const {
+    return isConnected() ? _socketFd : -1;
+}
+
+void UdpClientEndpoint::handleEvent(int fd, uint32_t events) {
+    if (fd == _socketFd && (events & EPOLLIN)) {
+        handleData();
     }
 }
 
 void UdpClientEndpoint::handleData() {
-    uint8_t buffer[4096];
-    ssize_t bytesRead = recv(_socketFd, buffer, sizeof(buffer), 0);
-    
-    if (bytesRead > 0) {
-        processData(buffer, bytesRead);
-    } else if (bytesRead < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
-        logError("Recv error: " + std::string(strerror(errno)));
+    int errors = 0;
+    // 边缘触发：批量读取直到socket为空；通道要求暂停读取时停止，恢复时会重新触发
+    while (!_readPaused) {
+        int n = _recvBatch.receive(_socketFd);
+        if (n < 0) {
+            logError("Recvmmsg error: " + std::string(strerror(errno)));
+            if (++errors > 1) return;
+            continue;
+        }
+        if (_recvBatch.truncated() > 0) {
+            logReceiveDrop("Dropped " + std::to_string(_recvBatch.truncated()) + " datagrams larger than " +
+                               std::to_string(_recvBatch.slotBytes()) + " bytes",
+                           _recvBatch.truncated());
+        }
+        if (n > 0) {
+            processBatch(_recvBatch.payloads(), n);
+        }
+
+        // 未读满一批说明socket已读空
+        if (_recvBatch.received() < _recvBatch.batch()) return;
     }
-}
\ No newline at end of file
+}
@@ -1,25 +1,32 @@
 // udp_client_endpoint.h
 #pragma once
 #include "endpoint.h"
+#include "udp_recv_batch.h"
 #include <sys/epoll.h>
 #include <netinet/in.h>  // 添加此头文件
 
 class UdpClientEndpoint : public Endpoint {
 public:
-    UdpClientEndpoint(const std::string& host, uint16_t port);
+    // recvBatch / recvSlotBytes：每次 recvmmsg 的数据报数与单个数据报的最大长度（0 表示默认值）
+    UdpClientEndpoint(const std::string& host, uint16_t port,
+                      size_t recvBatch = 0, size_t recvSlotBytes = 0);
     ~UdpClientEndpoint() override;
     
     bool open() override;
     void close() override;
     void write(const uint8_t* data, size_t len) override;
+    size_t writev(const iovec* iov, int iovcnt) override;
+    bool isDatagram() const override { return true; }
+    size_t writeDatagrams(mmsghdr* msgs, size_t count) override;
 
 private:
-    void run() override;
+    void handleEvent(int fd, uint32_t events) override;
+    int outputFd() const override;
     void handleData();
 
     const std::string _host;
     const uint16_t _port;
     int _socketFd = -1;
-    int _epollFd = -1;
+    UdpRecvBatch _recvBatch;   // 仅在事件循环线程中使用
     struct sockaddr_in _serverAddr;  // 现在类型完整
 };
\ No newline at end of file
@@ -0,0 +1,210 @@
+#include "udp_multicast_endpoint.h"
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <cstring>
+#include <stdexcept>
+
+UdpMulticastEndpoint::UdpMulticastEndpoint(Role role, const std::string& group, uint16_t port,
+                                           const std::string& iface, uint8_t ttl, bool loopback,
+                                           size_t recvBatch, size_t recvSlotBytes)
+    : _role(role), _group(group), _port(port), _iface(iface),
+      _ttl(ttl > 0 ? ttl : kDefaultTtl), _loopback(loopback),
+      _recvBatch(recvBatch, recvSlotBytes) {
+    _groupAddr.sin_family = AF_INET;
+    _groupAddr.sin_port = htons(_port);
+    if (inet_pton(AF_INET, _group.c_str(), &_groupAddr.sin_addr) <= 0 ||
+        !IN_MULTICAST(ntohl(_groupAddr.sin_addr.s_addr))) {
+        throw std::runtime_error("Invalid multicast group: " + _group);
+    }
+}
+
+UdpMulticastEndpoint::~UdpMulticastEndpoint() {
+    close();
+}
+
+bool UdpMulticastEndpoint::open() {
+    if (isRunning()) return true;
+
+    _socketFd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    if (_socketFd < 0) {
+        logError("Socket creation failed: " + std::string(strerror(errno)));
+        return false;
+    }
+    tuneSocket(_socketFd);
+
+    if (!(_role == Role::Send ? setupSender() : setupReceiver())) {
+        ::close(_socketFd);
+        _socketFd = -1;
+        return false;
+    }
+
+    // 绑定事件循环并注册socket（边缘触发，每次唤醒读空socket）
+    attachLoop();
+    if (!addFd(_socketFd, EPOLLIN | EPOLLET)) {
+        logError("Epoll_ctl failed: " + std::string(strerror(errno)));
+        detachLoop();
+        ::close(_socketFd);
+        _socketFd = -1;
+        return false;
+    }
+
+    setState(State::CONNECTED);
+    logMessage(std::string(_role == Role::Send ? "UDP multicast sending to " : "UDP multicast joined ") +
+               _group + ":" + std::to_string(_port) + (_iface.empty() ? "" : " on " + _iface));
+    return true;
+}
+
+// 本地接口：IPv4地址或接口名
+bool UdpMulticastEndpoint::resolveInterface(ip_mreqn& req) {
+    if (_iface.empty()) return true;
+    if (inet_pton(AF_INET, _iface.c_str(), &req.imr_address) > 0) return true;
+
+    req.imr_ifindex = static_cast<int>(if_nametoindex(_iface.c_str()));
+    if (req.imr_ifindex == 0) {
+        logError("Unknown multicast interface: " + _iface);
+        return false;
+    }
+    return true;
+}
+
+bool UdpMulticastEndpoint::setupSender() {
+    ip_mreqn req{};
+    if (!resolveInterface(req)) return false;
+    if (!_iface.empty() && setsockopt(_socketFd, IPPROTO_IP, IP_MULTICAST_IF, &req, sizeof(req)) < 0) {
+        logError("Setsockopt IP_MULTICAST_IF failed: " + std::string(strerror(errno)));
+        return false;
+    }
+
+    int ttl = _ttl;
+    int loop = _loopback ? 1 : 0;
+    if (setsockopt(_socketFd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)) < 0 ||
+        setsockopt(_socketFd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) < 0) {
+        logError("Setsockopt multicast options failed: " + std::string(strerror(errno)));
+        return false;
+    }
+    return true;
+}
+
+bool UdpMulticastEndpoint::setupReceiver() {
+    // 允许同一主机上的多个接收端绑定同一组播端口
+    int opt = 1;
+    setsockopt(_socketFd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    // 绑定组播地址：只接收发往本组的数据报
+    if (bind(_socketFd, (sockaddr*)&_groupAddr, sizeof(_groupAddr)) < 0) {
+        logError("Bind failed: " + std::string(strerror(errno)));
+        return false;
+    }
+
+    ip_mreqn req{};
+    req.imr_multiaddr = _groupAddr.sin_addr;
+    if (!resolveInterface(req)) return false;
+    if (setsockopt(_socketFd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &req, sizeof(req)) < 0) {
+        logError("Join multicast group failed: " + std::string(strerror(errno)));
+        return false;
+    }
+    return true;
+}
+
+void UdpMulticastEndpoint::close() {
+    detachLoop();
+
+    // 关闭socket时内核自动退出组播组
+    if (_socketFd >= 0) {
+        ::close(_socketFd);
+        _socketFd = -1;
+    }
+
+    setState(State::DISCONNECTED);
+    logMessage("UDP multicast closed");
+}
+
+void UdpMulticastEndpoint::write(const uint8_t* data, size_t len) {
+    iovec iov{const_cast<uint8_t*>(data), len};
+    writev(&iov, 1);
+}
+
+size_t UdpMulticastEndpoint::writev(const iovec* iov, int iovcnt) {
+    const size_t total = totalLength(iov, iovcnt);
+    if (!isConnected() || _role != Role::Send) return total; // 接收端丢弃写入的数据
+
+    msghdr msg{};
+    msg.msg_name = &_groupAddr;
+    msg.msg_namelen = sizeof(_groupAddr);
+    msg.msg_iov = const_cast<iovec*>(iov);
+    msg.msg_iovlen = iovcnt;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (sendmsg(_socketFd, &msg, 0) < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0; // 发送缓冲区已满，等待可写后重试
+        }
+        logWriteError("Sendmsg failed: " + std::string(strerror(errno)));
+    }
+    return total;
+}
+
+// 批量发送：一次 sendmmsg 发送多个数据报，每个数据报只发送一次
+size_t UdpMulticastEndpoint::writeDatagrams(mmsghdr* msgs, size_t count) {
+    if (!isConnected() || _role != Role::Send) return count;
+
+    for (size_t i = 0; i < count; ++i) {
+        msgs[i].msg_hdr.msg_name = &_groupAddr;
+        msgs[i].msg_hdr.msg_namelen = sizeof(_groupAddr);
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    size_t sent = 0;
+    while (sent < count) {
+        int n = sendmmsg(_socketFd, msgs + sent, count - sent, 0);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break; // 发送缓冲区已满，等待可写后重试
+            }
+            logWriteError("Sendmmsg failed: " + std::string(strerror(errno)));
+            ++sent; // 丢弃出错的数据报
+            continue;
+        }
+        sent += n;
+    }
+    return sent;
+}
+
+int UdpMulticastEndpoint::outputFd() const {
+    return isConnected() && _role == Role::Send ? _socketFd : -1;
+}
+
+void UdpMulticastEndpoint::handleEvent(int fd, uint32_t events) {
+    if (fd == _socketFd && (events & EPOLLIN)) {
+        handleData();
+    }
+}
+
+void UdpMulticastEndpoint::handleData() {
+    int errors = 0;
+    // 边缘触发：批量读取直到socket为空；通道要求暂停读取时停止，恢复时会重新触发
+    while (!_readPaused) {
+        int n = _recvBatch.receive(_socketFd);
+        if (n < 0) {
+            // 接收错误（如 ICMP 返回的 ECONNREFUSED）不影响后续收发，不改变端点状态
+            logMessage("Recvmmsg error: " + std::string(strerror(errno)));
+            if (++errors > 1) return;
+            continue;
+        }
+        if (_recvBatch.truncated() > 0) {
+            logReceiveDrop("Dropped " + std::to_string(_recvBatch.truncated()) + " datagrams larger than " +
+                               std::to_string(_recvBatch.slotBytes()) + " bytes",
+                           _recvBatch.truncated());
+        }
+        if (n > 0) {
+            processBatch(_recvBatch.payloads(), n);
+        }
+
+        // 未读满一批说明socket已读空
+        if (_recvBatch.received() < _recvBatch.batch()) return;
+    }
+}
@@ -0,0 +1,50 @@
+// udp_multicast_endpoint.h
+#pragma once
+#include "endpoint.h"
+#include "udp_recv_batch.h"
+#include <sys/epoll.h>
+#include <netinet/in.h>
+
+// UDP组播端点：发送端每条消息只发送一次（一次系统调用），由网络复制给所有订阅者；
+// 接收端加入组播组并绑定组播地址与端口，同一主机上可有多个接收端共享端口
+class UdpMulticastEndpoint : public Endpoint {
+public:
+    enum class Role {
+        Send,      // 发往组播组（也接收订阅者发回本端口的单播数据）
+        Receive    // 加入组播组接收，写入的数据被丢弃
+    };
+    static constexpr uint8_t kDefaultTtl = 1;   // 仅本网段
+
+    // iface：出口/加入组播的本地接口（IPv4地址或接口名，空表示由路由决定）
+    // ttl：组播TTL（0 表示默认值）；loopback：是否回送给本机的订阅者
+    // recvBatch / recvSlotBytes：每次 recvmmsg 的数据报数与单个数据报的最大长度（0 表示默认值）
+    UdpMulticastEndpoint(Role role, const std::string& group, uint16_t port,
+                         const std::string& iface = "", uint8_t ttl = 0, bool loopback = false,
+                         size_t recvBatch = 0, size_t recvSlotBytes = 0);
+    ~UdpMulticastEndpoint() override;
+
+    bool open() override;
+    void close() override;
+    void write(const uint8_t* data, size_t len) override;
+    size_t writev(const iovec* iov, int iovcnt) override;
+    bool isDatagram() const override { return true; }
+    size_t writeDatagrams(mmsghdr* msgs, size_t count) override;
+
+private:
+    void handleEvent(int fd, uint32_t events) override;
+    int outputFd() const override;
+    void handleData();
+    bool setupSender();
+    bool setupReceiver();
+    bool resolveInterface(ip_mreqn& req);
+
+    const Role _role;
+    const std::string _group;
+    const uint16_t _port;
+    const std::string _iface;
+    const uint8_t _ttl;
+    const bool _loopback;
+    int _socketFd = -1;
+    UdpRecvBatch _recvBatch;   // 仅在事件循环线程中使用
+    sockaddr_in _groupAddr{};
+};
@@ -0,0 +1,116 @@
+// udp_peer_table.h
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <netinet/in.h>
+
+// UDP对端表：以 (IPv4地址, 端口) 打包成的 64 位整数为键的开放寻址哈希表（线性探测）
+// 已登记对端的刷新只更新时间戳，不分配内存；超过空闲时间的对端由 expire() 批量移除
+// 非线程安全，由调用方保证串行访问
+class UdpPeerTable {
+public:
+    explicit UdpPeerTable(size_t initialCapacity = 64)
+        : slots_(roundUpPow2(initialCapacity < 8 ? 8 : initialCapacity)) {}
+
+    static uint64_t key(const sockaddr_in& addr) {
+        // 地址和端口保持网络字节序，只用于比较和散列；最高位标记槽位已占用
+        return (uint64_t{1} << 63) | (static_cast<uint64_t>(addr.sin_addr.s_addr) << 16) | addr.sin_port;
+    }
+
+    // 登记或刷新对端，返回 true 表示新加入
+    bool touch(const sockaddr_in& addr, int64_t nowNs) {
+        const uint64_t k = key(addr);
+        Slot* slot = find(k);
+        if (slot->key == k) {
+            slot->last_seen_ns = nowNs;
+            return false;
+        }
+
+        // 新对端：负载因子超过 1/2 时扩容（只在对端集合变化时发生）
+        if ((size_ + 1) * 2 > slots_.size()) {
+            rehash(slots_.size() * 2);
+            slot = find(k);
+        }
+        slot->key = k;
+        slot->addr = addr;
+        slot->last_seen_ns = nowNs;
+        ++size_;
+        return true;
+    }
+
+    // 移除最后活动时间早于 cutoffNs 的对端，返回移除数量
+    size_t expire(int64_t cutoffNs) {
+        size_t expired = 0;
+        for (const Slot& slot : slots_) {
+            if (slot.key != 0 && slot.last_seen_ns < cutoffNs) ++expired;
+        }
+        if (expired > 0) {
+            // 线性探测表不能直接清空槽位，重建剩余条目
+            std::vector<Slot> old(slots_.size());
+            old.swap(slots_);
+            size_ = 0;
+            for (const Slot& slot : old) {
+                if (slot.key != 0 && slot.last_seen_ns >= cutoffNs) insert(slot);
+            }
+        }
+        return expired;
+    }
+
+    void clear() {
+        for (Slot& slot : slots_) slot.key = 0;
+        size_ = 0;
+    }
+
+    size_t size() const { return size_; }
+
+    template <typename F>
+    void forEach(F&& f) const {
+        for (const Slot& slot : slots_) {
+            if (slot.key != 0) f(slot.addr);
+        }
+    }
+
+private:
+    struct Slot {
+        uint64_t key = 0;   // 0 表示空槽
+        sockaddr_in addr{};
+        int64_t last_seen_ns = 0;
+    };
+
+    static size_t roundUpPow2(size_t n) {
+        size_t p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    size_t indexOf(uint64_t k) const {
+        return static_cast<size_t>((k * 0x9E3779B97F4A7C15ull) >> 32) & (slots_.size() - 1);
+    }
+
+    // 返回键所在槽位，不存在时返回应插入的空槽
+    Slot* find(uint64_t k) {
+        size_t i = indexOf(k);
+        while (slots_[i].key != 0 && slots_[i].key != k) {
+            i = (i + 1) & (slots_.size() - 1);
+        }
+        return &slots_[i];
+    }
+
+    void insert(const Slot& entry) {
+        *find(entry.key) = entry;
+        ++size_;
+    }
+
+    void rehash(size_t capacity) {
+        std::vector<Slot> old(capacity);
+        old.swap(slots_);
+        size_ = 0;
+        for (const Slot& slot : old) {
+            if (slot.key != 0) insert(slot);
+        }
+    }
+
+    std::vector<Slot> slots_;
+    size_t size_ = 0;
+};
@@ -0,0 +1,89 @@
+// udp_recv_batch.h
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cerrno>
+#include <memory>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+
+// UDP批量接收：预分配 batch 个消息槽，一次 recvmmsg 读取多个数据报
+// 槽内存一次性分配且不清零，只有实际写入的页面才占用物理内存
+class UdpRecvBatch {
+public:
+    static constexpr size_t kDefaultBatch = 32;
+    static constexpr size_t kDefaultSlotBytes = 65536;   // UDP负载最大 65507 字节，不截断
+
+    UdpRecvBatch(size_t batch, size_t slotBytes)
+        : batch_(batch > 0 ? batch : kDefaultBatch),
+          slot_bytes_(slotBytes > 0 ? slotBytes : kDefaultSlotBytes),
+          storage_(new uint8_t[batch_ * slot_bytes_]),
+          msgs_(batch_), iov_(batch_), addrs_(batch_), payloads_(batch_) {
+        for (size_t i = 0; i < batch_; ++i) {
+            iov_[i].iov_base = storage_.get() + i * slot_bytes_;
+            iov_[i].iov_len = slot_bytes_;
+        }
+    }
+
+    UdpRecvBatch(const UdpRecvBatch&) = delete;
+    UdpRecvBatch& operator=(const UdpRecvBatch&) = delete;
+
+    // 非阻塞接收最多 batch 个数据报，返回有效数据报数量；无数据返回0，出错返回-1（errno 有效）
+    // 超过槽大小被截断的数据报不交付，计入 truncated()
+    int receive(int fd) {
+        for (size_t i = 0; i < batch_; ++i) {
+            msghdr& hdr = msgs_[i].msg_hdr;
+            hdr = msghdr{};
+            hdr.msg_name = &addrs_[i];
+            hdr.msg_namelen = sizeof(sockaddr_in);
+            hdr.msg_iov = &iov_[i];
+            hdr.msg_iovlen = 1;
+            msgs_[i].msg_len = 0;
+        }
+
+        received_ = 0;
+        truncated_ = 0;
+        int n = recvmmsg(fd, msgs_.data(), static_cast<unsigned int>(batch_), MSG_DONTWAIT, nullptr);
+        if (n < 0) {
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+        }
+
+        received_ = static_cast<size_t>(n);
+        int valid = 0;
+        for (int i = 0; i < n; ++i) {
+            if (msgs_[i].msg_hdr.msg_flags & MSG_TRUNC) {
+                ++truncated_;
+                continue;
+            }
+            payloads_[valid].iov_base = iov_[i].iov_base;
+            payloads_[valid].iov_len = msgs_[i].msg_len;
+            if (valid != i) addrs_[valid] = addrs_[i];
+            ++valid;
+        }
+        return valid;
+    }
+
+    size_t batch() const { return batch_; }
+    size_t slotBytes() const { return slot_bytes_; }
+
+    // 本次接收的第 i 个有效数据报及其来源地址（下一次 receive 之前有效）
+    const iovec* payloads() const { return payloads_.data(); }
+    const sockaddr_in& address(size_t i) const { return addrs_[i]; }
+
+    // 本次 recvmmsg 返回的数据报总数（含被截断的），为 batch 时socket中可能还有数据
+    size_t received() const { return received_; }
+    size_t truncated() const { return truncated_; }
+
+private:
+    const size_t batch_;
+    const size_t slot_bytes_;
+    std::unique_ptr<uint8_t[]> storage_;
+    std::vector<mmsghdr> msgs_;
+    std::vector<iovec> iov_;
+    std::vector<sockaddr_in> addrs_;
+    std::vector<iovec> payloads_;   // 实际接收长度，交给通道的一批数据
+    size_t received_ = 0;
+    size_t truncated_ = 0;
+};
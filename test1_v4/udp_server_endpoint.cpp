@@ -7,6 +7,15 @@
 #include <cstring>
 #include <stdexcept>
 #include <algorithm>
+#include <chrono>
+
+// 过期检查间隔
+static constexpr int64_t kExpiryCheckIntervalNs = 1000000000LL;
+
+static int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 
 // 生成客户端唯一ID (IP:Port)
 std::string UdpServerEndpoint::getClientId(const sockaddr_in& addr) const {
@@ -15,7 +24,11 @@ std::string UdpServerEndpoint::getClientId(const sockaddr_in& addr) const {
     return std::string(ip) + ":" + std::to_string(ntohs(addr.sin_port));
 }
 
-UdpServerEndpoint::UdpServerEndpoint(uint16_t port) : _port(port) {}
+UdpServerEndpoint::UdpServerEndpoint(uint16_t port, size_t recvBatch, size_t recvSlotBytes,
+                                     uint32_t peerExpirySec)
+    : _port(port), _recvBatch(recvBatch, recvSlotBytes),
+      _peerExpiryNs(static_cast<int64_t>(peerExpirySec > 0 ? peerExpirySec : kDefaultPeerExpirySec) * 1000000000LL),
+      _snapshot(std::make_shared<ClientSnapshot>()) {}
 
 UdpServerEndpoint::~UdpServerEndpoint() {
     close();
@@ -30,6 +43,7 @@ bool UdpServerEndpoint::open() {
         logError("Socket creation failed: " + std::string(strerror(errno)));
         return false;
     }
+    tuneSocket(_socketFd);
 
     // 绑定端口
     sockaddr_in address{};
@@ -44,123 +58,215 @@ bool UdpServerEndpoint::open() {
         return false;
     }
 
-    // 创建epoll实例
-    _epollFd = epoll_create1(0);
-    if (_epollFd < 0) {
-        logError("Epoll creation failed: " + std::string(strerror(errno)));
-        ::close(_socketFd);
-        _socketFd = -1;
-        return false;
-    }
+    // 清空客户端列表
+    _peers.clear();
+    publishClients();
 
-    // 添加socket到epoll
-    epoll_event event{};
-    event.events = EPOLLIN;
-    event.data.fd = _socketFd;
-    if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, _socketFd, &event) < 0) {
+    // 绑定事件循环并注册socket（边缘触发，每次唤醒读空socket）
+    attachLoop();
+    if (!addFd(_socketFd, EPOLLIN | EPOLLET)) {
         logError("Epoll_ctl failed: " + std::string(strerror(errno)));
-        ::close(_epollFd);
+        detachLoop();
         ::close(_socketFd);
-        _epollFd = -1;
         _socketFd = -1;
         return false;
     }
 
-    // 清空客户端列表
-    {
-        std::lock_guard<std::mutex> lock(_clientsMutex);
-        _clients.clear();
-    }
-
     setState(State::CONNECTED);
-    startThread();
     logMessage("UDP server started on port " + std::to_string(_port));
     return true;
 }
 
 void UdpServerEndpoint::close() {
-    stopThread();
-    
-    if (_epollFd >= 0) {
-        ::close(_epollFd);
-        _epollFd = -1;
-    }
+    detachLoop();
     
     if (_socketFd >= 0) {
         ::close(_socketFd);
         _socketFd = -1;
     }
     
-    // 清空客户端列表
-    {
-        std::lock_guard<std::mutex> lock(_clientsMutex);
-        _clients.clear();
-    }
+    // 清空客户端列表（事件循环已解绑）
+    _peers.clear();
+    publishClients();
     
     setState(State::DISCONNECTED);
     logMessage("UDP server closed");
 }
 
+void UdpServerEndpoint::publishClients() {
+    auto snapshot = std::make_shared<ClientSnapshot>();
+    snapshot->version = ++_clientsVersion;
+    snapshot->addrs.reserve(_peers.size());
+    _peers.forEach([&](const sockaddr_in& addr) { snapshot->addrs.push_back(addr); });
+    std::atomic_store(&_snapshot, std::shared_ptr<const ClientSnapshot>(std::move(snapshot)));
+}
+
+// 移除空闲超时的客户端（事件循环线程），返回是否有客户端被移除，由调用方发布新快照
+bool UdpServerEndpoint::expirePeers(int64_t now) {
+    _nextExpiryNs.store(now + kExpiryCheckIntervalNs, std::memory_order_relaxed);
+    const size_t expired = _peers.expire(now - _peerExpiryNs);
+    if (expired > 0) {
+        logMessage("Expired " + std::to_string(expired) + " idle clients, " +
+                   std::to_string(_peers.size()) + " remaining");
+    }
+    return expired > 0;
+}
+
+// 没有客户端发送数据时接收路径不会运行，由发送路径驱动过期检查
+void UdpServerEndpoint::scheduleExpiry() {
+    const int64_t now = nowNs();
+    int64_t next = _nextExpiryNs.load(std::memory_order_relaxed);
+    if (now < next) return;
+    if (!_nextExpiryNs.compare_exchange_strong(next, now + kExpiryCheckIntervalNs,
+                                               std::memory_order_relaxed)) {
+        return; // 其他线程已投递
+    }
+    runInLoop([this] {
+        if (expirePeers(nowNs())) publishClients();
+    });
+}
+
+std::shared_ptr<const UdpServerEndpoint::ClientSnapshot> UdpServerEndpoint::loadClients() const {
+    return std::atomic_load(&_snapshot);
+}
+
+// 一次 sendmmsg 发往所有客户端：每个客户端一个 mmsghdr，共享同一组数据段
+void UdpServerEndpoint::fanout(const std::shared_ptr<const ClientSnapshot>& clients,
+                               const iovec* iov, int iovcnt) {
+    const size_t count = clients->addrs.size();
+    const bool rebuilt = !_fanoutClients || _fanoutClients->version != clients->version;
+    if (rebuilt) {
+        // 客户端集合变化：重建消息数组（地址指向快照内部，由 _fanoutClients 保持存活）
+        _fanoutClients = clients;
+        _fanoutMsgs.assign(count, mmsghdr{});
+        for (size_t i = 0; i < count; ++i) {
+            msghdr& hdr = _fanoutMsgs[i].msg_hdr;
+            hdr.msg_name = const_cast<sockaddr_in*>(&_fanoutClients->addrs[i]);
+            hdr.msg_namelen = sizeof(sockaddr_in);
+        }
+    }
+
+    // 所有消息共享同一份数据段：数据段数组地址或段数变化时才需要更新各消息
+    iovec* const oldIov = _fanoutIov.data();
+    const size_t oldCount = _fanoutIov.size();
+    _fanoutIov.assign(iov, iov + iovcnt);
+    if (rebuilt || _fanoutIov.data() != oldIov || _fanoutIov.size() != oldCount) {
+        for (auto& msg : _fanoutMsgs) {
+            msg.msg_hdr.msg_iov = _fanoutIov.data();
+            msg.msg_hdr.msg_iovlen = _fanoutIov.size();
+        }
+    }
+
+    size_t sent = 0;
+    while (sent < count) {
+        int n = sendmmsg(_socketFd, _fanoutMsgs.data() + sent, count - sent, 0);
+        if (n < 0) {
+            logWriteError("Sendmmsg failed to " + getClientId(_fanoutClients->addrs[sent]) + ": " +
+                          std::string(strerror(errno)));
+            ++sent; // 跳过出错的客户端
+            continue;
+        }
+        sent += n;
+    }
+}
+
 // 广播到所有客户端
 void UdpServerEndpoint::write(const uint8_t* data, size_t len) {
-    // if (!isConnected()) return;
-    
-    std::lock_guard<std::mutex> lock(_clientsMutex);
-    if (_clients.empty()) {
+    iovec iov{const_cast<uint8_t*>(data), len};
+    writev(&iov, 1);
+}
+
+// 聚集写：每个客户端一个数据报
+size_t UdpServerEndpoint::writev(const iovec* iov, int iovcnt) {
+    const size_t total = totalLength(iov, iovcnt);
+    scheduleExpiry();
+    auto clients = loadClients();
+    if (clients->addrs.empty()) {
         logError("No clients connected, skip sending");
-        return;
-    }
-    
-    for (const auto& client : _clients) {
-        if (sendto(_socketFd, data, len, 0, 
-                  (sockaddr*)&client.second, sizeof(client.second)) < 0) {
-            logError("Sendto failed to " + client.first + ": " + 
-                     std::string(strerror(errno)));
-        }
+        return total;
     }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    fanout(clients, iov, iovcnt);
+    return total;
 }
 
+// 批量写：每个客户端通过 sendmmsg 接收全部数据报
+size_t UdpServerEndpoint::writeDatagrams(mmsghdr* msgs, size_t count) {
+    scheduleExpiry();
+    auto clients = loadClients();
+    if (clients->addrs.empty()) {
+        logError("No clients connected, skip sending");
+        return count;
+    }
 
-void UdpServerEndpoint::run() {
-    constexpr int MAX_EVENTS = 10;
-    epoll_event events[MAX_EVENTS];
-    
-    while (isRunning()) {
-        int numEvents = epoll_wait(_epollFd, events, MAX_EVENTS, 100);
-        if (numEvents < 0) {
-            if (errno != EINTR) {
-                logError("Epoll_wait error: " + std::string(strerror(errno)));
-            }
-            continue;
+    if (clients->addrs.size() > count) {
+        // 客户端多于数据报：逐个数据报一次扇出到全部客户端
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (size_t i = 0; i < count; ++i) {
+            fanout(clients, msgs[i].msg_hdr.msg_iov, static_cast<int>(msgs[i].msg_hdr.msg_iovlen));
+        }
+        return count;
+    }
+
+    // 数据报多于客户端：逐个客户端一次发送全部数据报
+    for (const auto& addr : clients->addrs) {
+        for (size_t i = 0; i < count; ++i) {
+            msgs[i].msg_hdr.msg_name = const_cast<sockaddr_in*>(&addr);
+            msgs[i].msg_hdr.msg_namelen = sizeof(addr);
         }
 
-        for (int i = 0; i < numEvents; ++i) {
-            if (events[i].data.fd == _socketFd) {
-                handleData();
+        size_t sent = 0;
+        while (sent < count) {
+            int n = sendmmsg(_socketFd, msgs + sent, count - sent, 0);
+            if (n < 0) {
+                logWriteError("Sendmmsg failed to " + getClientId(addr) + ": " +
+                              std::string(strerror(errno)));
+                break;
             }
+            sent += n;
         }
     }
+    return count;
+}
+
+void UdpServerEndpoint::handleEvent(int fd, uint32_t events) {
+    if (fd == _socketFd && (events & EPOLLIN)) {
+        handleData();
+    }
 }
 
 void UdpServerEndpoint::handleData() {
-    uint8_t buffer[4096];
-    sockaddr_in clientAddr;
-    socklen_t addrLen = sizeof(clientAddr);
-    
-    ssize_t bytesRead = recvfrom(_socketFd, buffer, sizeof(buffer), 0,
-                                (sockaddr*)&clientAddr, &addrLen);
-    
-    if (bytesRead > 0) {
-        // 注册/更新客户端
-        std::string clientId = getClientId(clientAddr);
-        {
-            std::lock_guard<std::mutex> lock(_clientsMutex);
-            _clients[clientId] = clientAddr;
+    int errors = 0;
+    // 边缘触发：批量读取直到socket为空；通道要求暂停读取时停止，恢复时会重新触发
+    while (!_readPaused) {
+        int n = _recvBatch.receive(_socketFd);
+        if (n < 0) {
+            logError("Recvmmsg error: " + std::string(strerror(errno)));
+            if (++errors > 1) return;
+            continue;
+        }
+        if (_recvBatch.truncated() > 0) {
+            logReceiveDrop("Dropped " + std::to_string(_recvBatch.truncated()) + " datagrams larger than " +
+                               std::to_string(_recvBatch.slotBytes()) + " bytes",
+                           _recvBatch.truncated());
+        }
+
+        if (n > 0) {
+            // 注册/刷新客户端（整批只读一次时钟，出现新客户端或有客户端过期时发布新快照）
+            const int64_t now = nowNs();
+            bool changed = false;
+            for (int i = 0; i < n; ++i) {
+                changed |= _peers.touch(_recvBatch.address(i), now);
+            }
+            if (now >= _nextExpiryNs.load(std::memory_order_relaxed)) {
+                changed |= expirePeers(now);
+            }
+            if (changed) publishClients();
+            processBatch(_recvBatch.payloads(), n);
         }
-        
-        // logMessage("Received data from " + clientId);
-        processData(buffer, bytesRead);
-    } else if (bytesRead < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
-        logError("Recvfrom error: " + std::string(strerror(errno)));
+
+        // 未读满一批说明socket已读空
+        if (_recvBatch.received() < _recvBatch.batch()) return;
     }
-}
\ No newline at end of file
+}
@@ -1,31 +1,63 @@
 // udp_server_endpoint.h
 #pragma once
 #include "endpoint.h"
+#include "udp_recv_batch.h"
+#include "udp_peer_table.h"
 #include <sys/epoll.h>
 #include <netinet/in.h>
-#include <map>
 #include <mutex>
+#include <atomic>
 #include <string>
+#include <vector>
+#include <memory>
 
 class UdpServerEndpoint : public Endpoint {
 public:
-    explicit UdpServerEndpoint(uint16_t port);
+    static constexpr uint32_t kDefaultPeerExpirySec = 300;
+
+    // recvBatch / recvSlotBytes：每次 recvmmsg 的数据报数与单个数据报的最大长度（0 表示默认值）
+    // peerExpirySec：客户端超过该时间未发送数据即移出广播列表（0 表示默认值）
+    explicit UdpServerEndpoint(uint16_t port, size_t recvBatch = 0, size_t recvSlotBytes = 0,
+                               uint32_t peerExpirySec = 0);
     ~UdpServerEndpoint() override;
     
     bool open() override;
     void close() override;
     void write(const uint8_t* data, size_t len) override;
+    size_t writev(const iovec* iov, int iovcnt) override;
+    bool isDatagram() const override { return true; }
+    size_t writeDatagrams(mmsghdr* msgs, size_t count) override;
 
 private:
-    void run() override;
+    // 客户端集合快照：成员变化时整体替换（写时复制），发送路径无需访问对端表
+    struct ClientSnapshot {
+        uint64_t version = 0;
+        std::vector<sockaddr_in> addrs;
+    };
+
+    void handleEvent(int fd, uint32_t events) override;
     void handleData();
-    std::string getClientId(const sockaddr_in& addr) const; // 生成客户端唯一ID
+    std::string getClientId(const sockaddr_in& addr) const; // 生成客户端唯一ID（用于日志）
+    void publishClients();   // 由对端表生成新快照
+    bool expirePeers(int64_t nowNs);
+    void scheduleExpiry();   // 发送路径：到期时投递到事件循环线程执行过期检查
+    std::shared_ptr<const ClientSnapshot> loadClients() const;
+    // 同一组数据发往快照中的全部客户端（需持有 _mutex）
+    void fanout(const std::shared_ptr<const ClientSnapshot>& clients, const iovec* iov, int iovcnt);
 
     const uint16_t _port;
     int _socketFd = -1;
-    int _epollFd = -1;
+    UdpRecvBatch _recvBatch;   // 仅在事件循环线程中使用
     
-    // 客户端地址管理
-    std::mutex _clientsMutex;
-    std::map<std::string, sockaddr_in> _clients; // 客户端ID->地址映射
+    // 客户端地址管理：仅在事件循环线程中访问（open/close 时事件循环尚未绑定或已解绑）
+    UdpPeerTable _peers;
+    const int64_t _peerExpiryNs;
+    std::atomic<int64_t> _nextExpiryNs{0};   // 下一次过期检查的时间，检查最多每秒一次
+    uint64_t _clientsVersion = 0;
+    std::shared_ptr<const ClientSnapshot> _snapshot;   // 通过 std::atomic_load/atomic_store 访问
+
+    // 广播用的 mmsghdr 数组：按快照版本缓存，成员变化时才重建（持有 _mutex 访问）
+    std::shared_ptr<const ClientSnapshot> _fanoutClients;
+    std::vector<mmsghdr> _fanoutMsgs;
+    std::vector<iovec> _fanoutIov;
 };
\ No newline at end of file
@@ -0,0 +1,44 @@
+#include "unix_client_endpoint.h"
+#include "unix_socket.h"
+#include <cstring>
+
+UnixClientEndpoint::UnixClientEndpoint(const std::string& path, int socketType,
+                                       uint32_t reconnectMinMs, uint32_t reconnectMaxMs)
+    : TcpClientEndpoint(path, 0, reconnectMinMs, reconnectMaxMs),
+      _path(path), _seqpacket(socketType == SOCK_SEQPACKET) {
+    if (_seqpacket) _recvBuffer.resize(kUnixMaxMessage);
+}
+
+socklen_t UnixClientEndpoint::serverAddress(sockaddr_storage& addr) const {
+    return makeUnixAddress(_path, reinterpret_cast<sockaddr_un&>(addr));
+}
+
+void UnixClientEndpoint::handleSocketData() {
+    if (!_seqpacket) {
+        TcpClientEndpoint::handleSocketData();
+        return;
+    }
+
+    // 每次 recv 读取一条完整消息；通道要求暂停读取时停止，恢复时会重新触发
+    for (int i = 0; i < kUnixMaxMessagesPerEvent && !_readPaused; ++i) {
+        ssize_t n = recv(_socketFd, _recvBuffer.data(), _recvBuffer.size(), MSG_DONTWAIT | MSG_TRUNC);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+            logError("Receive error: " + std::string(strerror(errno)));
+            handleDisconnectEvent();
+            return;
+        }
+        if (n == 0) {
+            // 对端关闭连接
+            handleDisconnectEvent();
+            return;
+        }
+        if (static_cast<size_t>(n) > _recvBuffer.size()) {
+            logReceiveDrop("Dropped " + std::to_string(n) + " byte message larger than " +
+                               std::to_string(_recvBuffer.size()) + " bytes",
+                           1);
+            continue;
+        }
+        processData(_recvBuffer.data(), static_cast<size_t>(n));
+    }
+}
@@ -0,0 +1,30 @@
+// unix_client_endpoint.h
+#pragma once
+#include "tcp_client_endpoint.h"
+#include <vector>
+
+// Unix域socket客户端：复用TCP客户端的非阻塞连接与退避重连；
+// SEQPACKET 模式下每次写入为一条消息，收到的消息按条交给通道
+class UnixClientEndpoint : public TcpClientEndpoint {
+public:
+    // path：服务端socket路径（'@' 开头为抽象命名空间）；socketType：SOCK_STREAM 或 SOCK_SEQPACKET
+    UnixClientEndpoint(const std::string& path, int socketType,
+                       uint32_t reconnectMinMs = 0, uint32_t reconnectMaxMs = 0);
+
+    bool isDatagram() const override { return _seqpacket; }
+    // 消息边界由socket保持，不能经管道 splice
+    bool supportsSplice() const override { return !_seqpacket; }
+    // Unix域socket写入后立即交给对端，没有报文段合并
+    void setCorked(bool corked) override { (void)corked; }
+
+protected:
+    socklen_t serverAddress(sockaddr_storage& addr) const override;
+    int socketType() const override { return _seqpacket ? SOCK_SEQPACKET : SOCK_STREAM; }
+    std::string serverName() const override { return _path; }
+    void handleSocketData() override;
+
+private:
+    const std::string _path;
+    const bool _seqpacket;
+    std::vector<uint8_t> _recvBuffer;    // SEQPACKET 接收缓冲区（仅在事件循环线程访问）
+};
@@ -0,0 +1,104 @@
+#include "unix_server_endpoint.h"
+#include "unix_socket.h"
+#include <unistd.h>
+#include <sys/stat.h>
+#include <cstring>
+
+UnixServerEndpoint::UnixServerEndpoint(const std::string& path, int socketType,
+                                       SlowClientPolicy policy, size_t maxQueueBytes, int listenBacklog)
+    : TcpServerEndpoint(0, policy, maxQueueBytes, 1, listenBacklog),
+      _path(path), _seqpacket(socketType == SOCK_SEQPACKET) {
+    if (_seqpacket) _recvBuffer.resize(kUnixMaxMessage);
+}
+
+UnixServerEndpoint::~UnixServerEndpoint() {
+    close();
+}
+
+void UnixServerEndpoint::close() {
+    TcpServerEndpoint::close();
+    if (_bound) {
+        ::unlink(_path.c_str());
+        _bound = false;
+    }
+}
+
+int UnixServerEndpoint::createListenSocket() {
+    sockaddr_un address{};
+    const socklen_t addrLen = makeUnixAddress(_path, address);
+    if (addrLen == 0) {
+        logError("Invalid unix socket path: " + _path);
+        return -1;
+    }
+
+    int fd = socket(AF_UNIX, (_seqpacket ? SOCK_SEQPACKET : SOCK_STREAM) | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        logError("Socket creation failed: " + std::string(strerror(errno)));
+        return -1;
+    }
+    tuneSocket(fd);
+
+    // 清理上次异常退出遗留的socket文件（只删除socket类型的文件）
+    const bool abstractName = _path[0] == '@';
+    struct stat st{};
+    if (!abstractName && lstat(_path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+        ::unlink(_path.c_str());
+    }
+
+    if (bind(fd, (sockaddr*)&address, addrLen) < 0) {
+        logError("Bind failed: " + std::string(strerror(errno)));
+        ::close(fd);
+        return -1;
+    }
+    _bound = !abstractName;
+
+    if (listen(fd, _listenBacklog) < 0) {
+        logError("Listen failed: " + std::string(strerror(errno)));
+        ::close(fd);
+        return -1;
+    }
+
+    logMessage("Unix server listening on " + _path + (_seqpacket ? " (seqpacket)" : " (stream)"));
+    return fd;
+}
+
+// 客户端socket通常未绑定地址，用对端进程号区分
+std::string UnixServerEndpoint::peerName(int clientFd, const sockaddr_storage& addr) const {
+    (void)addr;
+    ucred cred{};
+    socklen_t len = sizeof(cred);
+    if (getsockopt(clientFd, SOL_SOCKET, SO_PEERCRED, &cred, &len) == 0) {
+        return "pid " + std::to_string(cred.pid) + "@" + _path;
+    }
+    return _path;
+}
+
+void UnixServerEndpoint::handleClientData(int clientFd) {
+    if (!_seqpacket) {
+        TcpServerEndpoint::handleClientData(clientFd);
+        return;
+    }
+
+    // 每次 recv 读取一条完整消息；通道要求暂停读取时停止，恢复时会重新触发
+    for (int i = 0; i < kUnixMaxMessagesPerEvent && !_readPaused; ++i) {
+        ssize_t n = recv(clientFd, _recvBuffer.data(), _recvBuffer.size(), MSG_DONTWAIT | MSG_TRUNC);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+            logError("Receive error: " + std::string(strerror(errno)));
+            closeClient(clientFd);
+            return;
+        }
+        if (n == 0) {
+            // 对端关闭连接
+            closeClient(clientFd);
+            return;
+        }
+        if (static_cast<size_t>(n) > _recvBuffer.size()) {
+            logReceiveDrop("Dropped " + std::to_string(n) + " byte message larger than " +
+                               std::to_string(_recvBuffer.size()) + " bytes",
+                           1);
+            continue;
+        }
+        processData(_recvBuffer.data(), static_cast<size_t>(n));
+    }
+}
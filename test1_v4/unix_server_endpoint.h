@@ -0,0 +1,33 @@
+// unix_server_endpoint.h
+#pragma once
+#include "tcp_server_endpoint.h"
+#include <vector>
+
+// Unix域socket服务端：同机进程连接时不经过TCP/IP协议栈，复用TCP服务端的多客户端广播、
+// 发送队列与慢客户端策略；SEQPACKET 模式下每次写入为一条消息，客户端消息按条交给通道
+class UnixServerEndpoint : public TcpServerEndpoint {
+public:
+    // path：socket文件路径（'@' 开头为抽象命名空间）；socketType：SOCK_STREAM 或 SOCK_SEQPACKET
+    UnixServerEndpoint(const std::string& path, int socketType,
+                       SlowClientPolicy policy = SlowClientPolicy::Disconnect,
+                       size_t maxQueueBytes = kDefaultSendQueueBytes, int listenBacklog = 0);
+    ~UnixServerEndpoint() override;
+
+    void close() override;
+    bool isDatagram() const override { return _seqpacket; }
+    // 消息边界由socket保持，不能经管道 splice
+    bool supportsSplice() const override { return !_seqpacket; }
+    // Unix域socket写入后立即交给对端，没有报文段合并
+    void setCorked(bool corked) override { (void)corked; }
+
+protected:
+    int createListenSocket() override;
+    std::string peerName(int clientFd, const sockaddr_storage& addr) const override;
+    void handleClientData(int clientFd) override;
+
+private:
+    const std::string _path;
+    const bool _seqpacket;
+    bool _bound = false;                 // 已在文件系统中创建socket文件，关闭时删除
+    std::vector<uint8_t> _recvBuffer;    // SEQPACKET 接收缓冲区（仅在事件循环线程访问）
+};
@@ -0,0 +1,38 @@
+// unix_socket.h
+#pragma once
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// Unix域socket端点（unix_server / unix_client）的公共定义
+// stream：字节流，与TCP端点行为一致；seqpacket：每次写入为一条消息，通道按数据报转发
+
+// SEQPACKET 单条消息上限（与通道单次读取上限一致），超过的消息被丢弃
+constexpr size_t kUnixMaxMessage = 64 * 1024;
+// 每次socket可读时最多读取的 SEQPACKET 消息数，剩余的由下一次唤醒（水平触发）处理
+constexpr int kUnixMaxMessagesPerEvent = 64;
+
+// 解析配置中的模式名称（"stream" / "seqpacket"），返回 socket 类型，未知名称抛出异常
+inline int parseUnixSocketType(const std::string& mode) {
+    if (mode.empty() || mode == "stream") return SOCK_STREAM;
+    if (mode == "seqpacket") return SOCK_SEQPACKET;
+    throw std::runtime_error("Unknown unix socket mode: " + mode);
+}
+
+// 填写 socket 地址，返回地址长度，路径为空或过长时返回0
+// 以 '@' 开头的名称使用抽象命名空间（不在文件系统中创建文件）
+inline socklen_t makeUnixAddress(const std::string& path, sockaddr_un& addr) {
+    addr = sockaddr_un{};
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) return 0;
+
+    std::memcpy(addr.sun_path, path.data(), path.size());
+    if (path[0] == '@') {
+        addr.sun_path[0] = '\0';
+        return static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + path.size());
+    }
+    return static_cast<socklen_t>(sizeof(addr));
+}